@@ -0,0 +1,407 @@
+/**
+ * Copyright (c) 2021 Jason Kwok, Ben Ho, Ben Yip, Harry Lam, and Hins To.
+ *
+ * Licensed under the GNU Affero General Public License, Version 3.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of the License at
+ *
+ *     https://github.com/JasonHK-HKCC/SEHH2042-Group-Project/blob/master/LICENSE
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under the License
+ * is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ * or implied. See the License for the specific language governing permissions and limitations under
+ * the License.
+ **/
+
+#include "jetassign/core.hpp"
+#include "jetassign/input.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * The load generator, which drives the seating plans and the parsers with synthetic passengers.
+ **/
+namespace bench
+{
+    using std::optional;
+    using std::string;
+    using std::vector;
+
+    using jetassign::core::CabinLayout;
+    using jetassign::core::Flight;
+    using jetassign::core::FlightKey;
+    using jetassign::core::FlightRegistry;
+    using jetassign::core::Passenger;
+    using jetassign::core::SeatLocation;
+
+    /**
+     * The options of a benchmark run.
+     **/
+    struct Options
+    {
+        /**
+         * The number of threads that generate the load concurrently.
+         **/
+        size_t threads = 1;
+
+        /**
+         * The number of operations of each kind for each thread.
+         **/
+        size_t operations = 100000;
+
+        /**
+         * The format of the report, either "text", "json", or "csv".
+         **/
+        string format = "text";
+
+        /**
+         * The path of the cabin layout file, if any.
+         **/
+        optional<string> layout_path;
+
+        /**
+         * The seed of the synthetic passengers.
+         **/
+        std::uint32_t seed = 2042;
+    };
+
+    /**
+     * The measurements of an operation.
+     **/
+    struct Result
+    {
+        /**
+         * The name of the operation.
+         **/
+        string operation;
+
+        /**
+         * The wall-clock time of the whole run, in seconds.
+         **/
+        double seconds;
+
+        /**
+         * The latency of each operation in nanoseconds, sorted.
+         **/
+        vector<std::uint64_t> latencies;
+
+        /**
+         * Returns the number of operations per second of all the threads.
+         **/
+        double throughput() const { return (seconds > 0) ? (latencies.size() / seconds) : 0; }
+
+        /**
+         * Returns the latency at a percentile.
+         *
+         * @param percentile The percentile, between 0 and 1.
+         **/
+        std::uint64_t percentile(double percentile) const
+        {
+            if (latencies.empty()) { return 0; }
+
+            const auto index = static_cast<size_t>(percentile * (latencies.size() - 1) + 0.5);
+            return latencies[std::min(index, latencies.size() - 1)];
+        }
+    };
+
+    /**
+     * The synthetic load of a thread.
+     **/
+    struct Workload
+    {
+        /**
+         * The flights to assign the passengers to, each filled up before the next one.
+         **/
+        vector<std::shared_ptr<Flight>> flights;
+
+        /**
+         * The passengers, one for each operation.
+         **/
+        vector<Passenger> passengers;
+
+        /**
+         * The seat of each passenger on their flight.
+         **/
+        vector<SeatLocation> seats;
+
+        /**
+         * The compact assignment of each passenger.
+         **/
+        vector<string> lines;
+
+        /**
+         * The number of seats that could be assigned on each flight.
+         **/
+        size_t seats_per_flight;
+
+        /**
+         * Returns the flight of a passenger.
+         *
+         * @param i The index of the passenger.
+         **/
+        Flight& flight_of(size_t i) { return *flights[i / seats_per_flight]; }
+    };
+
+    /**
+     * Generates the synthetic passengers of a thread, and opens the flights for them.
+     *
+     * @param options  The options of the run.
+     * @param thread   The index of the thread.
+     * @param registry The flights registry.
+     **/
+    Workload generate_workload(const Options &options, size_t thread, FlightRegistry &registry)
+    {
+        static const char *kSurnames[] = { "Chan", "Lee", "Wong", "Cheung", "Lau", "Ho", "Ng", "Leung", "Yip", "Kwok" };
+        static const char *kGivenNames[] = { "Tai Man", "Siu Lung", "Ka Ming", "Wai Kit", "Mei Ling", "Hoi Yan", "Chi Keung", "Wing Sze" };
+
+        const auto &layout = *CabinLayout::active();
+
+        // The seats that could be assigned, in a random order.
+        vector<SeatLocation> vacant_seats;
+        for (size_t row = 0; row < layout.rows(); row++)
+        {
+            for (size_t column = 0; column < layout.columns(); column++)
+            {
+                if (!layout.is_blocked(row, column)) { vacant_seats.emplace_back(row, column); }
+            }
+        }
+
+        std::mt19937 random(options.seed + static_cast<std::uint32_t>(thread));
+        std::shuffle(vacant_seats.begin(), vacant_seats.end(), random);
+
+        Workload workload;
+        workload.seats_per_flight = vacant_seats.size();
+        workload.passengers.reserve(options.operations);
+        workload.seats.reserve(options.operations);
+        workload.lines.reserve(options.operations);
+
+        for (size_t i = 0; i < options.operations; i++)
+        {
+            if ((i % vacant_seats.size()) == 0)
+            {
+                const auto flight_number = "BM" + std::to_string((thread * 10000) + workload.flights.size());
+                workload.flights.push_back(registry.open(FlightKey { flight_number, "2021-04-01" }));
+            }
+
+            const auto name = string(kSurnames[random() % std::size(kSurnames)]) + ' ' + kGivenNames[random() % std::size(kGivenNames)];
+            const auto passport_id = "BM" + std::to_string(10000000 + (thread * options.operations) + i) + static_cast<char>('A' + (random() % 26));
+            const auto &seat = vacant_seats[i % vacant_seats.size()];
+
+            workload.passengers.emplace_back(name, passport_id);
+            workload.seats.push_back(seat);
+            workload.lines.push_back(name + '/' + passport_id + '/' + seat.to_string());
+        }
+
+        return workload;
+    }
+
+    /**
+     * Runs an operation on every thread concurrently, and measures the latency of each call.
+     *
+     * @param name      The name of the operation.
+     * @param workloads The workload of each thread.
+     * @param operation Runs the operation of a thread on a passenger, by index.
+     **/
+    template<typename TFunction>
+    Result measure(const string &name, vector<Workload> &workloads, TFunction &&operation)
+    {
+        namespace chrono = std::chrono;
+
+        vector<vector<std::uint64_t>> latencies(workloads.size());
+        vector<std::thread> threads;
+
+        const auto started_at = chrono::steady_clock::now();
+        for (size_t thread = 0; thread < workloads.size(); thread++)
+        {
+            threads.emplace_back([&, thread]()
+            {
+                auto &workload = workloads[thread];
+                auto &thread_latencies = latencies[thread];
+                thread_latencies.reserve(workload.passengers.size());
+
+                for (size_t i = 0; i < workload.passengers.size(); i++)
+                {
+                    const auto operation_started_at = chrono::steady_clock::now();
+                    operation(workload, i);
+                    const auto elapsed = chrono::steady_clock::now() - operation_started_at;
+
+                    thread_latencies.push_back(chrono::duration_cast<chrono::nanoseconds>(elapsed).count());
+                }
+            });
+        }
+        for (auto &thread : threads) { thread.join(); }
+
+        Result result { name, chrono::duration<double>(chrono::steady_clock::now() - started_at).count(), {} };
+        for (const auto &thread_latencies : latencies)
+        {
+            result.latencies.insert(result.latencies.end(), thread_latencies.begin(), thread_latencies.end());
+        }
+        std::sort(result.latencies.begin(), result.latencies.end());
+
+        return result;
+    }
+
+    /**
+     * Prints the results in the requested format.
+     *
+     * @param output  The output stream.
+     * @param options The options of the run.
+     * @param results The results of each operation.
+     **/
+    void print_results(std::ostream &output, const Options &options, const vector<Result> &results)
+    {
+        using std::setw;
+
+        if (options.format == "json")
+        {
+            output << "{\"version\":\"" << JETASSIGN_VERSION << "\",\"threads\":" << options.threads
+                   << ",\"operations\":" << options.operations << ",\"results\":[";
+
+            for (size_t i = 0; i < results.size(); i++)
+            {
+                const auto &result = results[i];
+                output << ((i > 0) ? "," : "")
+                       << "{\"operation\":\"" << result.operation << "\""
+                       << ",\"count\":" << result.latencies.size()
+                       << ",\"throughput\":" << static_cast<std::uint64_t>(result.throughput())
+                       << ",\"p50_ns\":" << result.percentile(0.5)
+                       << ",\"p99_ns\":" << result.percentile(0.99)
+                       << ",\"p999_ns\":" << result.percentile(0.999)
+                       << ",\"max_ns\":" << result.percentile(1) << '}';
+            }
+
+            output << "]}\n";
+        }
+        else if (options.format == "csv")
+        {
+            output << "operation,threads,count,throughput,p50_ns,p99_ns,p999_ns,max_ns\n";
+            for (const auto &result : results)
+            {
+                output << result.operation << ',' << options.threads << ',' << result.latencies.size() << ','
+                       << static_cast<std::uint64_t>(result.throughput()) << ','
+                       << result.percentile(0.5) << ',' << result.percentile(0.99) << ','
+                       << result.percentile(0.999) << ',' << result.percentile(1) << '\n';
+            }
+        }
+        else
+        {
+            output << std::left << setw(13) << "Operation" << std::right
+                   << setw(12) << "Count" << setw(14) << "Ops/s"
+                   << setw(11) << "p50 (ns)" << setw(11) << "p99 (ns)" << setw(12) << "p999 (ns)" << setw(12) << "Max (ns)" << '\n';
+
+            for (const auto &result : results)
+            {
+                output << std::left << setw(13) << result.operation << std::right
+                       << setw(12) << result.latencies.size()
+                       << setw(14) << static_cast<std::uint64_t>(result.throughput())
+                       << setw(11) << result.percentile(0.5) << setw(11) << result.percentile(0.99)
+                       << setw(12) << result.percentile(0.999) << setw(12) << result.percentile(1) << '\n';
+            }
+        }
+    }
+}
+
+int main(int argc, const char* argv[])
+{
+    using jetassign::core::FlightRegistry;
+    using jetassign::core::SeatingPlan;
+    using jetassign::input::parsers::parse_compact_assignment;
+
+    /** The options of the run. */
+    bench::Options options;
+
+    // Parses the command-line options.
+    for (auto i = 1; i < argc; i++)
+    {
+        const std::string option = argv[i];
+
+        if ((option == "--threads") && ((i + 1) < argc) && (std::atoi(argv[i + 1]) > 0))
+        {
+            options.threads = std::atoi(argv[++i]);
+        }
+        else if ((option == "--operations") && ((i + 1) < argc) && (std::atoi(argv[i + 1]) > 0))
+        {
+            options.operations = std::atoi(argv[++i]);
+        }
+        else if ((option == "--format") && ((i + 1) < argc))
+        {
+            options.format = argv[++i];
+        }
+        else if ((option == "--layout") && ((i + 1) < argc))
+        {
+            options.layout_path = argv[++i];
+        }
+        else if ((option == "--seed") && ((i + 1) < argc))
+        {
+            options.seed = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else
+        {
+            std::cerr << "Usage: " << argv[0] << " [--threads <count>] [--operations <count per thread>]"
+                      << " [--format text|json|csv] [--layout <cabin layout file>] [--seed <seed>]\n";
+            return 1;
+        }
+    }
+
+    if ((options.format != "text") && (options.format != "json") && (options.format != "csv"))
+    {
+        std::cerr << "Error: Unknown format \"" << options.format << "\".\n";
+        return 1;
+    }
+
+    try
+    {
+        if (options.layout_path)
+        {
+            jetassign::core::CabinLayout::activate(jetassign::core::CabinLayout::load(*options.layout_path));
+        }
+
+        // Each thread books its own flights of the registry.
+        FlightRegistry registry;
+        std::vector<bench::Workload> workloads;
+        for (size_t thread = 0; thread < options.threads; thread++)
+        {
+            workloads.push_back(bench::generate_workload(options, thread, registry));
+        }
+
+        std::vector<bench::Result> results;
+
+        results.push_back(bench::measure("parse", workloads, [](bench::Workload &workload, size_t i)
+        {
+            const auto request = parse_compact_assignment(workload.lines[i]);
+            static_cast<void>(request);
+        }));
+
+        results.push_back(bench::measure("assign", workloads, [](bench::Workload &workload, size_t i)
+        {
+            workload.flight_of(i).modify([&](SeatingPlan &plan) { plan.assign(workload.seats[i], workload.passengers[i]); });
+        }));
+
+        results.push_back(bench::measure("location_of", workloads, [](bench::Workload &workload, size_t i)
+        {
+            const auto location = workload.flight_of(i).read([&](const SeatingPlan &plan) { return plan.location_of(workload.passengers[i]); });
+            static_cast<void>(location);
+        }));
+
+        results.push_back(bench::measure("remove", workloads, [](bench::Workload &workload, size_t i)
+        {
+            workload.flight_of(i).modify([&](SeatingPlan &plan) { plan.remove(workload.seats[i]); });
+        }));
+
+        bench::print_results(std::cout, options, results);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << '\n';
+        return 1;
+    }
+
+    return 0;
+}
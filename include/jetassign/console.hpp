@@ -0,0 +1,118 @@
+/**
+ * Copyright (c) 2021 Jason Kwok, Ben Ho, Ben Yip, Harry Lam, and Hins To.
+ *
+ * Licensed under the GNU Affero General Public License, Version 3.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of the License at
+ *
+ *     https://github.com/JasonHK-HKCC/SEHH2042-Group-Project/blob/master/LICENSE
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under the License
+ * is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ * or implied. See the License for the specific language governing permissions and limitations under
+ * the License.
+ **/
+
+#ifndef JETASSIGN_CONSOLE_HPP
+#define JETASSIGN_CONSOLE_HPP
+
+#include <streambuf>
+#include <vector>
+
+#include "jetassign/core.hpp"
+
+namespace jetassign
+{
+    /**
+     * The console component, which lets the front-end build each screen in memory and write it
+     * to the terminal at once.
+     **/
+    namespace console
+    {
+        /**
+         * The amount of output written through a console buffer.
+         **/
+        struct ConsoleStatistics
+        {
+            /**
+             * The number of bytes written to the file.
+             **/
+            size_t bytes = 0;
+
+            /**
+             * The number of write system calls.
+             **/
+            size_t writes = 0;
+
+            /**
+             * The number of flushes that wrote anything, i.e. the number of screens.
+             **/
+            size_t screens = 0;
+        };
+
+        /**
+         * A stream buffer that collects the output in a preallocated buffer, and writes it to a file
+         * descriptor with a single system call when flushed, e.g. before reading the input. The
+         * output was only written earlier if a screen does not fit into the buffer.
+         **/
+        class ConsoleBuffer : public std::streambuf
+        {
+            public:
+                /**
+                 * The default capacity of the buffer, which fits the largest screens.
+                 **/
+                static constexpr size_t kDefaultCapacity = 64 * 1024;
+
+                /**
+                 * Initialize a buffer for a file descriptor.
+                 *
+                 * @param fd       The file descriptor to write to, which was not owned by the buffer.
+                 * @param capacity The capacity of the buffer.
+                 **/
+                explicit ConsoleBuffer(int fd, size_t capacity = kDefaultCapacity);
+
+                /**
+                 * Writes the remaining output.
+                 **/
+                ~ConsoleBuffer() override;
+
+                ConsoleBuffer(const ConsoleBuffer&) = delete;
+
+                ConsoleBuffer& operator =(const ConsoleBuffer&) = delete;
+
+                /**
+                 * Returns the amount of output written so far.
+                 **/
+                const ConsoleStatistics& statistics() const noexcept { return m_statistics; }
+
+            protected:
+                int_type overflow(int_type character) override;
+
+                std::streamsize xsputn(const char_type *data, std::streamsize size) override;
+
+                int sync() override;
+
+            private:
+                /**
+                 * The file descriptor to write to.
+                 **/
+                int m_fd;
+
+                /**
+                 * The buffer of the pending output.
+                 **/
+                std::vector<char> m_buffer;
+
+                /**
+                 * The amount of output written so far.
+                 **/
+                ConsoleStatistics m_statistics;
+
+                /**
+                 * Writes the pending output, returns false if it could not be written.
+                 **/
+                bool write_pending();
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,1689 @@
+/**
+ * Copyright (c) 2021 Jason Kwok, Ben Ho, Ben Yip, Harry Lam, and Hins To.
+ *
+ * Licensed under the GNU Affero General Public License, Version 3.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of the License at
+ *
+ *     https://github.com/JasonHK-HKCC/SEHH2042-Group-Project/blob/master/LICENSE
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under the License
+ * is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ * or implied. See the License for the specific language governing permissions and limitations under
+ * the License.
+ **/
+
+#ifndef JETASSIGN_CORE_HPP
+#define JETASSIGN_CORE_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * The internals of JetAssign
+ **/
+namespace jetassign
+{
+    using std::array;
+    using std::istream;
+    using std::optional;
+    using std::size_t;
+    using std::string;
+    using std::string_view;
+
+    /**
+     * The core component.
+     **/
+    namespace core
+    {
+        /**
+         * The class of a ticket.
+         **/
+        enum class TicketClass
+        {
+            /** First class. */
+            kFirst,
+            /** Business class. */
+            kBusiness,
+            /** Economy class. */
+            kEconomy,
+        };
+
+        /**
+         * Describes the geometry of the cabin, i.e. the rows, the columns, the ticket class of each
+         * row and the seats that could not be assigned.
+         **/
+        class CabinLayout
+        {
+            public:
+                /**
+                 * Returns the layout that was activated, the default layout will be used if no layouts
+                 * were activated. The seating plans share the ownership of their layouts with it.
+                 **/
+                static std::shared_ptr<const CabinLayout> active();
+
+                /**
+                 * Returns the layout that was activated, without sharing its ownership, thus the hot
+                 * paths never contend on its reference count. The reference stays valid until
+                 * another layout was activated.
+                 **/
+                static const CabinLayout& current() noexcept;
+
+                /**
+                 * Activates a layout. This must be done at startup, before any seating plans were
+                 * created and before the other threads were started, since the references returned
+                 * by current() were not kept alive.
+                 *
+                 * @param layout The layout to activate.
+                 **/
+                static void activate(const CabinLayout &layout);
+
+                /**
+                 * Loads a layout from a cabin layout descriptor.
+                 *
+                 * @param input The stream of the descriptor.
+                 **/
+                static CabinLayout load(std::istream &input);
+
+                /**
+                 * Loads a layout from a cabin layout descriptor file.
+                 *
+                 * @param path The path of the descriptor file.
+                 **/
+                static CabinLayout load(const string &path);
+
+                /**
+                 * Initialize the default layout, which has 13 rows of 6 seats without aisles.
+                 **/
+                CabinLayout();
+
+                /**
+                 * Initialize a layout with all rows in economy class.
+                 *
+                 * @param rows    The number of rows.
+                 * @param columns The letters of the columns, aisles are represented by spaces, e.g. "ABC DEF".
+                 **/
+                CabinLayout(size_t rows, const string &columns);
+
+                /**
+                 * Returns the number of rows.
+                 **/
+                size_t rows() const { return m_rows; }
+
+                /**
+                 * Returns the number of columns.
+                 **/
+                size_t columns() const { return m_column_letters.size(); }
+
+                /**
+                 * Returns the total number of seats, including the blocked seats.
+                 **/
+                size_t seats() const { return (m_rows * m_column_letters.size()); }
+
+                /**
+                 * Returns the letter of a column.
+                 *
+                 * @param column The column.
+                 **/
+                char column_letter(size_t column) const { return m_column_letters.at(column); }
+
+                /**
+                 * Returns the column of a letter.
+                 *
+                 * @param letter The uppercased letter of the column.
+                 **/
+                optional<size_t> column_of(char letter) const;
+
+                /**
+                 * Determine whether there is an aisle after the column.
+                 *
+                 * @param column The column.
+                 **/
+                bool has_aisle_after(size_t column) const { return m_aisles.at(column); }
+
+                /**
+                 * Returns the ticket class of a row.
+                 *
+                 * @param row The row.
+                 **/
+                TicketClass ticket_class(size_t row) const { return m_row_classes.at(row); }
+
+                /**
+                 * Changes the ticket class of a range of rows.
+                 *
+                 * @param first_row The first row of the range (inclusive).
+                 * @param last_row  The last row of the range (inclusive).
+                 * @param ticket_class The ticket class of the rows.
+                 **/
+                void set_ticket_class(size_t first_row, size_t last_row, TicketClass ticket_class);
+
+                /**
+                 * Determine whether the seat could not be assigned.
+                 *
+                 * @param row    The row of the seat.
+                 * @param column The column of the seat.
+                 **/
+                bool is_blocked(size_t row, size_t column) const;
+
+                /**
+                 * Returns the blocked seats of a row, where bit N represents the Nth column.
+                 *
+                 * @param row The row.
+                 **/
+                std::uint64_t blocked_bits(size_t row) const { return m_blocked.at(row); }
+
+                /**
+                 * Returns the bits of every column in a row.
+                 **/
+                std::uint64_t row_bits() const { return ((std::uint64_t(1) << m_column_letters.size()) - 1); }
+
+                /**
+                 * Returns the columns that were side by side with the next column, i.e. bit N was set
+                 * if column N and N+1 were not separated by an aisle.
+                 **/
+                std::uint64_t adjacent_bits() const { return m_adjacent; }
+
+                /**
+                 * Determine whether the layout contains any blocked seats.
+                 **/
+                bool has_blocked_seats() const;
+
+                /**
+                 * Blocks a seat so it could not be assigned.
+                 *
+                 * @param row    The row of the seat.
+                 * @param column The column of the seat.
+                 **/
+                void block(size_t row, size_t column);
+
+                /**
+                 * Returns the position of the seat in a row-major buffer.
+                 *
+                 * @param row    The row of the seat.
+                 * @param column The column of the seat.
+                 **/
+                size_t index_of(size_t row, size_t column) const;
+
+            private:
+                /**
+                 * The number of rows.
+                 **/
+                size_t m_rows;
+
+                /**
+                 * The letter of each column.
+                 **/
+                string m_column_letters;
+
+                /**
+                 * Whether there is an aisle after each column.
+                 **/
+                std::vector<bool> m_aisles;
+
+                /**
+                 * The ticket class of each row.
+                 **/
+                std::vector<TicketClass> m_row_classes;
+
+                /**
+                 * The columns that were side by side with the next column.
+                 **/
+                std::uint64_t m_adjacent;
+
+                /**
+                 * The blocked seats of each row, where bit N represents the Nth column.
+                 **/
+                std::vector<std::uint64_t> m_blocked;
+        };
+
+        /**
+         * The passport ID of a passenger, which was stored inline since it was alphanumeric and
+         * bounded.
+         **/
+        class PassportId
+        {
+            public:
+                /**
+                 * The maximum length of a passport ID.
+                 **/
+                static constexpr size_t kMaxLength = 15;
+
+                /**
+                 * Initialize a passport ID, which must not be longer than the maximum length.
+                 *
+                 * @param value The passport ID.
+                 **/
+                PassportId(string_view value);
+
+                /**
+                 * Returns the passport ID.
+                 **/
+                string_view view() const noexcept { return string_view(m_value.data(), m_length); }
+
+                operator string_view() const noexcept { return view(); }
+
+                /**
+                 * Determine whether two instances represent the same passport ID.
+                 *
+                 * @param other The other instance.
+                 **/
+                bool operator ==(const PassportId &other) const noexcept { return (view() == other.view()); }
+
+                /**
+                 * Determine whether two instances represent different passport IDs.
+                 *
+                 * @param other The other instance.
+                 **/
+                bool operator !=(const PassportId &other) const noexcept { return (view() != other.view()); }
+
+            private:
+                /**
+                 * The characters of the passport ID.
+                 **/
+                std::array<char, kMaxLength> m_value;
+
+                /**
+                 * The length of the passport ID.
+                 **/
+                std::uint8_t m_length;
+        };
+
+        /**
+         * Hashes the passport IDs for the unordered containers.
+         **/
+        struct PassportIdHash
+        {
+            size_t operator()(const PassportId &passport_id) const noexcept { return std::hash<string_view>()(passport_id.view()); }
+        };
+
+        /**
+         * An interned name, which was shared by the passengers with the same name and released
+         * after the last of them was destroyed.
+         **/
+        struct InternedName
+        {
+            /**
+             * The name, which was stored right after the entry.
+             **/
+            string_view value;
+
+            /**
+             * The number of passengers that refer to the name.
+             **/
+            std::atomic<size_t> references;
+        };
+
+        /**
+         * Represents a passenger. The passenger was a compact value, where the passport ID was
+         * stored inline and the name was interned, thus copies never allocate.
+         **/
+        class Passenger
+        {
+            public:
+                /**
+                 * Initialize a passenger with its information.
+                 *
+                 * @param name        The name of the passenger.
+                 * @param passport_id The passport ID of the passenger.
+                 **/
+                Passenger(string_view name, string_view passport_id);
+
+                Passenger(const Passenger &other) noexcept;
+
+                Passenger& operator =(const Passenger &other) noexcept;
+
+                /**
+                 * Releases the interned name if this was the last passenger with the name.
+                 **/
+                ~Passenger();
+
+                /**
+                 * Returns the name of the passenger, which was valid while the passenger or any
+                 * passenger with the same name was alive.
+                 **/
+                string_view name() const noexcept { return m_name->value; }
+
+                /**
+                 * Returns the passport ID of the passenger.
+                 **/
+                string_view passport_id() const noexcept { return m_passport_id.view(); }
+
+                /**
+                 * Returns the passport ID of the passenger, as the key of the passport indexes.
+                 **/
+                const PassportId& passport_key() const noexcept { return m_passport_id; }
+
+                /**
+                 * Determine whether two instances represent the same passenger.
+                 *
+                 * @param other The other instance.
+                 **/
+                bool equals(const Passenger &other) const;
+
+                /**
+                 * Determine whether two instances represent the same passenger.
+                 *
+                 * @param other The other instance.
+                 **/
+                bool operator ==(const Passenger &other) const { return equals(other); }
+
+                /**
+                 * Determine whether two instances represent different passengers.
+                 *
+                 * @param other The other instance.
+                 **/
+                bool operator !=(const Passenger &other) const { return !equals(other); }
+
+                /**
+                 * Returns the number of distinct names that were interned by the alive passengers.
+                 **/
+                static size_t interned_names();
+
+            private:
+                /**
+                 * The interned name of the passenger.
+                 **/
+                InternedName *m_name;
+
+                /**
+                 * The passport ID of the passenger.
+                 **/
+                PassportId m_passport_id;
+        };
+
+        /**
+         * Represents the location of a seat.
+         **/
+        class SeatLocation
+        {
+            public:
+                static string row_to_string(size_t row);
+
+                static string column_to_string(size_t column);
+
+                /**
+                 * Initialize a seat location with its position.
+                 *
+                 * @param row    The row location of the seat.
+                 * @param column The column location of the seat.
+                 **/
+                SeatLocation(size_t row, size_t column);
+
+                /**
+                 * Returns the row location of the seat.
+                 **/
+                size_t row() const { return m_row; }
+
+                /**
+                 * Returns the column location of the seat.
+                 **/
+                size_t column() const { return m_column; }
+
+                TicketClass ticket_class() const;
+
+                /**
+                 * Determine whether two instances represent the same seat location.
+                 *
+                 * @param other The other instance.
+                 **/
+                bool equals(const SeatLocation& other) const;
+
+                /**
+                 * Determine whether this instance less than the other.
+                 *
+                 * @param other The other instance.
+                 **/
+                bool less_than(const SeatLocation &other) const;
+
+                /**
+                 * Determine whether two instances represent the same seat location.
+                 *
+                 * @param other The other instance.
+                 **/
+                bool operator ==(const SeatLocation &other) const { return equals(other); }
+
+                /**
+                 * Determine whether two instances represent different seat location.
+                 *
+                 * @param other The other instance.
+                 **/
+                bool operator !=(const SeatLocation &other) const { return !equals(other); }
+
+                /**
+                 * Determine whether this instance less than the other.
+                 *
+                 * @param other The other instance.
+                 **/
+                bool operator <(const SeatLocation &other) const { return less_than(other); }
+
+                string to_string() const;
+
+                operator string() const { return to_string(); }
+
+                friend std::ostream& operator<<(std::ostream& os, const SeatLocation& location);
+
+            private:
+                /**
+                 * The row location of the seat.
+                 **/
+                size_t m_row;
+
+                /**
+                 * The column location of the seat.
+                 **/
+                size_t m_column;
+        };
+
+        class SeatingPlan;
+
+        /**
+         * The number of occupied and vacant seats of a part of the cabin, excluding the blocked
+         * seats.
+         **/
+        struct Occupancy
+        {
+            /**
+             * The number of occupied seats.
+             **/
+            size_t occupied = 0;
+
+            /**
+             * The number of vacant seats.
+             **/
+            size_t vacant = 0;
+
+            /**
+             * Returns the number of seats that could be assigned.
+             **/
+            size_t seats() const noexcept { return (occupied + vacant); }
+
+            /**
+             * Returns the ratio of the occupied seats, or 0 if there were no seats.
+             **/
+            double load_factor() const noexcept { return ((seats() == 0) ? 0.0 : (double(occupied) / seats())); }
+        };
+
+        /**
+         * Receives the changes of the seating plans that it subscribed to.
+         **/
+        class SeatingPlanObserver
+        {
+            public:
+                virtual ~SeatingPlanObserver() = default;
+
+                /**
+                 * Called after a passenger was assigned to a seat.
+                 *
+                 * @param plan      The seating plan.
+                 * @param location  The location of the seat.
+                 * @param passenger The assigned passenger.
+                 **/
+                virtual void on_assigned(const SeatingPlan &plan, const SeatLocation &location, const Passenger &passenger) = 0;
+
+                /**
+                 * Called after a passenger was removed from a seat.
+                 *
+                 * @param plan      The seating plan.
+                 * @param location  The location of the seat.
+                 * @param passenger The removed passenger.
+                 **/
+                virtual void on_removed(const SeatingPlan &plan, const SeatLocation &location, const Passenger &passenger) = 0;
+
+                /**
+                 * Called before the changes of a transaction were applied.
+                 *
+                 * @param plan The seating plan.
+                 **/
+                virtual void on_transaction_begun(const SeatingPlan &/* plan */) {}
+
+                /**
+                 * Called after the changes of a transaction were applied, or reverted if an error
+                 * occurred while applying them.
+                 *
+                 * @param plan      The seating plan.
+                 * @param committed Whether the changes were applied.
+                 **/
+                virtual void on_transaction_ended(const SeatingPlan &/* plan */, bool /* committed */) {}
+        };
+
+        class SeatingPlan
+        {
+            public:
+                class Transaction;
+
+                class Snapshot;
+
+                class Reader;
+
+                class DeferredPublication;
+
+                typedef optional<Passenger> value_type;
+
+                typedef value_type& reference;
+
+                typedef const value_type& const_reference;
+
+                /**
+                 * Initialize an empty seating plan with the active cabin layout.
+                 *
+                 * @param resource          The memory resource to allocate the seating plan from.
+                 * @param snapshot_resource The memory resource to allocate the snapshots from, or the
+                 *                          default resource if null. The snapshots keep it alive and
+                 *                          might be released on any thread, thus it must be
+                 *                          synchronized.
+                 **/
+                SeatingPlan(std::pmr::memory_resource *resource = std::pmr::get_default_resource(), std::shared_ptr<std::pmr::memory_resource> snapshot_resource = nullptr);
+
+                SeatingPlan(const SeatingPlan&) = delete;
+
+                SeatingPlan(SeatingPlan&&) = default;
+
+                SeatingPlan& operator =(const SeatingPlan&) = delete;
+
+                SeatingPlan& operator =(SeatingPlan&&) = default;
+
+                /**
+                 * Returns the cabin layout of the seating plan.
+                 **/
+                const CabinLayout& layout() const { return *m_layout; }
+
+                /**
+                 * Determine whether the seat was already occupied by a passenger.
+                 *
+                 * @param location The location of the seat.
+                 **/
+                bool is_occupied(const SeatLocation &location) const noexcept;
+
+                /**
+                 * Determine whether the seat was already occupied by a passenger.
+                 *
+                 * @param row    The row of the seat.
+                 * @param column The column of the seat.
+                 **/
+                bool is_occupied(size_t row, size_t column) const noexcept;
+
+                /**
+                 * Determine whether the seat was blocked by the cabin layout.
+                 *
+                 * @param location The location of the seat.
+                 **/
+                bool is_blocked(const SeatLocation &location) const;
+
+                /**
+                 * Returns the occupied seats of a row, where bit N represents the Nth column.
+                 *
+                 * @param row The row.
+                 **/
+                std::uint64_t occupied_bits(size_t row) const { return m_occupancy.at(row); }
+
+                /**
+                 * Returns the vacant seats of a row, excluding the blocked seats, where bit N
+                 * represents the Nth column.
+                 *
+                 * @param row The row.
+                 **/
+                std::uint64_t vacant_bits(size_t row) const;
+
+                /**
+                 * Returns the number of vacant seats of a ticket class, excluding the blocked seats.
+                 *
+                 * @param ticket_class The ticket class.
+                 **/
+                size_t vacant_seats(TicketClass ticket_class) const noexcept { return this->occupancy(ticket_class).vacant; }
+
+                /**
+                 * Returns the occupancy of the whole cabin.
+                 **/
+                Occupancy occupancy() const noexcept { return m_total_occupancy; }
+
+                /**
+                 * Returns the occupancy of a ticket class.
+                 *
+                 * @param ticket_class The ticket class.
+                 **/
+                Occupancy occupancy(TicketClass ticket_class) const noexcept { return m_class_occupancy[static_cast<size_t>(ticket_class)]; }
+
+                /**
+                 * Returns the occupancy of a row.
+                 *
+                 * @param row The row.
+                 **/
+                Occupancy row_occupancy(size_t row) const;
+
+                /**
+                 * Returns the occupancy of a column.
+                 *
+                 * @param column The column.
+                 **/
+                Occupancy column_occupancy(size_t column) const { return m_column_occupancy.at(column); }
+
+                /**
+                 * Returns the first vacant column of a row, or nothing if the row was full.
+                 *
+                 * @param row The row.
+                 **/
+                optional<size_t> first_vacant_column(size_t row) const;
+
+                /**
+                 * Finds the first group of vacant seats that were side by side in a row, i.e. not
+                 * separated by an aisle. Returns the leftmost seat of the group.
+                 *
+                 * @param count        The number of seats.
+                 * @param ticket_class The ticket class of the seats, or any ticket classes.
+                 **/
+                optional<SeatLocation> find_adjacent_vacant_seats(size_t count, optional<TicketClass> ticket_class = std::nullopt) const;
+
+                /**
+                 * Determine whether the passenger was already assigned a seat.
+                 *
+                 * @param passport_id The passport ID of a passenger to check.
+                 **/
+                bool is_assigned(string_view passport_id) const noexcept;
+
+                /**
+                 * Determine whether the passenger was already assigned a seat.
+                 *
+                 * @param passenger The passenger to check.
+                 **/
+                bool is_assigned(const Passenger &passenger) const noexcept;
+
+                /**
+                 * Returns the passenger who was assigned to the given seat.
+                 *
+                 * @param location The location of the seat.
+                 **/
+                const const_reference at(const SeatLocation &location) const;
+
+                /**
+                 * Returns the passenger who was assigned to the given seat.
+                 *
+                 * @param row    The row of the seat.
+                 * @param column The column of the seat.
+                 **/
+                const const_reference at(size_t row, size_t column) const;
+
+                /**
+                 * Returns the seat location of a passenger.
+                 *
+                 * @param passport_id The passport ID of a passenger to check.
+                 **/
+                optional<SeatLocation> location_of(string_view passport_id) const;
+
+                /**
+                 * Returns the seat location of a passenger.
+                 *
+                 * @param passenger The passenger to check.
+                 **/
+                optional<SeatLocation> location_of(const Passenger &passenger) const;
+
+                /**
+                 * Assign a passenger to a specific seat.
+                 *
+                 * @param location  The location of the seat.
+                 * @param passenger The passenger to be assigned.
+                 **/
+                void assign(const SeatLocation &location, const_reference passenger);
+
+                /**
+                 * Remove a passenger at the specific seat from the seating plan.
+                 *
+                 * @param location The location of the seat.
+                 **/
+                void remove(const SeatLocation &location);
+
+                /**
+                 * Remove a specific passenger from the seating plan.
+                 *
+                 * @param passenger The passenger to remove.
+                 **/
+                void remove(const Passenger &passenger);
+
+                /**
+                 * Begins a transaction, which applies a group of changes all at once.
+                 **/
+                Transaction begin();
+
+                /**
+                 * Returns the latest published snapshot of the seating plan, which never changes. A
+                 * snapshot was published after each change, or once after each transaction.
+                 **/
+                std::shared_ptr<const Snapshot> snapshot() const;
+
+                /**
+                 * Notifies the observer of the changes of the seating plan.
+                 *
+                 * @param observer The observer, which must outlive the subscription.
+                 **/
+                void subscribe(SeatingPlanObserver *observer);
+
+                /**
+                 * Stops notifying the observer of the changes of the seating plan.
+                 *
+                 * @param observer The observer.
+                 **/
+                void unsubscribe(SeatingPlanObserver *observer);
+
+            private:
+                /**
+                 * The observers of the seating plan.
+                 **/
+                std::vector<SeatingPlanObserver*> m_observers;
+
+                /**
+                 * The cabin layout of the seating plan.
+                 **/
+                std::shared_ptr<const CabinLayout> m_layout;
+
+                /**
+                 * The internal seating plan, stored in row-major order.
+                 **/
+                std::pmr::vector<optional<Passenger>> seating_plan;
+
+                /**
+                 * The occupied seats of each row, where bit N represents the Nth column.
+                 **/
+                std::pmr::vector<std::uint64_t> m_occupancy;
+
+                /**
+                 * The occupancy of the whole cabin, updated on each change.
+                 **/
+                Occupancy m_total_occupancy;
+
+                /**
+                 * The occupancy of each ticket class, updated on each change.
+                 **/
+                std::array<Occupancy, 3> m_class_occupancy;
+
+                /**
+                 * The occupancy of each column, updated on each change. The occupancy of each row was
+                 * counted from its occupied bits instead.
+                 **/
+                std::pmr::vector<Occupancy> m_column_occupancy;
+
+                /**
+                 * The seat location of each assigned passenger, indexed by the passport ID.
+                 **/
+                std::pmr::unordered_map<PassportId, SeatLocation, PassportIdHash> passenger_index;
+
+                struct Publication;
+
+                /**
+                 * The latest published snapshot, shared with the readers.
+                 **/
+                std::shared_ptr<Publication> m_publication;
+
+                /**
+                 * The memory resource that the snapshots were allocated from.
+                 **/
+                std::shared_ptr<std::pmr::memory_resource> m_snapshot_resource;
+
+                /**
+                 * The rows that were changed since the latest snapshot was published.
+                 **/
+                std::vector<size_t> m_dirty_rows;
+
+                /**
+                 * The passport IDs that were changed since the latest snapshot was published.
+                 **/
+                std::vector<PassportId> m_dirty_passports;
+
+                /**
+                 * Whether a transaction or a deferred publication was being applied, which publishes
+                 * a snapshot at the end.
+                 **/
+                bool m_is_applying;
+
+                /**
+                 * Publishes a snapshot with the changes since the latest one.
+                 **/
+                void publish();
+
+                /**
+                 * Updates the occupancy counters after a seat was assigned or removed.
+                 *
+                 * @param location The location of the seat.
+                 * @param occupied Whether the seat became occupied.
+                 **/
+                void count_seat(const SeatLocation &location, bool occupied) noexcept;
+        };
+
+        /**
+         * An immutable snapshot of a seating plan. The snapshots share the rows and the passport
+         * index shards that were not changed between them, i.e. copy-on-write.
+         **/
+        class SeatingPlan::Snapshot
+        {
+            public:
+                /**
+                 * Initialize an empty snapshot.
+                 *
+                 * @param resource The memory resource to allocate the chunks of the rows from.
+                 **/
+                explicit Snapshot(std::pmr::memory_resource *resource) : m_rows(resource) {}
+
+                /**
+                 * Returns the cabin layout of the seating plan.
+                 **/
+                const CabinLayout& layout() const { return *m_layout; }
+
+                /**
+                 * Returns the version of the snapshot, which increases on each publication.
+                 **/
+                std::uint64_t version() const { return m_version; }
+
+                /**
+                 * Determine whether the seat was occupied by a passenger.
+                 *
+                 * @param row    The row of the seat.
+                 * @param column The column of the seat.
+                 **/
+                bool is_occupied(size_t row, size_t column) const;
+
+                /**
+                 * Returns the occupied seats of a row, where bit N represents the Nth column.
+                 *
+                 * @param row The row.
+                 **/
+                std::uint64_t occupied_bits(size_t row) const { return this->row(row).occupied; }
+
+                /**
+                 * Returns the passenger who was assigned to the given seat.
+                 *
+                 * @param location The location of the seat.
+                 **/
+                const_reference at(const SeatLocation &location) const;
+
+                /**
+                 * Returns the seat location of a passenger.
+                 *
+                 * @param passport_id The passport ID of a passenger to check.
+                 **/
+                optional<SeatLocation> location_of(string_view passport_id) const;
+
+            private:
+                friend class SeatingPlan;
+
+                /**
+                 * The number of shards of the passport index.
+                 **/
+                static constexpr size_t kIndexShards = 16;
+
+                /**
+                 * The number of chunks of each shard of the passport index.
+                 **/
+                static constexpr size_t kIndexChunks = 64;
+
+                /**
+                 * The number of rows of each chunk of rows.
+                 **/
+                static constexpr size_t kRowsPerChunk = 32;
+
+                /**
+                 * The seats of a row.
+                 **/
+                struct Row
+                {
+                    explicit Row(std::pmr::memory_resource *resource) : seats(resource) {}
+
+                    /** The occupied seats, where bit N represents the Nth column. */
+                    std::uint64_t occupied = 0;
+
+                    /** The passenger of each seat. */
+                    std::pmr::vector<optional<Passenger>> seats;
+                };
+
+                /**
+                 * A chunk of rows, thus a change only copies the chunk instead of all the rows.
+                 **/
+                typedef std::array<std::shared_ptr<const Row>, kRowsPerChunk> RowChunk;
+
+                /**
+                 * A chunk of a shard of the passport index.
+                 **/
+                typedef std::pmr::unordered_map<PassportId, SeatLocation, PassportIdHash> IndexChunk;
+
+                /**
+                 * A shard of the passport index, thus a change only copies one of its chunks and
+                 * the pointers to them instead of the whole shard.
+                 **/
+                typedef std::array<std::shared_ptr<const IndexChunk>, kIndexChunks> IndexShard;
+
+                /**
+                 * Returns the shard of a passport ID.
+                 *
+                 * @param passport_id The passport ID.
+                 **/
+                static size_t shard_of(const PassportId &passport_id) { return (PassportIdHash()(passport_id) % kIndexShards); }
+
+                /**
+                 * Returns the chunk of a passport ID within its shard.
+                 *
+                 * @param passport_id The passport ID.
+                 **/
+                static size_t chunk_of(const PassportId &passport_id) { return ((PassportIdHash()(passport_id) / kIndexShards) % kIndexChunks); }
+
+                /**
+                 * Returns a row of the snapshot.
+                 *
+                 * @param row The row.
+                 **/
+                const Row& row(size_t row) const;
+
+                /**
+                 * The cabin layout of the seating plan.
+                 **/
+                std::shared_ptr<const CabinLayout> m_layout;
+
+                /**
+                 * The version of the snapshot.
+                 **/
+                std::uint64_t m_version = 0;
+
+                /**
+                 * The chunks of the rows of the seating plan.
+                 **/
+                std::pmr::vector<std::shared_ptr<const RowChunk>> m_rows;
+
+                /**
+                 * The shards of the seat location of each passenger, indexed by the passport ID.
+                 **/
+                std::array<std::shared_ptr<const IndexShard>, kIndexShards> m_index;
+        };
+
+        struct SeatingPlan::Publication
+        {
+            /**
+             * The version of the latest snapshot, which was updated after the snapshot.
+             **/
+            std::atomic<std::uint64_t> version { 0 };
+
+            /**
+             * The latest snapshot, which must be accessed atomically.
+             **/
+            std::shared_ptr<const Snapshot> snapshot;
+        };
+
+        /**
+         * Reads the latest snapshot of a seating plan without locking. The reader caches the
+         * snapshot and only fetches a new one after a newer version was published, thus the readers
+         * on different threads never contend with each other. Each thread should own its reader.
+         **/
+        class SeatingPlan::Reader
+        {
+            public:
+                /**
+                 * Initialize a reader of a seating plan.
+                 *
+                 * @param plan The seating plan.
+                 **/
+                explicit Reader(const SeatingPlan &plan);
+
+                /**
+                 * Returns the latest snapshot, which stays valid until the next call.
+                 **/
+                const Snapshot& current();
+
+            private:
+                /**
+                 * The published snapshots of the seating plan.
+                 **/
+                std::shared_ptr<const Publication> m_publication;
+
+                /**
+                 * The cached snapshot.
+                 **/
+                std::shared_ptr<const Snapshot> m_snapshot;
+        };
+
+        /**
+         * Defers the publication of the snapshots of a seating plan until the guard was destroyed,
+         * which publishes all the changes at once. Unlike a transaction, each change was applied
+         * immediately, thus it suits restoring many seats into a seating plan.
+         **/
+        class SeatingPlan::DeferredPublication
+        {
+            public:
+                /**
+                 * Defers the publication of a seating plan.
+                 *
+                 * @param plan The seating plan, which must outlive the guard.
+                 **/
+                explicit DeferredPublication(SeatingPlan &plan);
+
+                DeferredPublication(const DeferredPublication&) = delete;
+
+                DeferredPublication& operator =(const DeferredPublication&) = delete;
+
+                /**
+                 * Publishes the changes that were deferred, unless an outer guard or transaction
+                 * was still deferring them.
+                 **/
+                ~DeferredPublication();
+
+            private:
+                /**
+                 * The seating plan.
+                 **/
+                SeatingPlan &m_plan;
+
+                /**
+                 * Whether the publication was already deferred before the guard.
+                 **/
+                bool m_was_applying;
+        };
+
+        /**
+         * A group of changes of a seating plan, which were staged and then applied all at once, or
+         * not at all. The seating plan was not touched until the transaction was committed, thus the
+         * readers that synchronize with the writer never observe a partially applied transaction.
+         **/
+        class SeatingPlan::Transaction
+        {
+            public:
+                /**
+                 * Begins a transaction of a seating plan.
+                 *
+                 * @param plan The seating plan, which must outlive the transaction.
+                 **/
+                explicit Transaction(SeatingPlan &plan);
+
+                Transaction(Transaction &&other) noexcept;
+
+                Transaction(const Transaction&) = delete;
+
+                Transaction& operator =(const Transaction&) = delete;
+
+                /**
+                 * Discards the staged changes if the transaction was not committed.
+                 **/
+                ~Transaction();
+
+                /**
+                 * Stages the assignment of a passenger to a specific seat.
+                 *
+                 * @param location  The location of the seat.
+                 * @param passenger The passenger to be assigned.
+                 **/
+                void assign(const SeatLocation &location, Passenger passenger);
+
+                /**
+                 * Stages the removal of the passenger at the specific seat.
+                 *
+                 * @param location The location of the seat.
+                 **/
+                void remove(const SeatLocation &location);
+
+                /**
+                 * Stages the removal of a specific passenger, if the passenger was assigned.
+                 *
+                 * @param passenger The passenger to remove.
+                 **/
+                void remove(const Passenger &passenger);
+
+                /**
+                 * Stages the move of a passenger to a specific seat, or the assignment if the
+                 * passenger was not assigned.
+                 *
+                 * @param passenger The passenger to move.
+                 * @param location  The location of the seat.
+                 **/
+                void move(const Passenger &passenger, const SeatLocation &location);
+
+                /**
+                 * Returns the number of staged changes.
+                 **/
+                size_t size() const { return m_changes.size(); }
+
+                /**
+                 * Applies the staged changes in order. If any of the changes could not be applied,
+                 * the error of SeatingPlan::assign() will be thrown and the seating plan was left
+                 * unchanged.
+                 **/
+                void commit();
+
+                /**
+                 * Discards the staged changes.
+                 **/
+                void rollback();
+
+            private:
+                /**
+                 * A staged change.
+                 **/
+                struct Change
+                {
+                    /** Whether the change assigns a passenger, otherwise removes one. */
+                    bool is_assignment;
+
+                    /** The location of the seat, or nothing to remove the passenger wherever was seated. */
+                    optional<SeatLocation> location;
+
+                    /** The passenger to assign or remove. */
+                    optional<Passenger> passenger;
+                };
+
+                /**
+                 * The seating plan of the transaction, or nullptr if the transaction was finished.
+                 **/
+                SeatingPlan *m_plan;
+
+                /**
+                 * The staged changes, in order.
+                 **/
+                std::vector<Change> m_changes;
+        };
+
+        /**
+         * Allocates the vacant seats of a seating plan automatically. The allocator prefers the
+         * requested ticket class, then the seat nearest to the requested seat, and keeps the members
+         * of a party side by side whenever possible.
+         **/
+        class SeatAllocator
+        {
+            public:
+                /**
+                 * Initialize an allocator with the vacant seats of a seating plan.
+                 *
+                 * @param plan The seating plan, which must outlive the allocator.
+                 **/
+                explicit SeatAllocator(const SeatingPlan &plan);
+
+                /**
+                 * Determine whether the seat was available for allocation.
+                 *
+                 * @param location The location of the seat.
+                 **/
+                bool is_vacant(const SeatLocation &location) const;
+
+                /**
+                 * Marks a seat as occupied, so it will not be allocated.
+                 *
+                 * @param location The location of the seat.
+                 **/
+                void reserve(const SeatLocation &location);
+
+                /**
+                 * Marks a seat as vacant, unless it was blocked by the cabin layout.
+                 *
+                 * @param location The location of the seat.
+                 **/
+                void release(const SeatLocation &location);
+
+                /**
+                 * Allocates the vacant seat nearest to the preferred seat. Returns nothing if the
+                 * seating plan was full.
+                 *
+                 * @param ticket_class The preferred ticket class, or the ticket class of the
+                 *                     preferred seat if not given.
+                 * @param preferred    The preferred seat, or the front of the ticket class if not given.
+                 **/
+                optional<SeatLocation> allocate(optional<TicketClass> ticket_class, optional<SeatLocation> preferred = std::nullopt);
+
+                /**
+                 * Allocates the seats for a party, side by side in a row if possible, otherwise each
+                 * member was seated nearest to the previous one. Returns nothing, without allocating
+                 * any seats, if there were not enough vacant seats.
+                 *
+                 * @param count        The number of members.
+                 * @param ticket_class The preferred ticket class, or the ticket class of the
+                 *                     preferred seat if not given.
+                 * @param preferred    The preferred seat, or the front of the ticket class if not given.
+                 **/
+                optional<std::vector<SeatLocation>> allocate_party(size_t count, optional<TicketClass> ticket_class, optional<SeatLocation> preferred = std::nullopt);
+
+            private:
+                /**
+                 * Finds the group of vacant seats that were side by side and nearest to the anchor.
+                 * Returns the leftmost seat of the group.
+                 *
+                 * @param count        The number of seats.
+                 * @param ticket_class The ticket class of the seats, or any ticket classes.
+                 * @param anchor       The seat to measure the distance from.
+                 **/
+                optional<SeatLocation> find_nearest(size_t count, optional<TicketClass> ticket_class, const SeatLocation &anchor) const;
+
+                /**
+                 * Returns the seat to measure the distance from.
+                 *
+                 * @param ticket_class The preferred ticket class.
+                 * @param preferred    The preferred seat.
+                 **/
+                SeatLocation anchor_of(optional<TicketClass> ticket_class, const optional<SeatLocation> &preferred) const;
+
+                /**
+                 * The cabin layout of the seating plan.
+                 **/
+                const CabinLayout &m_layout;
+
+                /**
+                 * The vacant seats of each row, where bit N represents the Nth column.
+                 **/
+                std::vector<std::uint64_t> m_vacant;
+
+                /**
+                 * The total number of vacant seats.
+                 **/
+                size_t m_vacant_count;
+        };
+
+        /**
+         * Lets concurrent agents claim the vacant seats of a seating plan, where exactly one claimant
+         * wins each seat without locking, and each passenger wins at most one seat. The claims were
+         * applied to the seating plan afterwards.
+         **/
+        class SeatClaimBoard
+        {
+            public:
+                /**
+                 * Initialize a claim board with the vacant seats of a seating plan.
+                 *
+                 * @param plan The seating plan, which must outlive the claim board.
+                 **/
+                explicit SeatClaimBoard(const SeatingPlan &plan);
+
+                /**
+                 * Claims a vacant seat for a passenger. Returns whether the claim won the seat, which
+                 * could be called from multiple threads concurrently. The claim was rejected if the
+                 * passenger already held a claim, or was assigned a seat when the claim board was
+                 * initialized. A claim
+                 * could also lose a seat that was being taken by such a rejected claim.
+                 *
+                 * @param location  The location of the seat.
+                 * @param passenger The passenger to claim the seat for.
+                 **/
+                bool try_claim(const SeatLocation &location, const Passenger &passenger);
+
+                /**
+                 * Returns the passenger who won the seat, if any.
+                 *
+                 * @param location The location of the seat.
+                 **/
+                optional<Passenger> claimant(const SeatLocation &location) const;
+
+                /**
+                 * Returns the number of seats which were won.
+                 **/
+                size_t size() const noexcept { return m_claim_count.load(std::memory_order_acquire); }
+
+                /**
+                 * Assigns the seats to the claimants through a single transaction, then clears the
+                 * committed claims. The claims that were won while committing were kept for the next
+                 * commit. Nothing was changed if the transaction failed.
+                 *
+                 * @param plan The seating plan, which the claim board was initialized with.
+                 **/
+                void commit(SeatingPlan &plan);
+
+            private:
+                /**
+                 * The states of a seat.
+                 **/
+                enum State : std::uint8_t
+                {
+                    kVacant,
+                    kClaiming,
+                    kClaimed,
+                    kCommitting,
+                    kUnavailable,
+                };
+
+                /**
+                 * The states of a slot of the passport table.
+                 **/
+                enum SlotState : std::uint8_t
+                {
+                    kEmptySlot,
+                    kWritingSlot,
+                    kReadySlot,
+                };
+
+                /**
+                 * A slot of the passport table, which was written once by the claimant who took it.
+                 **/
+                struct PassportSlot
+                {
+                    std::atomic<std::uint8_t> state { kEmptySlot };
+
+                    PassportId passport_id { string_view() };
+                };
+
+                /**
+                 * Inserts a passport ID into the passport table. Returns false if it was already
+                 * inserted, which could be called from multiple threads concurrently.
+                 *
+                 * @param passport_id The passport ID.
+                 **/
+                bool insert_passport(const PassportId &passport_id);
+
+                /**
+                 * The cabin layout of the seating plan.
+                 **/
+                const CabinLayout &m_layout;
+
+                /**
+                 * The state of each seat.
+                 **/
+                std::unique_ptr<std::atomic<std::uint8_t>[]> m_states;
+
+                /**
+                 * The claimant of each seat, written only by the claimant who won the seat.
+                 **/
+                std::vector<optional<Passenger>> m_claimants;
+
+                /**
+                 * The passport IDs of the claimants and the assigned passengers, in an open
+                 * addressing table that holds twice the seats, thus it never fills up.
+                 **/
+                std::unique_ptr<PassportSlot[]> m_passports;
+
+                /**
+                 * The mask of the slot indices of the passport table.
+                 **/
+                size_t m_passport_mask;
+
+                /**
+                 * The number of seats which were won.
+                 **/
+                std::atomic<size_t> m_claim_count;
+        };
+
+        /**
+         * Identifies a flight by its flight number and departure date.
+         **/
+        struct FlightKey
+        {
+            /**
+             * The flight number, e.g. "CX888".
+             **/
+            string flight_number;
+
+            /**
+             * The departure date, e.g. "2021-04-01".
+             **/
+            string date;
+
+            bool operator ==(const FlightKey &other) const { return ((flight_number == other.flight_number) && (date == other.date)); }
+
+            bool operator !=(const FlightKey &other) const { return !(*this == other); }
+        };
+
+        /**
+         * The hash function of FlightKey.
+         **/
+        struct FlightKeyHash
+        {
+            size_t operator()(const FlightKey &key) const noexcept;
+        };
+
+        /**
+         * Represents a flight and its seating plan. The seating plan was allocated from a pool that
+         * belongs to the flight, which recycles the blocks of the removed passengers and was
+         * released as a whole when the flight was destroyed.
+         **/
+        class Flight
+        {
+            public:
+                /**
+                 * Initialize a flight with an empty seating plan.
+                 *
+                 * @param key      The flight number and departure date.
+                 * @param resource The memory resource that the pool of the flight was refilled from.
+                 **/
+                Flight(const FlightKey &key, std::pmr::memory_resource *resource);
+
+                /**
+                 * Returns the flight number and departure date.
+                 **/
+                const FlightKey& key() const { return m_key; }
+
+                /**
+                 * Reads the seating plan while holding the lock of this flight.
+                 *
+                 * @param function The function that receives the seating plan.
+                 **/
+                template<typename TFunction>
+                auto read(TFunction &&function) const
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    return function(static_cast<const SeatingPlan&>(m_seating_plan));
+                }
+
+                /**
+                 * Modifies the seating plan while holding the lock of this flight.
+                 *
+                 * @param function The function that receives the seating plan.
+                 **/
+                template<typename TFunction>
+                auto modify(TFunction &&function)
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    return function(m_seating_plan);
+                }
+
+            private:
+                /**
+                 * The flight number and departure date.
+                 **/
+                FlightKey m_key;
+
+                /**
+                 * The lock that guards the seating plan.
+                 **/
+                mutable std::mutex m_mutex;
+
+                /**
+                 * The pool of the seating plan, which was guarded by the lock of the flight.
+                 **/
+                std::pmr::unsynchronized_pool_resource m_pool;
+
+                /**
+                 * The pool of the snapshots of the seating plan, which was guarded by its own lock
+                 * since the readers might release the snapshots on other threads. The snapshots keep
+                 * it alive after the flight was destroyed.
+                 **/
+                std::shared_ptr<std::pmr::memory_resource> m_snapshot_pool;
+
+                /**
+                 * The seating plan of the flight.
+                 **/
+                SeatingPlan m_seating_plan;
+        };
+
+        /**
+         * Owns the flights and their seating plans. The flights were sharded by their keys, each
+         * shard has its own lock and memory pool, and each flight has its own lock, so independent
+         * flights could be modified concurrently.
+         *
+         * The flights returned by the registry must not outlive the registry.
+         *
+         * The flights could also be loaded on demand from a backing store, e.g. a flight database,
+         * the first time they were opened or found.
+         **/
+        class FlightRegistry
+        {
+            public:
+                /**
+                 * Restores a flight from the backing store into its empty seating plan. Returns false
+                 * if the flight does not exist in the backing store.
+                 **/
+                using Loader = std::function<bool(const FlightKey &key, SeatingPlan &plan)>;
+
+                /**
+                 * Returns whether a flight exists in the backing store, without restoring it.
+                 **/
+                using Prober = std::function<bool(const FlightKey &key)>;
+
+                /**
+                 * Releases a flight that was removed from the registry, e.g. detaches the observers
+                 * that the loader attached to its seating plan.
+                 **/
+                using Unloader = std::function<void(const FlightKey &key, SeatingPlan &plan)>;
+
+                /**
+                 * Initialize an empty registry.
+                 *
+                 * @param shard_count The number of shards.
+                 **/
+                explicit FlightRegistry(size_t shard_count = 16);
+
+                /**
+                 * Sets the loader of the flights that were not in the registry yet. Must be set before
+                 * the registry was used concurrently.
+                 *
+                 * @param loader The loader.
+                 **/
+                void set_loader(Loader loader);
+
+                /**
+                 * Sets the prober of the flights that were not in the registry yet, which allows
+                 * closing them without loading them. Must be set before the registry was used
+                 * concurrently.
+                 *
+                 * @param prober The prober.
+                 **/
+                void set_prober(Prober prober);
+
+                /**
+                 * Sets the unloader of the flights that were closed. Must be set before the registry
+                 * was used concurrently.
+                 *
+                 * @param unloader The unloader.
+                 **/
+                void set_unloader(Unloader unloader);
+
+                /**
+                 * Returns the flight with the given key, the flight will be loaded or created if not
+                 * exist.
+                 *
+                 * @param key The flight number and departure date.
+                 **/
+                std::shared_ptr<Flight> open(const FlightKey &key);
+
+                /**
+                 * Returns the flight with the given key, if exists. The flight will be loaded if it
+                 * was not in the registry yet.
+                 *
+                 * @param key The flight number and departure date.
+                 **/
+                std::shared_ptr<Flight> find(const FlightKey &key) const;
+
+                /**
+                 * Removes the flight with the given key from the registry, returns false if it does
+                 * not exist. The flight would not be loaded again, unless it was reopened.
+                 *
+                 * @param key The flight number and departure date.
+                 **/
+                bool close(const FlightKey &key);
+
+                /**
+                 * Returns whether the flight with the given key was closed and not reopened since the
+                 * loader was set.
+                 *
+                 * @param key The flight number and departure date.
+                 **/
+                bool is_closed(const FlightKey &key) const;
+
+                /**
+                 * Returns whether the flight with the given key was in the registry, without loading
+                 * it from the backing store.
+                 *
+                 * @param key The flight number and departure date.
+                 **/
+                bool is_loaded(const FlightKey &key) const;
+
+                /**
+                 * Returns the number of flights in the registry, excluding those not loaded yet.
+                 **/
+                size_t size() const;
+
+                /**
+                 * Returns all the flights in the registry, excluding those not loaded yet.
+                 **/
+                std::vector<std::shared_ptr<Flight>> flights() const;
+
+            private:
+                /**
+                 * A partition of the registry.
+                 **/
+                struct Shard
+                {
+                    /**
+                     * The lock that guards the flights of the shard.
+                     **/
+                    mutable std::mutex mutex;
+
+                    /**
+                     * The memory pool that the flights of the shard and their pools were allocated from.
+                     **/
+                    std::pmr::synchronized_pool_resource pool;
+
+                    /**
+                     * The flights of the shard.
+                     **/
+                    std::unordered_map<FlightKey, std::shared_ptr<Flight>, FlightKeyHash> flights;
+
+                    /**
+                     * The flights of the shard that were closed, so they would not be loaded again.
+                     **/
+                    std::unordered_set<FlightKey, FlightKeyHash> closed_flights;
+                };
+
+                /**
+                 * Returns the shard of the flight with the given key.
+                 *
+                 * @param key The flight number and departure date.
+                 **/
+                Shard& shard_of(const FlightKey &key) const;
+
+                /**
+                 * Loads a flight that was not in its shard, the lock of the shard must be held.
+                 * Returns nothing if the flight does not exist in the backing store.
+                 *
+                 * @param shard The shard of the flight.
+                 * @param key   The flight number and departure date.
+                 **/
+                std::shared_ptr<Flight> load(Shard &shard, const FlightKey &key) const;
+
+                /**
+                 * The shards of the registry.
+                 **/
+                std::vector<std::unique_ptr<Shard>> m_shards;
+
+                /**
+                 * The loader of the flights that were not in the registry yet, if any.
+                 **/
+                Loader m_loader;
+
+                /**
+                 * The prober of the flights that were not in the registry yet, if any.
+                 **/
+                Prober m_prober;
+
+                /**
+                 * The unloader of the flights that were closed, if any.
+                 **/
+                Unloader m_unloader;
+        };
+
+        /**
+         * Converts the ticket class to a string.
+         *
+         * @param ticket_class The ticket class to convert.
+         **/
+        string to_string(TicketClass ticket_class) noexcept;
+    }
+}
+
+#endif
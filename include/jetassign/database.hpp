@@ -0,0 +1,355 @@
+/**
+ * Copyright (c) 2021 Jason Kwok, Ben Ho, Ben Yip, Harry Lam, and Hins To.
+ *
+ * Licensed under the GNU Affero General Public License, Version 3.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of the License at
+ *
+ *     https://github.com/JasonHK-HKCC/SEHH2042-Group-Project/blob/master/LICENSE
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under the License
+ * is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ * or implied. See the License for the specific language governing permissions and limitations under
+ * the License.
+ **/
+
+#ifndef JETASSIGN_DATABASE_HPP
+#define JETASSIGN_DATABASE_HPP
+
+#include "jetassign/core.hpp"
+#include "jetassign/storage.hpp"
+
+namespace jetassign
+{
+    /**
+     * A flight database stores many seating plans in a fixed layout, which was used directly from a
+     * memory mapping of the file. Opening a database only reads its header, and the pages of each
+     * flight were read from the disk when the flight was used.
+     *
+     * All the integers were little-endian, and the offsets were from the start of the file:
+     *
+     *     header:    magic "JASD", version (u16), reserved (u16), journal generation (u32),
+     *                number of flights (u32), offset of the directory (u64),
+     *                offset of the string heap (u64), offset of the name table (u64),
+     *                number of names (u32), reserved (u32)
+     *     directory: one entry for each flight, sorted by the flight number and date:
+     *                offset of the flight number and date in the heap (u32),
+     *                length of the flight number (u16), length of the date (u16), rows (u32),
+     *                columns (u32), offset of the flight (u64), number of passengers (u32),
+     *                reserved (u32)
+     *     flight:    the occupied bits of each row (u64), where bit N represents the Nth column,
+     *                followed by a record for each seat in row-major order:
+     *                offset of the name in the heap (u32), length of the name (u16),
+     *                length of the passport ID (u8), reserved (u8), passport ID (16 bytes)
+     *     names:     one entry for each passenger, sorted by the normalized name, then by the flight
+     *                and the seat: offset of the normalized name in the heap (u32), length of the
+     *                normalized name (u16), reserved (u16), position of the flight in the directory
+     *                (u32), seat index (u32)
+     *     heap:      the flight numbers, dates and names, each distinct name stored once
+     *
+     * The seating plan of the console was stored as the flight without a flight number and date.
+     * The name table lets the passengers of the flights be searched by their names without reading
+     * the flights, the databases of version 1 have no name table.
+     **/
+    namespace storage
+    {
+        /**
+         * The version of the flight database format.
+         **/
+        constexpr std::uint16_t kDatabaseVersion = 2;
+
+        /**
+         * A passenger stored in a flight database, which refers to the memory mapping.
+         **/
+        struct MappedPassenger
+        {
+            /**
+             * The name of the passenger.
+             **/
+            string_view name;
+
+            /**
+             * The passport ID of the passenger.
+             **/
+            string_view passport_id;
+        };
+
+        /**
+         * An entry of the name table of a flight database, which refers to the memory mapping.
+         **/
+        struct MappedName
+        {
+            /**
+             * The normalized name of the passenger, as search::NameIndex::normalize() returns.
+             **/
+            string_view normalized_name;
+
+            /**
+             * The position of the flight in the directory.
+             **/
+            size_t flight;
+
+            /**
+             * The index of the seat in the flight.
+             **/
+            size_t seat;
+        };
+
+        /**
+         * A seating plan stored in a flight database, which must not outlive the database.
+         **/
+        class MappedFlight
+        {
+            public:
+                /**
+                 * Returns the flight number, empty for the console.
+                 **/
+                string_view flight_number() const { return m_flight_number; }
+
+                /**
+                 * Returns the departure date, empty for the console.
+                 **/
+                string_view date() const { return m_date; }
+
+                /**
+                 * Returns the flight number and departure date.
+                 **/
+                core::FlightKey key() const { return { string(m_flight_number), string(m_date) }; }
+
+                /**
+                 * Returns the number of rows.
+                 **/
+                size_t rows() const { return m_rows; }
+
+                /**
+                 * Returns the number of columns.
+                 **/
+                size_t columns() const { return m_columns; }
+
+                /**
+                 * Returns the number of assigned passengers.
+                 **/
+                size_t size() const { return m_size; }
+
+                /**
+                 * Returns the occupied seats of a row, where bit N represents the Nth column.
+                 *
+                 * @param row The row.
+                 **/
+                std::uint64_t occupied_bits(size_t row) const;
+
+                /**
+                 * Returns whether a seat was occupied.
+                 *
+                 * @param row    The row of the seat.
+                 * @param column The column of the seat.
+                 **/
+                bool is_occupied(size_t row, size_t column) const;
+
+                /**
+                 * Returns the passenger of a seat, if occupied.
+                 *
+                 * @param row    The row of the seat.
+                 * @param column The column of the seat.
+                 **/
+                optional<MappedPassenger> at(size_t row, size_t column) const;
+
+                /**
+                 * Returns the seat location of the passenger with the given passport ID, if assigned.
+                 * Only the occupied seats of the flight were read.
+                 *
+                 * @param passport_id The passport ID of the passenger.
+                 **/
+                optional<core::SeatLocation> location_of(string_view passport_id) const;
+
+                /**
+                 * Assigns the passengers of the flight into an empty seating plan.
+                 *
+                 * @param plan The seating plan, which must have the same cabin layout.
+                 **/
+                void restore(core::SeatingPlan &plan) const;
+
+            private:
+                friend class FlightDatabase;
+
+                MappedFlight(string_view heap, string_view flight_number, string_view date, size_t rows, size_t columns, size_t size, const char *data)
+                    : m_heap { heap }, m_flight_number { flight_number }, m_date { date }, m_rows { rows }, m_columns { columns }, m_size { size }, m_data { data } {}
+
+                /**
+                 * The string heap of the database.
+                 **/
+                string_view m_heap;
+
+                string_view m_flight_number;
+
+                string_view m_date;
+
+                size_t m_rows;
+
+                size_t m_columns;
+
+                size_t m_size;
+
+                /**
+                 * The occupied bits and the seat records of the flight.
+                 **/
+                const char *m_data;
+        };
+
+        /**
+         * A read-only memory mapping of a flight database file.
+         **/
+        class FlightDatabase
+        {
+            public:
+                /**
+                 * Maps a flight database file. Returns nothing if the file does not exist.
+                 *
+                 * @param path The path of the flight database file.
+                 **/
+                static std::unique_ptr<FlightDatabase> open(const string &path);
+
+                /**
+                 * Unmaps the file.
+                 **/
+                ~FlightDatabase();
+
+                FlightDatabase(const FlightDatabase&) = delete;
+
+                FlightDatabase& operator =(const FlightDatabase&) = delete;
+
+                /**
+                 * Returns the generation of the journal that continues from the database.
+                 **/
+                std::uint32_t generation() const { return m_generation; }
+
+                /**
+                 * Returns the number of flights, including the console.
+                 **/
+                size_t size() const { return m_size; }
+
+                /**
+                 * Returns the flight at the given position of the directory.
+                 *
+                 * @param index The position of the flight.
+                 **/
+                MappedFlight at(size_t index) const;
+
+                /**
+                 * Returns the flight with the given key, if exists.
+                 *
+                 * @param key The flight number and departure date, empty for the console.
+                 **/
+                optional<MappedFlight> find(const core::FlightKey &key) const;
+
+                /**
+                 * Returns the number of entries of the name table, which was one for each passenger.
+                 **/
+                size_t names() const { return m_names_size; }
+
+                /**
+                 * Returns the entry at the given position of the name table.
+                 *
+                 * @param index The position of the entry.
+                 **/
+                MappedName name_at(size_t index) const;
+
+                /**
+                 * Returns the position of the first entry of the name table whose normalized name was
+                 * not less than the given one, only the entries that were compared were read.
+                 *
+                 * @param normalized_name The normalized name.
+                 **/
+                size_t lower_bound_name(string_view normalized_name) const;
+
+            private:
+                struct Mapping;
+
+                FlightDatabase(std::unique_ptr<Mapping> mapping);
+
+                /**
+                 * The mapping of the file.
+                 **/
+                std::unique_ptr<Mapping> m_mapping;
+
+                /**
+                 * The contents of the file.
+                 **/
+                string_view m_file;
+
+                /**
+                 * The string heap.
+                 **/
+                string_view m_heap;
+
+                /**
+                 * The directory of the flights.
+                 **/
+                const char *m_directory;
+
+                /**
+                 * The number of flights.
+                 **/
+                size_t m_size;
+
+                /**
+                 * The name table.
+                 **/
+                const char *m_names;
+
+                /**
+                 * The number of entries of the name table.
+                 **/
+                size_t m_names_size;
+
+                /**
+                 * The generation of the journal.
+                 **/
+                std::uint32_t m_generation;
+        };
+
+        /**
+         * Saves the seating plans into a flight database file atomically, by writing a temporary
+         * file and then renaming it. The flights of the previous database that were neither loaded
+         * into the registry nor closed were copied as they were. Returns the size of the database.
+         *
+         * The previous database was unmapped before the file was replaced, and mapped again after.
+         *
+         * @param path         The path of the flight database file.
+         * @param seating_plan The seating plan of the console.
+         * @param flights      The flights of the registry.
+         * @param database     The mapping of the previous database, if any.
+         * @param generation   The generation of the journal that continues from the database.
+         * @param journal      The journal that holds the later changes of each seating plan after it
+         *                     was saved, during a compaction.
+         **/
+        size_t save_database(const string &path, const core::SeatingPlan &seating_plan, const core::FlightRegistry &flights, std::unique_ptr<FlightDatabase> &database, std::uint32_t generation = 0, Journal *journal = nullptr);
+
+        /**
+         * Maps a flight database file, restores the seating plan of the console from it, and lets
+         * the registry load the other flights on demand. Returns the mapping and the generation of
+         * the journal that continues from the database, or nothing if the file does not exist.
+         *
+         * @param path         The path of the flight database file.
+         * @param seating_plan The empty seating plan of the console.
+         * @param flights      The empty registry, whose loader refers to the mapping.
+         * @param database     Receives the mapping, which must outlive the registry.
+         **/
+        optional<std::uint32_t> load_database(const string &path, core::SeatingPlan &seating_plan, core::FlightRegistry &flights, std::unique_ptr<FlightDatabase> &database);
+
+        /**
+         * Saves the seating plans into a flight database, then starts a new generation of the
+         * journal. The flights could be changed concurrently, their changes after being saved were
+         * held until the new generation started, but the console must not be. Returns the size of
+         * the database.
+         *
+         * @param path         The path of the flight database file.
+         * @param journal      The journal of the seating plans.
+         * @param seating_plan The seating plan of the console.
+         * @param flights      The flights of the registry.
+         * @param database     The mapping of the previous database, if any.
+         **/
+        size_t compact_database(const string &path, Journal &journal, const core::SeatingPlan &seating_plan, const core::FlightRegistry &flights, std::unique_ptr<FlightDatabase> &database);
+    }
+}
+
+#endif
@@ -0,0 +1,124 @@
+/**
+ * Copyright (c) 2021 Jason Kwok, Ben Ho, Ben Yip, Harry Lam, and Hins To.
+ *
+ * Licensed under the GNU Affero General Public License, Version 3.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of the License at
+ *
+ *     https://github.com/JasonHK-HKCC/SEHH2042-Group-Project/blob/master/LICENSE
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under the License
+ * is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ * or implied. See the License for the specific language governing permissions and limitations under
+ * the License.
+ **/
+
+#ifndef JETASSIGN_EXCEPTIONS_HPP
+#define JETASSIGN_EXCEPTIONS_HPP
+
+#include <stdexcept>
+
+#include "jetassign/core.hpp"
+
+namespace jetassign
+{
+    /**
+     * The exceptions component.
+     **/
+    namespace exceptions
+    {
+        using std::invalid_argument;
+        using std::runtime_error;
+
+        using core::SeatLocation;
+
+        /**
+         * An error that will throw when the requested seat was already occupied by another passenger.
+         **/
+        class SeatOccupiedError : public runtime_error
+        {
+            public:
+                SeatOccupiedError(const SeatLocation &location)
+                    : runtime_error("The requested seat was already occupied by another passenger."),
+                      location { location } {};
+
+                /**
+                 * Returns the location of the occupied seat.
+                 **/
+                const SeatLocation get_location() const { return location; }
+
+            private:
+                SeatLocation location;
+        };
+
+        /**
+         * An error that will throw when the requested seat was blocked by the cabin layout.
+         **/
+        class SeatBlockedError : public runtime_error
+        {
+            public:
+                SeatBlockedError(const SeatLocation &location)
+                    : runtime_error("The requested seat was not available for assignment."),
+                      location { location } {};
+
+                /**
+                 * Returns the location of the blocked seat.
+                 **/
+                const SeatLocation get_location() const { return location; }
+
+            private:
+                SeatLocation location;
+        };
+
+        /**
+         * An error that will throw when the passport ID was already assigned a seat.
+         **/
+        class PassengerAssignedError : public runtime_error
+        {
+            public:
+                PassengerAssignedError(const SeatLocation &location)
+                    : runtime_error("A passenger with the same passport ID was already assigned a seat."),
+                      location { location } {};
+
+                /**
+                 * Returns the location of the assigned seat.
+                 **/
+                const SeatLocation get_location() const { return location; }
+
+            private:
+                SeatLocation location;
+        };
+
+        class InvalidInputError : public invalid_argument
+        {
+            using invalid_argument::invalid_argument;
+        };
+
+        class EmptyInputError : public InvalidInputError
+        {
+            using InvalidInputError::InvalidInputError;
+        };
+
+        class MalformedInputError : public InvalidInputError
+        {
+            using InvalidInputError::InvalidInputError;
+        };
+
+        /**
+         * An error that will throw when the seating plans could not be saved or loaded.
+         **/
+        class StorageError : public runtime_error
+        {
+            using runtime_error::runtime_error;
+        };
+
+        /**
+         * An error that will throw when the server could not listen on a socket.
+         **/
+        class ServerError : public runtime_error
+        {
+            using runtime_error::runtime_error;
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,278 @@
+/**
+ * Copyright (c) 2021 Jason Kwok, Ben Ho, Ben Yip, Harry Lam, and Hins To.
+ *
+ * Licensed under the GNU Affero General Public License, Version 3.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of the License at
+ *
+ *     https://github.com/JasonHK-HKCC/SEHH2042-Group-Project/blob/master/LICENSE
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under the License
+ * is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ * or implied. See the License for the specific language governing permissions and limitations under
+ * the License.
+ **/
+
+#ifndef JETASSIGN_INPUT_HPP
+#define JETASSIGN_INPUT_HPP
+
+#include <functional>
+#include <istream>
+#include <utility>
+#include <vector>
+
+#include "jetassign/core.hpp"
+
+namespace jetassign
+{
+    /**
+     * The input component.
+     **/
+    namespace input
+    {
+        using std::vector;
+
+        using core::Passenger;
+        using core::SeatLocation;
+        using core::TicketClass;
+
+        /**
+         * The seat location of an assignment request that accepts any seats.
+         **/
+        constexpr char kAnySeat[] = "*";
+
+        /**
+         * Represents an assignmnet request.
+         **/
+        class AssignmentRequest
+        {
+            public:
+                /**
+                 * Initialize an assignmnet request with a passenger and seat location.
+                 *
+                 * @param passenger    The requesting passenger.
+                 * @param location     The requested seat location, or nothing to allocate a seat automatically.
+                 * @param ticket_class The requested ticket class, if any.
+                 * @param party        The party of the passenger, if any.
+                 **/
+                AssignmentRequest(Passenger passenger, optional<SeatLocation> location, optional<TicketClass> ticket_class = std::nullopt, string party = "");
+
+                /**
+                 * Initialize an assignmnet request with a passenger name, passport ID and seat location.
+                 **/
+                AssignmentRequest(string passenger_name, string passport_id, const SeatLocation &seat_location);
+
+                /**
+                 * Returns the requesting passanger.
+                 **/
+                Passenger passenger() const { return m_passenger; }
+
+                /**
+                 * Returns the requested seat location, or nothing if the seat should be allocated automatically.
+                 **/
+                optional<SeatLocation> location() const { return m_location; }
+
+                /**
+                 * Returns the requested ticket class, if any.
+                 **/
+                optional<TicketClass> ticket_class() const { return m_ticket_class; }
+
+                /**
+                 * Returns the party of the passenger, or an empty string if the passenger travels alone.
+                 **/
+                const string& party() const { return m_party; }
+
+                /**
+                 * Returns a copy of the request with the seat location replaced.
+                 *
+                 * @param location The seat location.
+                 **/
+                AssignmentRequest with_location(const SeatLocation &location) const;
+
+                /**
+                 * Determine whether two instances represent the assignmnet request for the same passenger.
+                 *
+                 * @param other The other instance.
+                 **/
+                bool is_same_passenger(const AssignmentRequest &other) const;
+
+                /**
+                 * Determine whether two instances represent the same assignmnet request.
+                 *
+                 * @param other The other instance.
+                 **/
+                bool equals(const AssignmentRequest &other) const;
+
+                /**
+                 * Determine whether two instances represent the same assignmnet request.
+                 *
+                 * @param other The other instance.
+                 **/
+                bool operator ==(const AssignmentRequest &other) const { return equals(other); }
+
+                /**
+                 * Determine whether two instances represent different assignmnet request.
+                 *
+                 * @param other The other instance.
+                 **/
+                bool operator !=(const AssignmentRequest &other) const { return !equals(other); }
+
+                string to_string() const;
+
+            private:
+                /**
+                 * The requesting passanger.
+                 **/
+                Passenger m_passenger;
+
+                /**
+                 * The requested seat location.
+                 **/
+                optional<SeatLocation> m_location;
+
+                /**
+                 * The requested ticket class.
+                 **/
+                optional<TicketClass> m_ticket_class;
+
+                /**
+                 * The party of the passenger.
+                 **/
+                string m_party;
+        };
+
+        /**
+         * The result of importing compact assignments.
+         **/
+        struct ImportReport
+        {
+            /**
+             * The number of lines that were committed to the seating plan.
+             **/
+            size_t accepted = 0;
+
+            /**
+             * The number of lines that were rejected.
+             **/
+            size_t rejected = 0;
+        };
+
+        /**
+         * Import the compact assignments into the seating plan without prompting. A passenger who was
+         * already assigned will be moved to the requested seat. If the requested seat was occupied,
+         * the nearest vacant seat was allocated instead. Empty lines were ignored.
+         *
+         * @param input     The stream of compact assignments, one per line.
+         * @param plan      The seating plan to import into.
+         * @param on_reject Receives the line number and the reason of each rejected line.
+         **/
+        ImportReport import_compact_assignments(
+            istream &input,
+            core::SeatingPlan &plan,
+            const std::function<void(size_t, const string&)> &on_reject = nullptr);
+
+        /**
+         * The result of validating a batch of assignment requests.
+         **/
+        struct BatchValidation
+        {
+            /**
+             * The requests that could be committed as requested.
+             **/
+            vector<AssignmentRequest> valid;
+
+            /**
+             * The requests without a seat location or with an occupied seat, which should be
+             * allocated a seat automatically.
+             **/
+            vector<AssignmentRequest> unseated;
+
+            /**
+             * The requests that were dropped because the passenger was already assigned a seat.
+             **/
+            vector<AssignmentRequest> assigned;
+
+            /**
+             * The occupation state of the seats that were changed by the batch, in row-major order.
+             **/
+            vector<std::pair<SeatLocation, bool>> occupation;
+        };
+
+        /**
+         * Validates a batch of assignment requests against the seating plan, where the conflicts
+         * were resolved in the input order. A request for a passenger who was already assigned a
+         * seat must be confirmed before the passenger could be moved.
+         *
+         * With more than one thread, the requests were partitioned by passport ID and by cabin
+         * section and validated in parallel, which produces the same result as the sequential path.
+         *
+         * @param plan                 The seating plan.
+         * @param requests             The assignment requests, in the input order.
+         * @param confirm_reassignment Asked, in the input order, whether an assigned passenger should
+         *                             be moved from the current seat.
+         * @param thread_count         The number of threads.
+         **/
+        BatchValidation validate_assignments(
+            const core::SeatingPlan &plan,
+            const vector<AssignmentRequest> &requests,
+            const std::function<bool(const AssignmentRequest&, const SeatLocation&)> &confirm_reassignment,
+            size_t thread_count = 1);
+
+        /**
+         * The input parsers component.
+         **/
+        namespace parsers
+        {
+            /**
+             * Parse the yes/no confirmation from the input.
+             *
+             * @param input The user's input.
+             **/
+            bool parse_confirmation(string_view input);
+
+            /**
+             * Parse the yes/no confirmation from the input.
+             *
+             * @param input         The user's input.
+             * @param default_value The default confirmation.
+             **/
+            bool parse_confirmation(string_view input, bool default_value);
+
+            /**
+             * Parse the menu selection from the input.
+             *
+             * @param input The user's input.
+             **/
+            long parse_menu_option(string_view input);
+
+            /**
+             * Parse the passenger name from the input.
+             *
+             * @param input The user's input.
+             **/
+            string parse_passenger_name(string_view input);
+
+            /**
+             * Parse the passport ID from the input.
+             *
+             * @param input The user's input.
+             **/
+            string parse_passport_id(string_view input);
+
+            /**
+             * Parse the seat location from the input.
+             *
+             * @param input The user's input.
+             **/
+            SeatLocation parse_seat_location(string_view input);
+
+            /**
+             * Parse the passenger name, passport ID, and seat location from the input.
+             *
+             * @param input The user's input.
+             **/
+            AssignmentRequest parse_compact_assignment(string_view input);
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,221 @@
+/**
+ * Copyright (c) 2021 Jason Kwok, Ben Ho, Ben Yip, Harry Lam, and Hins To.
+ *
+ * Licensed under the GNU Affero General Public License, Version 3.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of the License at
+ *
+ *     https://github.com/JasonHK-HKCC/SEHH2042-Group-Project/blob/master/LICENSE
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under the License
+ * is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ * or implied. See the License for the specific language governing permissions and limitations under
+ * the License.
+ **/
+
+#ifndef JETASSIGN_SEARCH_HPP
+#define JETASSIGN_SEARCH_HPP
+
+#include <map>
+#include <shared_mutex>
+#include <unordered_map>
+
+#include "jetassign/core.hpp"
+#include "jetassign/database.hpp"
+
+namespace jetassign
+{
+    /**
+     * The search component, which finds the assigned passengers by their names.
+     **/
+    namespace search
+    {
+        /**
+         * A passenger that matched a search.
+         **/
+        struct NameMatch
+        {
+            /**
+             * The flight of the passenger, empty for the console.
+             **/
+            core::FlightKey flight;
+
+            /**
+             * The location of the seat.
+             **/
+            core::SeatLocation location;
+
+            /**
+             * The matched passenger.
+             **/
+            core::Passenger passenger;
+
+            /**
+             * The edit distance between the name and the query, zero unless it was a fuzzy search.
+             **/
+            size_t distance;
+        };
+
+        /**
+         * Indexes the names of the passengers of the attached seating plans. The names were compared
+         * case-insensitively, with the spaces between the words collapsed.
+         *
+         * The names were kept in sorted order, so a prefix search was a range of the index, and a
+         * fuzzy search walks the index like a trie, sharing the edit distance rows between the
+         * names with a common prefix and skipping the names whose prefix was already too distant.
+         *
+         * The index could be queried and updated from multiple threads concurrently.
+         **/
+        class NameIndex : public core::SeatingPlanObserver
+        {
+            public:
+                /**
+                 * The default maximum number of matches of a search.
+                 **/
+                static constexpr size_t kDefaultLimit = 20;
+
+                NameIndex() = default;
+
+                NameIndex(const NameIndex&) = delete;
+
+                NameIndex& operator =(const NameIndex&) = delete;
+
+                /**
+                 * Indexes the passengers of a seating plan, and keeps track of its changes.
+                 *
+                 * @param plan The seating plan, which must be detached before destroyed.
+                 * @param key  The flight of the seating plan, empty for the console.
+                 **/
+                void attach(core::SeatingPlan &plan, const core::FlightKey &key = core::FlightKey());
+
+                /**
+                 * Removes the passengers of a seating plan from the index, and stops keeping track
+                 * of its changes.
+                 *
+                 * @param plan The seating plan.
+                 **/
+                void detach(core::SeatingPlan &plan);
+
+                /**
+                 * Returns the passengers with the given name.
+                 *
+                 * @param name  The name of the passengers.
+                 * @param limit The maximum number of matches.
+                 **/
+                std::vector<NameMatch> find(string_view name, size_t limit = kDefaultLimit) const;
+
+                /**
+                 * Returns the passengers whose names start with the given prefix, in order of their
+                 * names.
+                 *
+                 * @param prefix The prefix of the names.
+                 * @param limit  The maximum number of matches.
+                 **/
+                std::vector<NameMatch> find_prefix(string_view prefix, size_t limit = kDefaultLimit) const;
+
+                /**
+                 * Returns the passengers whose names were within the given edit distance of the name,
+                 * the closest first.
+                 *
+                 * @param name         The name, which may be misspelled.
+                 * @param max_distance The maximum number of inserted, deleted or replaced characters.
+                 * @param limit        The maximum number of matches.
+                 **/
+                std::vector<NameMatch> find_similar(string_view name, size_t max_distance = 2, size_t limit = kDefaultLimit) const;
+
+                /**
+                 * Returns the number of indexed passengers.
+                 **/
+                size_t size() const;
+
+                void on_assigned(const core::SeatingPlan &plan, const core::SeatLocation &location, const core::Passenger &passenger) override;
+
+                void on_removed(const core::SeatingPlan &plan, const core::SeatLocation &location, const core::Passenger &passenger) override;
+
+                /**
+                 * Returns the normalized form of a name, which was uppercased with the spaces
+                 * between the words collapsed.
+                 *
+                 * @param name The name.
+                 **/
+                static string normalize(string_view name);
+
+            private:
+                /**
+                 * An indexed passenger.
+                 **/
+                struct Entry
+                {
+                    const core::SeatingPlan *plan;
+
+                    core::SeatLocation location;
+
+                    core::Passenger passenger;
+                };
+
+                /**
+                 * The lock that guards the index.
+                 **/
+                mutable std::shared_mutex m_mutex;
+
+                /**
+                 * The indexed passengers, grouped by their normalized names.
+                 **/
+                std::map<string, std::vector<Entry>, std::less<>> m_names;
+
+                /**
+                 * The flights of the attached seating plans.
+                 **/
+                std::unordered_map<const core::SeatingPlan*, core::FlightKey> m_flights;
+
+                /**
+                 * The number of indexed passengers.
+                 **/
+                size_t m_size = 0;
+
+                /**
+                 * Adds a passenger to the index, while holding the lock exclusively.
+                 **/
+                void insert(const core::SeatingPlan &plan, const core::SeatLocation &location, const core::Passenger &passenger);
+
+                /**
+                 * Removes a passenger from the index, while holding the lock exclusively.
+                 **/
+                void erase(const core::SeatingPlan &plan, const core::SeatLocation &location, const core::Passenger &passenger);
+
+                /**
+                 * Appends the passengers of an entry of the index to the matches, while holding the
+                 * lock, until the limit was reached.
+                 **/
+                void collect(const std::vector<Entry> &entries, size_t distance, size_t limit, std::vector<NameMatch> &matches) const;
+        };
+
+        /**
+         * Returns the passengers of the flights of a database that were not loaded into the registry
+         * yet, whose names start with the given prefix, in order of their names. The name index only
+         * covers the loaded flights, thus the unloaded ones were found by a binary search of the name
+         * table of the database instead, which reads the flights of the returned passengers only.
+         *
+         * @param database The flight database.
+         * @param flights  The registry of the flights, whose loaded and closed flights were skipped.
+         * @param prefix   The prefix of the names.
+         * @param limit    The maximum number of matches.
+         **/
+        std::vector<NameMatch> find_prefix(const storage::FlightDatabase &database, const core::FlightRegistry &flights, string_view prefix, size_t limit = NameIndex::kDefaultLimit);
+
+        /**
+         * Returns the passengers of the flights of a database that were not loaded into the registry
+         * yet, whose names were within the given edit distance of the name, the closest first. The
+         * name table of the database was walked the same as the name index.
+         *
+         * @param database     The flight database.
+         * @param flights      The registry of the flights, whose loaded and closed flights were
+         *                     skipped.
+         * @param name         The name, which may be misspelled.
+         * @param max_distance The maximum number of inserted, deleted or replaced characters.
+         * @param limit        The maximum number of matches.
+         **/
+        std::vector<NameMatch> find_similar(const storage::FlightDatabase &database, const core::FlightRegistry &flights, string_view name, size_t max_distance = 2, size_t limit = NameIndex::kDefaultLimit);
+    }
+}
+
+#endif
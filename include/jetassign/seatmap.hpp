@@ -0,0 +1,171 @@
+/**
+ * Copyright (c) 2021 Jason Kwok, Ben Ho, Ben Yip, Harry Lam, and Hins To.
+ *
+ * Licensed under the GNU Affero General Public License, Version 3.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of the License at
+ *
+ *     https://github.com/JasonHK-HKCC/SEHH2042-Group-Project/blob/master/LICENSE
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under the License
+ * is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ * or implied. See the License for the specific language governing permissions and limitations under
+ * the License.
+ **/
+
+#ifndef JETASSIGN_SEATMAP_HPP
+#define JETASSIGN_SEATMAP_HPP
+
+#include <ostream>
+
+#include "jetassign/core.hpp"
+#include "jetassign/database.hpp"
+
+namespace jetassign
+{
+    /**
+     * The seat map component, which exports the seating plans for the other systems.
+     *
+     * JSON:   an array of the flights, each with the flight number, date, rows, column letters and
+     *         the seats, e.g. {"seat":"10D","class":"Economy","status":"occupied","name":...,
+     *         "passport_id":...}, where the status was "vacant", "occupied" or "blocked".
+     *
+     * CSV:    a header line, then one line for each seat, with the columns flight, date, seat,
+     *         class, status, name and passport_id.
+     *
+     * Binary: the magic "JASM", the version (u16) and a reserved u16, then for each flight the
+     *         flight number and date (u16 length + bytes), rows (u32), columns (u32), and the
+     *         occupied and blocked bitmaps in little-endian, each with ceil(columns / 8) bytes for
+     *         each row, where bit N represents the Nth column.
+     **/
+    namespace seatmap
+    {
+        /**
+         * The formats of the exported seating plans.
+         **/
+        enum class Format
+        {
+            /** A JSON document. */
+            kJson,
+            /** A CSV table. */
+            kCsv,
+            /** A compact binary occupancy dump. */
+            kBinary,
+        };
+
+        /**
+         * Parses the name of a format, i.e. "json", "csv" or "binary".
+         *
+         * @param name The name of the format.
+         **/
+        optional<Format> parse_format(string_view name);
+
+        /**
+         * Writes the seating plans to a stream as they were given, directly into the buffer of the
+         * stream, without building a string for each seat.
+         *
+         * The stream was set to bad if the output could not be written.
+         **/
+        class SeatMapWriter
+        {
+            public:
+                /**
+                 * Initialize a writer, and writes the beginning of the document.
+                 *
+                 * @param output The stream to write to, which must outlive the writer.
+                 * @param format The format of the document.
+                 **/
+                SeatMapWriter(std::ostream &output, Format format);
+
+                SeatMapWriter(const SeatMapWriter&) = delete;
+
+                SeatMapWriter& operator =(const SeatMapWriter&) = delete;
+
+                /**
+                 * Writes a seating plan.
+                 *
+                 * @param flight The flight of the seating plan, empty for the console.
+                 * @param plan   A snapshot of the seating plan.
+                 **/
+                void write(const core::FlightKey &flight, const core::SeatingPlan::Snapshot &plan);
+
+                /**
+                 * Writes a seating plan straight from a flight database, without restoring it.
+                 *
+                 * @param flight The flight of the seating plan, empty for the console.
+                 * @param plan   The mapped seating plan.
+                 * @param layout The cabin layout, which must match the rows and columns of the plan.
+                 **/
+                void write(const core::FlightKey &flight, const storage::MappedFlight &plan, const core::CabinLayout &layout);
+
+                /**
+                 * Writes the end of the document and flushes the stream.
+                 **/
+                void finish();
+
+                /**
+                 * Returns the number of seating plans that were written.
+                 **/
+                size_t size() const noexcept { return m_size; }
+
+            private:
+                /**
+                 * The stream to write to.
+                 **/
+                std::ostream &m_output;
+
+                /**
+                 * The buffer of the stream.
+                 **/
+                std::streambuf &m_buffer;
+
+                /**
+                 * The format of the document.
+                 **/
+                Format m_format;
+
+                /**
+                 * The number of seating plans that were written.
+                 **/
+                size_t m_size;
+
+                /**
+                 * Writes a seating plan, either a snapshot or a mapped one, in the format.
+                 **/
+                template<typename TPlan>
+                void write_plan(const core::FlightKey &flight, const core::CabinLayout &layout, const TPlan &plan);
+
+                /**
+                 * Writes a seating plan in each format.
+                 **/
+                template<typename TPlan>
+                void write_json(const core::FlightKey &flight, const core::CabinLayout &layout, const TPlan &plan);
+
+                template<typename TPlan>
+                void write_csv(const core::FlightKey &flight, const core::CabinLayout &layout, const TPlan &plan);
+
+                template<typename TPlan>
+                void write_binary(const core::FlightKey &flight, const core::CabinLayout &layout, const TPlan &plan);
+
+                /**
+                 * Writes the text, the numbers, and the escaped or encoded values into the buffer.
+                 **/
+                void put(char character);
+
+                void put(string_view text);
+
+                void put_number(std::uint64_t value);
+
+                void put_json_string(string_view value);
+
+                void put_csv_field(string_view value);
+
+                void put_u16(std::uint16_t value);
+
+                void put_u32(std::uint32_t value);
+
+                void put_binary_string(string_view value);
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,382 @@
+/**
+ * Copyright (c) 2021 Jason Kwok, Ben Ho, Ben Yip, Harry Lam, and Hins To.
+ *
+ * Licensed under the GNU Affero General Public License, Version 3.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of the License at
+ *
+ *     https://github.com/JasonHK-HKCC/SEHH2042-Group-Project/blob/master/LICENSE
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under the License
+ * is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ * or implied. See the License for the specific language governing permissions and limitations under
+ * the License.
+ **/
+
+#ifndef JETASSIGN_SERVER_HPP
+#define JETASSIGN_SERVER_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <iosfwd>
+#include <mutex>
+
+#include "jetassign/core.hpp"
+
+namespace jetassign
+{
+    /**
+     * The server component, which lets the check-in kiosks assign the seats over a socket, and the
+     * scripts assign them without the menus.
+     *
+     * Each request and response was a line of text:
+     *
+     *     ASSIGN <compact assignment>  ->  OK <seat>
+     *     REMOVE <seat>                ->  OK <passport ID>
+     *     LOOKUP <passport ID>         ->  OK <seat> <passenger name> | NOT_FOUND
+     *     MAP                          ->  OK <row> <row> ...  (one symbol for each seat, e.g. "X*#")
+     *     QUIT                         ->  BYE
+     *
+     * A request that could not be handled was answered with "ERROR <reason>".
+     **/
+    namespace server
+    {
+        /**
+         * Makes the changes of the calling thread durable, e.g. by waiting for the journal. A change
+         * was acknowledged only after it returned.
+         **/
+        using Committer = std::function<void()>;
+
+        /**
+         * Handles the requests of the protocol against a seating plan.
+         **/
+        class Dispatcher
+        {
+            public:
+                /**
+                 * Initialize a dispatcher for a seating plan.
+                 *
+                 * @param plan      The seating plan, which must outlive the dispatcher.
+                 * @param committer Makes the changes durable before they were acknowledged, if any.
+                 **/
+                explicit Dispatcher(core::SeatingPlan &plan, Committer committer = nullptr) : m_plan { plan }, m_committer { std::move(committer) } {}
+
+                /**
+                 * Handles a request and returns the response, without the line break. The requests
+                 * could be handled from multiple threads concurrently.
+                 *
+                 * @param request The request line.
+                 * @param reader  The reader of the seating plan, owned by the calling thread.
+                 **/
+                string handle(string_view request, core::SeatingPlan::Reader &reader);
+
+                /**
+                 * Returns the seating plan.
+                 **/
+                core::SeatingPlan& plan() { return m_plan; }
+
+            private:
+                /**
+                 * The seating plan.
+                 **/
+                core::SeatingPlan &m_plan;
+
+                /**
+                 * Makes the changes durable before they were acknowledged, if any.
+                 **/
+                Committer m_committer;
+
+                /**
+                 * Serializes the changes to the seating plan, the lookups read the snapshots instead.
+                 **/
+                std::mutex m_writer_mutex;
+        };
+
+        /**
+         * The outcome of a script.
+         **/
+        struct ScriptReport
+        {
+            /**
+             * The number of requests that were handled, including the lookups that found nothing.
+             **/
+            size_t succeeded = 0;
+
+            /**
+             * The number of requests that were answered with an error.
+             **/
+            size_t failed = 0;
+        };
+
+        /**
+         * Handles the requests of a script against a seating plan, one request per line, without
+         * any prompts or confirmations. The blank lines and the lines starting with "#" were
+         * skipped, and the script stops at "QUIT".
+         *
+         * Each response was written as a line of JSON, e.g.
+         *
+         *     {"line":1,"request":"ASSIGN Chan Tai Man/HK12345678A/10D","status":"OK","result":"10D"}
+         *     {"line":2,"request":"REMOVE 11A","status":"ERROR","reason":"The seat was not assigned."}
+         *
+         * @param input     The script.
+         * @param output    The stream to write the responses to.
+         * @param plan      The seating plan.
+         * @param committer Makes the changes durable before they were acknowledged, if any.
+         **/
+        ScriptReport run_script(std::istream &input, std::ostream &output, core::SeatingPlan &plan, Committer committer = nullptr);
+
+#ifdef __linux__
+        /**
+         * A server that accepts the connections with an epoll event loop, and handles the requests
+         * with a pool of worker threads.
+         **/
+        class Server
+        {
+            public:
+                /**
+                 * Initialize a server for a seating plan.
+                 *
+                 * @param plan         The seating plan, which must outlive the server.
+                 * @param worker_count The number of worker threads.
+                 * @param committer    Makes the changes durable before they were acknowledged, if any.
+                 **/
+                Server(core::SeatingPlan &plan, size_t worker_count, Committer committer = nullptr);
+
+                Server(const Server&) = delete;
+
+                Server& operator =(const Server&) = delete;
+
+                ~Server();
+
+                /**
+                 * Listens on a Unix domain socket, replacing the socket file if exists.
+                 *
+                 * @param path The path of the socket file.
+                 **/
+                void listen_unix(const string &path);
+
+                /**
+                 * Listens on a TCP port of the loopback interface. Returns the port listening on.
+                 *
+                 * @param port The port, or any free port if zero.
+                 **/
+                std::uint16_t listen_tcp(std::uint16_t port);
+
+                /**
+                 * Serves the connections until the server was stopped.
+                 **/
+                void run();
+
+                /**
+                 * Asks the server to stop, which could be called from any thread.
+                 **/
+                void stop();
+
+            private:
+                /**
+                 * A connection of a client.
+                 **/
+                struct Connection
+                {
+                    /**
+                     * Identifies the connection, since the file descriptors were reused.
+                     **/
+                    std::uint64_t id = 0;
+
+                    /**
+                     * The bytes received but not handled yet.
+                     **/
+                    string input;
+
+                    /**
+                     * The bytes of the responses not sent yet.
+                     **/
+                    string output;
+
+                    /**
+                     * Whether the requests of the connection were being handled by a worker.
+                     **/
+                    bool is_busy = false;
+
+                    /**
+                     * Whether the connection should be closed once the responses were sent.
+                     **/
+                    bool is_closing = false;
+                };
+
+                /**
+                 * A group of requests from a connection, handled by a worker in order.
+                 **/
+                struct Task
+                {
+                    /**
+                     * The file descriptor of the connection.
+                     **/
+                    int fd;
+
+                    /**
+                     * The identifier of the connection.
+                     **/
+                    std::uint64_t id;
+
+                    /**
+                     * The request lines, each ended with a line break.
+                     **/
+                    string requests;
+                };
+
+                /**
+                 * The responses of a task.
+                 **/
+                struct Completion
+                {
+                    /**
+                     * The file descriptor of the connection.
+                     **/
+                    int fd;
+
+                    /**
+                     * The identifier of the connection.
+                     **/
+                    std::uint64_t id;
+
+                    /**
+                     * The response lines, each ended with a line break.
+                     **/
+                    string responses;
+
+                    /**
+                     * Whether the client asked to close the connection.
+                     **/
+                    bool is_quitting;
+                };
+
+                /**
+                 * Registers a listening socket to the event loop.
+                 *
+                 * @param fd The file descriptor of the socket.
+                 **/
+                void add_listener(int fd);
+
+                /**
+                 * Accepts the pending connections of a listening socket.
+                 *
+                 * @param fd The file descriptor of the socket.
+                 **/
+                void accept_connections(int fd);
+
+                /**
+                 * Receives the requests of a connection.
+                 *
+                 * @param fd The file descriptor of the connection.
+                 **/
+                void receive(int fd);
+
+                /**
+                 * Hands the complete requests of a connection to the workers, if it was idle.
+                 *
+                 * @param fd The file descriptor of the connection.
+                 **/
+                void dispatch(int fd);
+
+                /**
+                 * Sends the pending responses of a connection, and closes it if it was finished.
+                 *
+                 * @param fd The file descriptor of the connection.
+                 **/
+                void flush(int fd);
+
+                /**
+                 * Closes a connection.
+                 *
+                 * @param fd The file descriptor of the connection.
+                 **/
+                void close_connection(int fd);
+
+                /**
+                 * Updates the events of a connection to wait for.
+                 *
+                 * @param fd The file descriptor of the connection.
+                 **/
+                void watch(int fd);
+
+                /**
+                 * Handles the tasks until the server was stopped.
+                 **/
+                void work();
+
+                /**
+                 * The handler of the requests.
+                 **/
+                Dispatcher m_dispatcher;
+
+                /**
+                 * The number of worker threads.
+                 **/
+                size_t m_worker_count;
+
+                /**
+                 * The epoll instance of the event loop.
+                 **/
+                int m_epoll;
+
+                /**
+                 * Wakes up the event loop when a task was completed, or the server was stopped.
+                 **/
+                int m_wakeup;
+
+                /**
+                 * The listening sockets.
+                 **/
+                std::vector<int> m_listeners;
+
+                /**
+                 * The path of the Unix domain socket, which was removed on destruction.
+                 **/
+                optional<string> m_socket_path;
+
+                /**
+                 * The open connections, by file descriptor.
+                 **/
+                std::unordered_map<int, Connection> m_connections;
+
+                /**
+                 * The identifier of the next connection.
+                 **/
+                std::uint64_t m_next_id;
+
+                /**
+                 * Whether the server was asked to stop.
+                 **/
+                std::atomic<bool> m_is_stopping;
+
+                /**
+                 * The lock that guards the queues below.
+                 **/
+                std::mutex m_mutex;
+
+                /**
+                 * Notified when a task was queued, or the server was stopping.
+                 **/
+                std::condition_variable m_has_task;
+
+                /**
+                 * The tasks waiting for a worker.
+                 **/
+                std::deque<Task> m_tasks;
+
+                /**
+                 * The completed tasks waiting for the event loop.
+                 **/
+                std::vector<Completion> m_completions;
+        };
+
+        /**
+         * The maximum length of a request line.
+         **/
+        constexpr size_t kMaxRequestLength = 4096;
+#endif
+    }
+}
+
+#endif
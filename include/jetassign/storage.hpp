@@ -0,0 +1,380 @@
+/**
+ * Copyright (c) 2021 Jason Kwok, Ben Ho, Ben Yip, Harry Lam, and Hins To.
+ *
+ * Licensed under the GNU Affero General Public License, Version 3.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of the License at
+ *
+ *     https://github.com/JasonHK-HKCC/SEHH2042-Group-Project/blob/master/LICENSE
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under the License
+ * is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ * or implied. See the License for the specific language governing permissions and limitations under
+ * the License.
+ **/
+
+#ifndef JETASSIGN_STORAGE_HPP
+#define JETASSIGN_STORAGE_HPP
+
+#include <condition_variable>
+#include <cstdio>
+#include <thread>
+
+#include "jetassign/core.hpp"
+
+namespace jetassign
+{
+    /**
+     * The storage component.
+     *
+     * A snapshot stores the seating plan of the console followed by the flights of the registry,
+     * in a compact little-endian binary format:
+     *
+     *     header:    magic "JASP", version (u16), reserved (u16), journal generation (u32),
+     *                number of flights (u32)
+     *     plan:      flight number (u16 length + bytes), date (u16 length + bytes),
+     *                rows (u32), columns (u32), number of passengers (u32), passengers...
+     *     passenger: seat index (u32), name (u16 length + bytes), passport ID (u16 length + bytes)
+     **/
+    namespace storage
+    {
+        class Journal;
+
+        /**
+         * The version of the snapshot format.
+         **/
+        constexpr std::uint16_t kSnapshotVersion = 2;
+
+        /**
+         * Serializes the seating plans into a snapshot.
+         *
+         * @param seating_plan The seating plan of the console.
+         * @param flights      The flights of the registry.
+         * @param generation   The generation of the journal that continues from the snapshot.
+         * @param journal      The journal that holds the later changes of each seating plan after it
+         *                     was serialized, during a compaction.
+         **/
+        string write_snapshot(const core::SeatingPlan &seating_plan, const core::FlightRegistry &flights, std::uint32_t generation = 0, Journal *journal = nullptr);
+
+        /**
+         * Deserializes the seating plans from a snapshot. The seating plans must be empty. Returns
+         * the generation of the journal that continues from the snapshot.
+         *
+         * @param snapshot     The snapshot.
+         * @param seating_plan The seating plan of the console.
+         * @param flights      The flights of the registry.
+         **/
+        std::uint32_t read_snapshot(string_view snapshot, core::SeatingPlan &seating_plan, core::FlightRegistry &flights);
+
+        /**
+         * Saves the seating plans into a snapshot file atomically, by writing a temporary file and
+         * then renaming it. Returns the size of the snapshot.
+         *
+         * @param path         The path of the snapshot file.
+         * @param seating_plan The seating plan of the console.
+         * @param flights      The flights of the registry.
+         * @param generation   The generation of the journal that continues from the snapshot.
+         * @param journal      The journal that holds the later changes of each seating plan after it
+         *                     was serialized, during a compaction.
+         **/
+        size_t save_snapshot(const string &path, const core::SeatingPlan &seating_plan, const core::FlightRegistry &flights, std::uint32_t generation = 0, Journal *journal = nullptr);
+
+        /**
+         * Loads the seating plans from a snapshot file. Returns the generation of the journal that
+         * continues from the snapshot, or nothing if the file does not exist.
+         *
+         * @param path         The path of the snapshot file.
+         * @param seating_plan The seating plan of the console.
+         * @param flights      The flights of the registry.
+         **/
+        optional<std::uint32_t> load_snapshot(const string &path, core::SeatingPlan &seating_plan, core::FlightRegistry &flights);
+
+        /**
+         * An append-only write-ahead journal of the assignments and removals of the attached seating
+         * plans. The records were buffered and written by a background thread, which synchronizes
+         * the file once for each group of records. A change must not be acknowledged until wait()
+         * returned for its ticket, and the callers waiting together were committed as a group.
+         *
+         * The journal file starts with the magic "JASJ", the version (u16) and the generation (u32),
+         * followed by the records. Each record was formatted as the length of the payload (u32), the
+         * payload and its FNV-1a checksum (u32). The payload contains the operation (u8), the flight
+         * number and date, the seat index (u32), and the name and passport ID of the passenger.
+         *
+         * The changes of a transaction were recorded as a single record, so they were replayed all
+         * at once or not at all. Its payload contains the operation (u8), the flight number and date,
+         * the number of changes (u32), and the operation, seat index, name and passport ID of each.
+         **/
+        class Journal : public core::SeatingPlanObserver
+        {
+            public:
+                /**
+                 * Opens a journal file for appending. The file will be recreated if it belongs to
+                 * another generation.
+                 *
+                 * @param path            The path of the journal file.
+                 * @param generation      The generation of the journal.
+                 * @param commit_interval The maximum delay before the records were synchronized.
+                 **/
+                Journal(const string &path, std::uint32_t generation, std::chrono::milliseconds commit_interval = std::chrono::milliseconds(5));
+
+                /**
+                 * Synchronizes the remaining records and closes the journal file.
+                 **/
+                ~Journal();
+
+                Journal(const Journal&) = delete;
+
+                Journal& operator =(const Journal&) = delete;
+
+                /**
+                 * Records the changes of a seating plan.
+                 *
+                 * @param plan The seating plan, which must be detached before destroyed.
+                 * @param key  The flight of the seating plan, empty for the console.
+                 **/
+                void attach(core::SeatingPlan &plan, const core::FlightKey &key = core::FlightKey());
+
+                /**
+                 * Stops recording the changes of a seating plan.
+                 *
+                 * @param plan The seating plan.
+                 **/
+                void detach(core::SeatingPlan &plan);
+
+                void on_assigned(const core::SeatingPlan &plan, const core::SeatLocation &location, const core::Passenger &passenger) override;
+
+                void on_removed(const core::SeatingPlan &plan, const core::SeatLocation &location, const core::Passenger &passenger) override;
+
+                void on_transaction_begun(const core::SeatingPlan &plan) override;
+
+                void on_transaction_ended(const core::SeatingPlan &plan, bool committed) override;
+
+                /**
+                 * Returns the ticket of the latest record appended by the calling thread, or 0 if
+                 * the thread has not appended any records.
+                 **/
+                size_t ticket() const;
+
+                /**
+                 * Waits until the record of a ticket, and all the records before it, were written
+                 * to the disk.
+                 *
+                 * @param ticket The ticket of the record.
+                 **/
+                void wait(size_t ticket);
+
+                /**
+                 * Waits until all the recorded changes were written to the disk.
+                 **/
+                void sync();
+
+                /**
+                 * Returns the generation of the journal.
+                 **/
+                std::uint32_t generation() const;
+
+                /**
+                 * Returns the number of records in the journal.
+                 **/
+                size_t size() const;
+
+                /**
+                 * Starts a compaction, the seating plans that were captured afterwards could not be
+                 * changed until reset() or cancel_compaction(). Returns the new generation.
+                 **/
+                std::uint32_t begin_compaction();
+
+                /**
+                 * Captures a seating plan after it was saved, while its flight was locked. Its later
+                 * changes were held until the compaction ended, so they were recorded into the new
+                 * generation instead of being discarded along with the saved ones.
+                 *
+                 * @param plan The seating plan.
+                 **/
+                void capture(const core::SeatingPlan &plan);
+
+                /**
+                 * Ends the compaction without starting a new generation, after the saving failed.
+                 **/
+                void cancel_compaction();
+
+                /**
+                 * Discards all the records and starts a new generation, after the seating plans were
+                 * saved into a snapshot. The changes that were held by the compaction, if any, were
+                 * recorded after it.
+                 *
+                 * @param generation The new generation.
+                 **/
+                void reset(std::uint32_t generation);
+
+            private:
+                /**
+                 * Appends a record to the pending records, and remembers its ticket for the calling
+                 * thread.
+                 *
+                 * @param operation The operation of the record.
+                 * @param plan      The seating plan that was changed.
+                 * @param location  The location of the seat.
+                 * @param passenger The passenger.
+                 **/
+                void append(std::uint8_t operation, const core::SeatingPlan &plan, const core::SeatLocation &location, const core::Passenger &passenger);
+
+                /**
+                 * Waits until a seating plan could be changed, if it was captured by the ongoing
+                 * compaction.
+                 *
+                 * @param lock The lock of the journal.
+                 * @param plan The seating plan.
+                 **/
+                void wait_for_capture(std::unique_lock<std::mutex> &lock, const core::SeatingPlan &plan);
+
+                /**
+                 * Starts a record in the pending records, the lock must be held. Returns the start of
+                 * the record.
+                 **/
+                size_t begin_record();
+
+                /**
+                 * Finishes the record that was started by begin_record(), the lock must be held.
+                 * Returns the ticket of the record.
+                 *
+                 * @param start The start of the record.
+                 **/
+                size_t end_record(size_t start);
+
+                /**
+                 * Writes the pending records until the journal was closed.
+                 **/
+                void run();
+
+                /**
+                 * The path of the journal file.
+                 **/
+                string m_path;
+
+                /**
+                 * The journal file.
+                 **/
+                std::FILE *m_file;
+
+                /**
+                 * The maximum delay before the records were synchronized.
+                 **/
+                std::chrono::milliseconds m_commit_interval;
+
+                /**
+                 * The lock that guards the states below.
+                 **/
+                mutable std::mutex m_mutex;
+
+                /**
+                 * Notified when records were appended, synchronized, or the journal was closing.
+                 **/
+                std::condition_variable m_condition;
+
+                /**
+                 * The flights of the attached seating plans.
+                 **/
+                std::unordered_map<const core::SeatingPlan*, core::FlightKey> m_flights;
+
+                /**
+                 * The changes of the ongoing transactions, and the number of them, by seating plan.
+                 **/
+                std::unordered_map<const core::SeatingPlan*, std::pair<string, std::uint32_t>> m_transactions;
+
+                /**
+                 * The attached seating plans that were not captured yet by the ongoing compaction.
+                 **/
+                std::unordered_set<const core::SeatingPlan*> m_uncaptured;
+
+                /**
+                 * Whether a compaction was ongoing.
+                 **/
+                bool m_compacting;
+
+                /**
+                 * The records that were not written yet.
+                 **/
+                string m_pending;
+
+                /**
+                 * The generation of the journal.
+                 **/
+                std::uint32_t m_generation;
+
+                /**
+                 * The number of records that were appended, which was also the ticket of the latest
+                 * record.
+                 **/
+                size_t m_appended;
+
+                /**
+                 * The number of records that were written to the disk.
+                 **/
+                size_t m_durable;
+
+                /**
+                 * The number of records that were discarded by reset().
+                 **/
+                size_t m_discarded;
+
+                /**
+                 * The number of threads that were waiting in sync().
+                 **/
+                size_t m_sync_waiters;
+
+                /**
+                 * Whether a writing was failed.
+                 **/
+                bool m_failed;
+
+                /**
+                 * Whether the journal was closing.
+                 **/
+                bool m_closing;
+
+                /**
+                 * The thread that writes the pending records.
+                 **/
+                std::thread m_writer;
+        };
+
+        /**
+         * Applies the records of a journal file to the seating plans, the incomplete records at the
+         * end of the file were ignored. Returns the number of records that were applied. Throws a
+         * StorageError if a complete record could not be applied.
+         *
+         * @param path         The path of the journal file.
+         * @param generation   The generation of the loaded snapshot, journals of other generations
+         *                     were ignored.
+         * @param seating_plan The seating plan of the console.
+         * @param flights      The flights of the registry.
+         **/
+        size_t replay_journal(const string &path, std::uint32_t generation, core::SeatingPlan &seating_plan, core::FlightRegistry &flights);
+
+        /**
+         * Saves the seating plans into a snapshot file and starts a new generation of the journal.
+         * The flights could be changed concurrently, their changes after being saved were held
+         * until the new generation started, but the console must not be.
+         *
+         * @param path         The path of the snapshot file.
+         * @param journal      The journal.
+         * @param seating_plan The seating plan of the console.
+         * @param flights      The flights of the registry.
+         **/
+        size_t compact(const string &path, Journal &journal, const core::SeatingPlan &seating_plan, const core::FlightRegistry &flights);
+
+        /**
+         * The number of records in the journal that triggers a compaction.
+         **/
+        constexpr size_t kJournalCompactionThreshold = 10000;
+
+        /**
+         * Flushes the file and asks the operating system to write it to the disk.
+         *
+         * @param file The file to synchronize.
+         **/
+        void sync_file(std::FILE *file);
+    }
+}
+
+#endif
@@ -0,0 +1,202 @@
+/**
+ * Copyright (c) 2021 Jason Kwok, Ben Ho, Ben Yip, Harry Lam, and Hins To.
+ *
+ * Licensed under the GNU Affero General Public License, Version 3.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of the License at
+ *
+ *     https://github.com/JasonHK-HKCC/SEHH2042-Group-Project/blob/master/LICENSE
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under the License
+ * is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ * or implied. See the License for the specific language governing permissions and limitations under
+ * the License.
+ **/
+
+#ifndef JETASSIGN_STRINGUTIL_HPP
+#define JETASSIGN_STRINGUTIL_HPP
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Utility functions for std::string.
+ **/
+namespace stringutil
+{
+    using std::optional;
+    using std::size_t;
+    using std::string;
+    using std::string_view;
+
+    using std::vector;
+
+    /**
+     * Removes the leading and trailing whitespaces of a string.
+     *
+     * @param input The string to be trimmed.
+     **/
+    string trim(const string &input);
+
+    /**
+     * Removes the leading whitespaces of a string.
+     *
+     * @param input The string to be trimmed.
+     **/
+    string trim_start(const string &input);
+
+    /**
+     * Removes the trailing whitespaces of a string.
+     *
+     * @param input The string to be trimmed.
+     **/
+    string trim_end(const string &input);
+
+    /**
+     * Returns the view of a string without the leading and trailing whitespaces.
+     *
+     * @param input The string to be trimmed.
+     **/
+    string_view trim_view(string_view input);
+
+    /**
+     * Returns the view of a string without the leading whitespaces.
+     *
+     * @param input The string to be trimmed.
+     **/
+    string_view trim_start_view(string_view input);
+
+    /**
+     * Returns the view of a string without the trailing whitespaces.
+     *
+     * @param input The string to be trimmed.
+     **/
+    string_view trim_end_view(string_view input);
+
+    /**
+     * Converts the string into uppercased.
+     *
+     * @param input The string to be converted.
+     **/
+    string to_uppercase(string_view input);
+
+    /**
+     * Converts the character into uppercased.
+     *
+     * @param input The character to be converted.
+     **/
+    char to_uppercase(char input);
+
+    /**
+     * Converts the string into uppercased, without the leading and trailing whitespaces and with
+     * the spaces between the words collapsed, for comparing the strings case-insensitively.
+     *
+     * @param input The string to be converted.
+     **/
+    string fold(string_view input);
+
+    /**
+     * Splits the string into multiple segments by the given separator.
+     *
+     * @param input     The string to be split.
+     * @param separator The separator to split the string.
+     **/
+    vector<string> split(const string &input, const string &separator);
+
+    /**
+     * Splits the string into multiple views of the segments by the given separator.
+     *
+     * @param input     The string to be split.
+     * @param separator The separator to split the string.
+     **/
+    vector<string_view> split_view(string_view input, string_view separator);
+
+    /**
+     * Splits the string into views of the segments lazily, one segment for each call to next().
+     **/
+    class Splitter
+    {
+        public:
+            /**
+             * Initialize a splitter.
+             *
+             * @param input     The string to be split, which must outlive the splitter.
+             * @param separator The separator to split the string.
+             **/
+            Splitter(string_view input, string_view separator);
+
+            /**
+             * Returns the next segment, or nothing if all the segments were returned.
+             **/
+            optional<string_view> next();
+
+        private:
+            /**
+             * The string to be split.
+             **/
+            string_view m_input;
+
+            /**
+             * The separator to split the string.
+             **/
+            string_view m_separator;
+
+            /**
+             * The starting position of the next segment.
+             **/
+            size_t m_position;
+
+            /**
+             * Whether all the segments were returned.
+             **/
+            bool m_finished;
+    };
+
+    /**
+     * Writes a string as a JSON string literal, with the quotes, the backslashes and the control
+     * characters escaped. The other characters, including the UTF-8 sequences, were written as is.
+     *
+     * @param value The string to be written.
+     * @param sink  The function that receives each piece of the literal as a string_view. The runs
+     *              of the characters that need no escaping were given at once.
+     **/
+    template<typename TSink>
+    void write_json_string(string_view value, TSink &&sink)
+    {
+        static constexpr char kHexDigits[] = "0123456789abcdef";
+
+        sink(string_view("\"", 1));
+
+        size_t start = 0;
+        for (size_t i = 0; i < value.size(); i++)
+        {
+            const auto character = static_cast<unsigned char>(value[i]);
+            if ((character >= 0x20) && (character != '"') && (character != '\\')) { continue; }
+
+            sink(value.substr(start, i - start));
+
+            switch (character)
+            {
+                case '"':  sink(string_view("\\\"", 2)); break;
+                case '\\': sink(string_view("\\\\", 2)); break;
+                case '\n': sink(string_view("\\n", 2)); break;
+                case '\r': sink(string_view("\\r", 2)); break;
+                case '\t': sink(string_view("\\t", 2)); break;
+
+                default:
+                {
+                    const char escaped[] = { '\\', 'u', '0', '0', kHexDigits[character >> 4], kHexDigits[character & 0xF] };
+                    sink(string_view(escaped, sizeof(escaped)));
+                }
+            }
+
+            start = i + 1;
+        }
+
+        sink(value.substr(start));
+        sink(string_view("\"", 1));
+    }
+}
+
+#endif
@@ -30,20 +30,54 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <functional>
 #include <iomanip>
 #include <iostream>
 #include <limits>
 #include <map>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
 #include <optional>
 #include <random>
-#include <regex>
 #include <set>
 #include <string>
+#include <string_view>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
 #include <climits>
+#include <condition_variable>
+#include <cstdint>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <signal.h>
+#endif
+
+#include "jetassign/console.hpp"
+#include "jetassign/core.hpp"
+#include "jetassign/database.hpp"
+#include "jetassign/exceptions.hpp"
+#include "jetassign/input.hpp"
+#include "jetassign/search.hpp"
+#include "jetassign/seatmap.hpp"
+#include "jetassign/server.hpp"
+#include "jetassign/storage.hpp"
+#include "jetassign/stringutil.hpp"
 
 using std::size_t;
 
@@ -53,7 +87,6 @@ using std::array;
 // iostream
 using std::cin;
 using std::cout;
-using std::endl;
 using std::flush;
 using std::istream;
 
@@ -63,9 +96,8 @@ using std::optional;
 // string
 using std::string;
 
-#define JET_ROW_LENGTH 13
-
-#define JET_COLUMN_LENGTH 6
+// string_view
+using std::string_view;
 
 #define STRINGIFY(expression) #expression
 
@@ -80,370 +112,12 @@ namespace numericutil
 }
 
 /**
- * Utility functions for std::string.
- **/
-namespace stringutil
-{
-    using std::vector;
-
-    /**
-     * Removes the leading and trailing whitespaces of a string.
-     *
-     * @param input The string to be trimmed.
-     **/
-    string trim(const string &input);
-
-    /**
-     * Removes the leading whitespaces of a string.
-     *
-     * @param input The string to be trimmed.
-     **/
-    string trim_start(const string &input);
-
-    /**
-     * Removes the trailing whitespaces of a string.
-     *
-     * @param input The string to be trimmed.
-     **/
-    string trim_end(const string &input);
-
-    /**
-     * Converts the string into uppercased.
-     *
-     * @param input The string to be converted.
-     **/
-    string to_uppercase(string input);
-
-    /**
-     * Splits the string into multiple segments by the given separator.
-     *
-     * @param input     The string to be split.
-     * @param separator The separator to split the string.
-     **/
-    vector<string> split(const string &input, const string &separator);
-}
-
-/**
- * The internals of JetAssign
+ * The console front-end of JetAssign
  **/
 namespace jetassign
 {
     /**
-     * The core component.
-     **/
-    namespace core
-    {
-        /**
-         * The class of a ticket.
-         **/
-        enum class TicketClass
-        {
-            /** First class. */
-            kFirst,
-            /** Business class. */
-            kBusiness,
-            /** Economy class. */
-            kEconomy,
-        };
-
-        /**
-         * Represents a passenger.
-         **/
-        class Passenger
-        {
-            public:
-                /**
-                 * Initialize a passenger with its information.
-                 *
-                 * @param name        The name of the passenger.
-                 * @param passport_id The passport ID of the passenger.
-                 **/
-                Passenger(const string &name, const string &passport_id);
-
-                /**
-                 * Returns the name of the passenger.
-                 **/
-                string name() const { return m_name; }
-
-                /**
-                 * Returns the passport ID of the passenger.
-                 **/
-                string passport_id() const { return m_passport_id; }
-
-                /**
-                 * Determine whether two instances represent the same passenger.
-                 *
-                 * @param other The other instance.
-                 **/
-                bool equals(const Passenger &other) const;
-
-                /**
-                 * Determine whether two instances represent the same passenger.
-                 *
-                 * @param other The other instance.
-                 **/
-                bool operator ==(const Passenger &other) const { return equals(other); }
-
-                /**
-                 * Determine whether two instances represent different passengers.
-                 *
-                 * @param other The other instance.
-                 **/
-                bool operator !=(const Passenger &other) const { return !equals(other); }
-
-            private:
-                /**
-                 * The name of the passenger.
-                 **/
-                string m_name;
-
-                /**
-                 * The passport ID of the passenger.
-                 **/
-                string m_passport_id;
-        };
-
-        /**
-         * Represents the location of a seat.
-         **/
-        class SeatLocation
-        {
-            public:
-                static string row_to_string(size_t row);
-
-                static string column_to_string(size_t column);
-
-                /**
-                 * Initialize a seat location with its position.
-                 *
-                 * @param row    The row location of the seat.
-                 * @param column The column location of the seat.
-                 **/
-                SeatLocation(size_t row, size_t column);
-
-                /**
-                 * Returns the row location of the seat.
-                 **/
-                size_t row() const { return m_row; }
-
-                /**
-                 * Returns the column location of the seat.
-                 **/
-                size_t column() const { return m_column; }
-
-                TicketClass ticket_class() const;
-
-                /**
-                 * Determine whether two instances represent the same seat location.
-                 *
-                 * @param other The other instance.
-                 **/
-                bool equals(const SeatLocation& other) const;
-
-                /**
-                 * Determine whether this instance less than the other.
-                 *
-                 * @param other The other instance.
-                 **/
-                bool less_than(const SeatLocation &other) const;
-
-                /**
-                 * Determine whether two instances represent the same seat location.
-                 *
-                 * @param other The other instance.
-                 **/
-                bool operator ==(const SeatLocation &other) const { return equals(other); }
-
-                /**
-                 * Determine whether two instances represent different seat location.
-                 *
-                 * @param other The other instance.
-                 **/
-                bool operator !=(const SeatLocation &other) const { return !equals(other); }
-
-                /**
-                 * Determine whether this instance less than the other.
-                 *
-                 * @param other The other instance.
-                 **/
-                bool operator <(const SeatLocation &other) const { return less_than(other); }
-
-                string to_string() const;
-
-                operator string() const { return to_string(); }
-
-                friend std::ostream& operator<<(std::ostream& os, const SeatLocation& location);
-
-            private:
-                /**
-                 * The row location of the seat.
-                 **/
-                size_t m_row;
-
-                /**
-                 * The column location of the seat.
-                 **/
-                size_t m_column;
-        };
-
-        class SeatingPlan
-        {
-            public:
-                typedef optional<Passenger> value_type;
-
-                typedef value_type& reference;
-
-                typedef const value_type& const_reference;
-
-                SeatingPlan();
-
-                /**
-                 * Determine whether the seat was already occupied by a passenger.
-                 *
-                 * @param location The location of the seat.
-                 **/
-                bool is_occupied(const SeatLocation &location) const noexcept;
-
-                /**
-                 * Determine whether the seat was already occupied by a passenger.
-                 *
-                 * @param row    The row of the seat.
-                 * @param column The column of the seat.
-                 **/
-                bool is_occupied(size_t row, size_t column) const noexcept;
-
-                /**
-                 * Determine whether the passenger was already assigned a seat.
-                 *
-                 * @param passport_id The passport ID of a passenger to check.
-                 **/
-                bool is_assigned(const string &passport_id) const noexcept;
-
-                /**
-                 * Determine whether the passenger was already assigned a seat.
-                 *
-                 * @param passenger The passenger to check.
-                 **/
-                bool is_assigned(const Passenger &passenger) const noexcept;
-
-                /**
-                 * Returns the passenger who was assigned to the given seat.
-                 *
-                 * @param location The location of the seat.
-                 **/
-                const const_reference at(const SeatLocation &location) const;
-
-                /**
-                 * Returns the passenger who was assigned to the given seat.
-                 *
-                 * @param row    The row of the seat.
-                 * @param column The column of the seat.
-                 **/
-                const const_reference at(size_t row, size_t column) const;
-
-                /**
-                 * Returns the seat location of a passenger.
-                 *
-                 * @param passport_id The passport ID of a passenger to check.
-                 **/
-                optional<SeatLocation> location_of(const string &passport_id) const;
-
-                /**
-                 * Returns the seat location of a passenger.
-                 *
-                 * @param passenger The passenger to check.
-                 **/
-                optional<SeatLocation> location_of(const Passenger &passenger) const;
-
-                /**
-                 * Assign a passenger to a specific seat.
-                 *
-                 * @param location  The location of the seat.
-                 * @param passenger The passenger to be assigned.
-                 **/
-                void assign(const SeatLocation &location, const_reference passenger);
-
-                /**
-                 * Remove a passenger at the specific seat from the seating plan.
-                 *
-                 * @param location The location of the seat.
-                 **/
-                void remove(const SeatLocation &location);
-
-                /**
-                 * Remove a specific passenger from the seating plan.
-                 *
-                 * @param passenger The passenger to remove.
-                 **/
-                void remove(const Passenger &passenger);
-
-            private:
-                /**
-                 * The internal seating plan.
-                 **/
-                array<array<optional<Passenger>, JET_COLUMN_LENGTH>, JET_ROW_LENGTH> seating_plan;
-        };
-
-        /**
-         * Converts the ticket class to a string.
-         *
-         * @param ticket_class The ticket class to convert.
-         **/
-        string to_string(TicketClass ticket_class) noexcept;
-    }
-
-    /**
-     * The exceptions component.
-     **/
-    namespace exceptions
-    {
-        using std::invalid_argument;
-        using std::runtime_error;
-
-        using core::SeatLocation;
-
-        /**
-         * An error that will throw when the requested seat was already occupied by another passenger.
-         **/
-        class SeatOccupiedError : public runtime_error
-        {
-            public:
-                SeatOccupiedError(const SeatLocation &location)
-                    : runtime_error("The requested seat was already occupied by another passenger."),
-                      location { location } {};
-
-                /**
-                 * Returns the location of the occupied seat.
-                 **/
-                const SeatLocation get_location() const { return location; }
-
-            private:
-                SeatLocation location;
-        };
-
-        class PassengerAssignedError : public runtime_error
-        {
-
-        };
-
-        class InvalidInputError : public invalid_argument
-        {
-            using invalid_argument::invalid_argument;
-        };
-
-        class EmptyInputError : public InvalidInputError
-        {
-            using InvalidInputError::InvalidInputError;
-        };
-
-        class MalformedInputError : public InvalidInputError
-        {
-            using InvalidInputError::InvalidInputError;
-        };
-    }
-
-    /**
-     * The input component.
+     * The interactive input component.
      **/
     namespace input
     {
@@ -451,74 +125,7 @@ namespace jetassign
 
         using core::Passenger;
         using core::SeatLocation;
-
-        /**
-         * Represents an assignmnet request.
-         **/
-        class AssignmentRequest
-        {
-            public:
-                /**
-                 * Initialize an assignmnet request with a passenger and seat location.
-                 **/
-                AssignmentRequest(const Passenger &passenger, const SeatLocation &location);
-
-                /**
-                 * Initialize an assignmnet request with a passenger name, passport ID and seat location.
-                 **/
-                AssignmentRequest(const string &passenger_name, const string &passport_id, const SeatLocation &seat_location);
-
-                /**
-                 * Returns the requesting passanger.
-                 **/
-                Passenger passenger() const { return m_passenger; }
-
-                /**
-                 * Returns the requested seat location.
-                 **/
-                SeatLocation location() const { return m_location; }
-
-                /**
-                 * Determine whether two instances represent the assignmnet request for the same passenger.
-                 *
-                 * @param other The other instance.
-                 **/
-                bool is_same_passenger(const AssignmentRequest &other) const;
-
-                /**
-                 * Determine whether two instances represent the same assignmnet request.
-                 *
-                 * @param other The other instance.
-                 **/
-                bool equals(const AssignmentRequest &other) const;
-
-                /**
-                 * Determine whether two instances represent the same assignmnet request.
-                 *
-                 * @param other The other instance.
-                 **/
-                bool operator ==(const AssignmentRequest &other) const { return equals(other); }
-
-                /**
-                 * Determine whether two instances represent different assignmnet request.
-                 *
-                 * @param other The other instance.
-                 **/
-                bool operator !=(const AssignmentRequest &other) const { return !equals(other); }
-
-                string to_string() const;
-
-            private:
-                /**
-                 * The requesting passanger.
-                 **/
-                Passenger m_passenger;
-
-                /**
-                 * The requested seat location.
-                 **/
-                SeatLocation m_location;
-        };
+        using core::TicketClass;
 
         /**
          * Prompt and wait for the user to press ENTER.
@@ -586,62 +193,6 @@ namespace jetassign
          * Get the list of assignmnet requests from the user.
          **/
         vector<AssignmentRequest> get_compact_assignments();
-
-        /**
-         * The input parsers component.
-         **/
-        namespace parsers
-        {
-            /**
-             * Parse the yes/no confirmation from the input.
-             *
-             * @param input The user's input.
-             **/
-            bool parse_confirmation(const string &input);
-
-            /**
-             * Parse the yes/no confirmation from the input.
-             *
-             * @param input         The user's input.
-             * @param default_value The default confirmation.
-             **/
-            bool parse_confirmation(const string &input, bool default_value);
-
-            /**
-             * Parse the menu selection from the input.
-             *
-             * @param input The user's input.
-             **/
-            long parse_menu_option(const string &input);
-
-            /**
-             * Parse the passenger name from the input.
-             *
-             * @param input The user's input.
-             **/
-            string parse_passenger_name(const string &input);
-
-            /**
-             * Parse the passport ID from the input.
-             *
-             * @param input The user's input.
-             **/
-            string parse_passport_id(const string &input);
-
-            /**
-             * Parse the seat location from the input.
-             *
-             * @param input The user's input.
-             **/
-            SeatLocation parse_seat_location(const string &input);
-
-            /**
-             * Parse the passenger name, passport ID, and seat location from the input.
-             *
-             * @param input The user's input.
-             **/
-            AssignmentRequest parse_compact_assignment(const string &input);
-        }
     }
 
     /**
@@ -724,6 +275,56 @@ namespace jetassign
         template<size_t TMenuSize>
         void print_menu(const Menu<TMenuSize>& menu);
 
+        /**
+         * Buffers the standard output and error streams while alive, so each screen was written
+         * at once when the input was read, instead of flushing after every line.
+         **/
+        class BufferedConsole
+        {
+            public:
+                /**
+                 * Installs the buffers into the standard output and error streams.
+                 *
+                 * @param report Whether to print the statistics of the buffers when uninstalled.
+                 **/
+                explicit BufferedConsole(bool report = false);
+
+                /**
+                 * Writes the remaining output and restores the standard output and error streams.
+                 **/
+                ~BufferedConsole();
+
+                BufferedConsole(const BufferedConsole&) = delete;
+
+                BufferedConsole& operator =(const BufferedConsole&) = delete;
+
+            private:
+                /**
+                 * Whether to print the statistics of the buffers when uninstalled.
+                 **/
+                bool m_report;
+
+                /**
+                 * The buffer of the standard output stream.
+                 **/
+                console::ConsoleBuffer m_output;
+
+                /**
+                 * The buffer of the standard error stream.
+                 **/
+                console::ConsoleBuffer m_error;
+
+                /**
+                 * The original buffers of the standard output and error streams.
+                 **/
+                std::streambuf *m_original_output, *m_original_error;
+        };
+
+        /**
+         * Writes the pending output before waiting for the input, the errors first.
+         **/
+        void flush_prompt();
+
         /**
          * Build a progress bar.
          *
@@ -754,54 +355,143 @@ namespace jetassign
      * The seating plan of the airplane.
      **/
     auto seating_plan = core::SeatingPlan();
+
+    /**
+     * The flights managed by the booking desk.
+     **/
+    core::FlightRegistry flights;
+
+    /**
+     * The names of the passengers of the seating plan and the flights.
+     **/
+    search::NameIndex name_index;
+
+    /**
+     * The path of the snapshot file, or the flight database if it was used.
+     **/
+    string snapshot_path = "JetAssign.snapshot";
+
+    /**
+     * The memory-mapped flight database, if the seating plans were saved as a database.
+     **/
+    std::unique_ptr<storage::FlightDatabase> database;
+
+    /**
+     * Whether the seating plans were saved as a memory-mapped flight database.
+     **/
+    bool use_database = false;
+
+    /**
+     * The journal of the changes since the snapshot was saved.
+     **/
+    std::unique_ptr<storage::Journal> journal;
 }
 
 /**
  * R0: Main menu
  **/
-long main_menu();
+long main_menu();
+
+/**
+ * R1: Add an assignment
+ **/
+void add_an_assignment();
+
+/**
+ * R2: Delete an assignment
+ **/
+void delete_an_assignment();
+
+/**
+ * R3: Add assignments in batch
+ **/
+void add_assignments_in_batch();
+
+/**
+ * R4: Show latest seating plan
+ **/
+void show_latest_seating_plan();
+
+/**
+ * R5: Show details
+ **/
+long show_details();
+
+/**
+ * R5.1: Show details > Passenger
+ **/
+void show_details_passenger();
+
+/**
+ * R5.1: Show details > Class
+ **/
+void show_details_class();
+
+/**
+ * R5.3: Show details > Passenger name
+ **/
+void show_details_name();
+
+/**
+ * R6: Occupancy summary
+ **/
+void show_occupancy_summary();
 
 /**
- * R1: Add an assignment
+ * R7: Exit, returns false if the operator decided to stay.
  **/
-void add_an_assignment();
+bool save_and_exit();
 
 /**
- * R2: Delete an assignment
+ * Imports the compact assignments from a file, without the menus. Returns non-zero if any lines
+ * were rejected, like a script with any failed requests.
+ *
+ * @param path The path of the file.
  **/
-void delete_an_assignment();
+int import_assignments(const string &path);
 
 /**
- * R3: Add assignments in batch
+ * Runs the requests of a script against the seating plan, without the menus.
+ *
+ * @param path The path of the script, or "-" for the standard input.
  **/
-void add_assignments_in_batch();
+int run_script(const string &path);
 
 /**
- * R4: Show latest seating plan
+ * Exports the seating plan and the flights to the standard output, without the menus.
+ *
+ * @param format The format of the export.
  **/
-void show_latest_seating_plan();
+int export_seat_maps(jetassign::seatmap::Format format);
 
 /**
- * R5: Show details
+ * Waits until the changes of the calling thread were written to the journal. Throws a
+ * StorageError if the journal could not be written.
  **/
-long show_details();
+void wait_for_journal();
 
 /**
- * R5.1: Show details > Passenger
+ * Waits until the changes of the menus were written to the journal, before they were reported
+ * as done. Returns false, after printing the error, if the journal could not be written.
  **/
-void show_details_passenger();
+bool commit_changes();
 
 /**
- * R5.1: Show details > Class
+ * Saves the seating plan and the flights, then truncates the journal. Returns the size of
+ * the saved file.
  **/
-void show_details_class();
+size_t compact_seating_plans();
 
+#ifdef __linux__
 /**
- * R6: Exit
+ * Serves the seating plan over the sockets until SIGINT or SIGTERM, without the menus.
+ *
+ * @param addresses    The paths of the Unix domain sockets, or the TCP ports to listen on.
+ * @param worker_count The number of worker threads.
  **/
-void save_and_exit();
+int serve(const std::vector<string> &addresses, size_t worker_count);
+#endif
 
-#ifndef _TEST
 int main(int argc, const char* argv[])
 {
     /** The welcome message. */
@@ -819,6 +509,189 @@ int main(int argc, const char* argv[])
         R"( /_/   \_\___/___/_|\__, |_| |_|_| |_| |_|\___|_| |_|\__|    VERSION 1.0.0     )" "\n"
         R"(                    |___/                                                      )" "\n";
 
+    /** The path of the cabin layout file, if any. */
+    optional<string> layout_path;
+    /** The path of the compact assignments file to import, if any. */
+    optional<string> import_path;
+    /** The path of the script to run, if any. */
+    optional<string> script_path;
+    /** The format to export the seating plans in, if any. */
+    optional<jetassign::seatmap::Format> export_format;
+    /** The sockets to serve the seating plan on, if any. */
+    std::vector<string> listen_addresses;
+    /** The number of worker threads of the server. */
+    size_t worker_count = std::max(1u, std::thread::hardware_concurrency());
+    /** Whether to print the statistics of the console output when leaving. */
+    bool print_console_statistics = false;
+
+    // Parses the command-line options.
+    for (auto i = 1; i < argc; i++)
+    {
+        const string option = argv[i];
+
+        if ((option == "--layout") && ((i + 1) < argc))
+        {
+            layout_path = argv[++i];
+        }
+        else if ((option == "--import") && ((i + 1) < argc))
+        {
+            import_path = argv[++i];
+        }
+        else if ((option == "--script") && ((i + 1) < argc))
+        {
+            script_path = argv[++i];
+        }
+        else if ((option == "--export") && ((i + 1) < argc) && jetassign::seatmap::parse_format(argv[i + 1]))
+        {
+            export_format = jetassign::seatmap::parse_format(argv[++i]);
+        }
+        else if ((option == "--data") && ((i + 1) < argc))
+        {
+            jetassign::snapshot_path = argv[++i];
+            jetassign::use_database = false;
+        }
+        else if ((option == "--database") && ((i + 1) < argc))
+        {
+            jetassign::snapshot_path = argv[++i];
+            jetassign::use_database = true;
+        }
+        else if (option == "--console-stats")
+        {
+            print_console_statistics = true;
+        }
+#ifdef __linux__
+        else if ((option == "--listen") && ((i + 1) < argc))
+        {
+            listen_addresses.push_back(argv[++i]);
+        }
+        else if ((option == "--workers") && ((i + 1) < argc) && (std::atoi(argv[i + 1]) > 0))
+        {
+            worker_count = std::atoi(argv[++i]);
+        }
+#endif
+        else
+        {
+            std::cerr << "Usage: " << argv[0] << " [--layout <cabin layout file>] [--data <snapshot file>] [--database <flight database file>] [--import <compact assignments file>] [--script <script file or ->] [--export <json|csv|binary>] [--console-stats]"
+#ifdef __linux__
+                      << " [--listen <socket path or TCP port>]... [--workers <count>]"
+#endif
+                      << '\n';
+            return 1;
+        }
+    }
+
+#ifdef __linux__
+    if (!listen_addresses.empty())
+    {
+        // Blocks the signals before starting any threads, so the server could wait for them.
+        sigset_t signals;
+        sigemptyset(&signals);
+        sigaddset(&signals, SIGINT);
+        sigaddset(&signals, SIGTERM);
+        pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+    }
+#endif
+
+    // Builds each screen in memory, and writes it at once before waiting for the input.
+    const auto console = jetassign::output::BufferedConsole(print_console_statistics);
+
+    if (layout_path)
+    {
+        // Loads the cabin layout and recreates the seating plan with it.
+        try
+        {
+            jetassign::core::CabinLayout::activate(jetassign::core::CabinLayout::load(*layout_path));
+            jetassign::seating_plan = jetassign::core::SeatingPlan();
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "Error: " << e.what() << '\n';
+            return 1;
+        }
+    }
+
+    // Restores the seating plans that were saved previously, if any.
+    try
+    {
+        using jetassign::database;
+        using jetassign::flights;
+        using jetassign::journal;
+        using jetassign::seating_plan;
+        using jetassign::snapshot_path;
+
+        // Replays the changes since the snapshot, then records the upcoming changes after them.
+        const auto journal_path = snapshot_path + ".journal";
+        const auto generation = (jetassign::use_database
+            ? jetassign::storage::load_database(snapshot_path, seating_plan, flights, database)
+            : jetassign::storage::load_snapshot(snapshot_path, seating_plan, flights)).value_or(0);
+        jetassign::storage::replay_journal(journal_path, generation, seating_plan, flights);
+
+        journal = std::make_unique<jetassign::storage::Journal>(journal_path, generation);
+        journal->attach(seating_plan);
+        jetassign::name_index.attach(seating_plan);
+        for (const auto &flight : flights.flights())
+        {
+            flight->modify([&](jetassign::core::SeatingPlan &plan)
+            {
+                journal->attach(plan, flight->key());
+                jetassign::name_index.attach(plan, flight->key());
+            });
+        }
+
+        if (jetassign::use_database)
+        {
+            // Records the changes of the flights that were loaded from the database later.
+            flights.set_loader([&](const jetassign::core::FlightKey &key, jetassign::core::SeatingPlan &plan)
+            {
+                const auto mapped = database ? database->find(key) : std::nullopt;
+                if (!mapped || key.flight_number.empty()) { return false; }
+
+                mapped->restore(plan);
+                journal->attach(plan, key);
+                jetassign::name_index.attach(plan, key);
+                return true;
+            });
+        }
+
+        // Stops recording and searching the flights that were closed.
+        flights.set_unloader([&](const jetassign::core::FlightKey&, jetassign::core::SeatingPlan &plan)
+        {
+            journal->detach(plan);
+            jetassign::name_index.detach(plan);
+        });
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: Unable to load " << jetassign::snapshot_path << ": " << e.what() << '\n';
+        return 1;
+    }
+
+    if (import_path)
+    {
+        // Imports the assignments without entering the menus.
+        return import_assignments(*import_path);
+    }
+
+    if (script_path)
+    {
+        // Runs the script without entering the menus.
+        return run_script(*script_path);
+    }
+
+    if (export_format)
+    {
+        // Exports the seating plans without entering the menus.
+        return export_seat_maps(*export_format);
+    }
+
+#ifdef __linux__
+    if (!listen_addresses.empty())
+    {
+        // Serves the kiosks without entering the menus.
+        return serve(listen_addresses, worker_count);
+    }
+#endif
+
     // Prints the welcome message.
     cout << welcome_message;
 
@@ -826,6 +699,19 @@ int main(int argc, const char* argv[])
     long selection;
     do
     {
+        if (jetassign::journal->size() >= jetassign::storage::kJournalCompactionThreshold)
+        {
+            // Keeps the journal short, so it could be replayed quickly.
+            try
+            {
+                compact_seating_plans();
+            }
+            catch (const jetassign::exceptions::StorageError &e)
+            {
+                std::cerr << "Error: Unable to compact the journal: " << e.what() << '\n';
+            }
+        }
+
         switch ((selection = main_menu()))
         {
             case 1:
@@ -861,23 +747,30 @@ int main(int argc, const char* argv[])
                             break;
 
                         case 3:
+                            show_details_name();
+                            break;
+
+                        case 4:
                             break;
                     }
                 }
-                while (details_selection != 3);
+                while (details_selection != 4);
 
                 break;
             }
             case 6:
-                save_and_exit();
+                show_occupancy_summary();
+                break;
+
+            case 7:
+                if (!save_and_exit()) { selection = 0; }
                 break;
         }
     }
-    while (selection != 6);
+    while (selection != 7);
 
     return 0;
 }
-#endif
 
 long main_menu()
 {
@@ -888,7 +781,7 @@ long main_menu()
     cout << SECTION_SEPARATOR;
 
     /** The main menu. */
-    static const Menu<6> menu =
+    static const Menu<7> menu =
     {
         "Main Menu",
         {{
@@ -897,6 +790,7 @@ long main_menu()
             "Add assignments in batch",
             "Show latest seating plan",
             "Show details",
+            "Occupancy summary",
             "Exit",
         }},
     };
@@ -920,6 +814,18 @@ void add_an_assignment()
         cout << SECTION_SEPARATOR;
 
         auto passenger = get_passenger();
+        if (!seating_plan.is_assigned(passenger) && seating_plan.is_assigned(passenger.passport_id()))
+        {
+            // Cancel if the passport ID was taken by another passenger.
+
+            cout << '\n'
+                 << "Another passenger with the same passport ID was already assigned to a seat.\n"
+                 << "Canceled, the seating plan was not updated.\n"
+                 << '\n';
+
+            continue;
+        }
+
         if (seating_plan.is_assigned(passenger))
         {
             // Things to do if the passenger was already assigned.
@@ -971,6 +877,7 @@ void add_an_assignment()
 
         // Assign the passenger to the requested seat.
         seating_plan.assign(location, passenger);
+        if (!commit_changes()) { continue; }
 
         cout << "Done, the seating plan was updated.\n"
              << '\n';
@@ -998,6 +905,7 @@ void delete_an_assignment()
             if (get_confirmation("\nAre you sure to remove the passenger from the seating plan?", false))
             {
                 seating_plan.remove(*location);
+                if (!commit_changes()) { continue; }
 
                 cout << "Done, the passenger was removed from the seating plan.\n"
                      << '\n';
@@ -1019,11 +927,13 @@ void add_assignments_in_batch()
     using std::vector;
 
     using jetassign::seating_plan;
+    using jetassign::core::SeatAllocator;
     using jetassign::core::SeatLocation;
 
     using jetassign::input::AssignmentRequest;
     using jetassign::input::get_confirmation;
     using jetassign::input::get_compact_assignments;
+    using jetassign::input::validate_assignments;
 
     namespace messages = jetassign::output::messages;
 
@@ -1032,6 +942,7 @@ void add_assignments_in_batch()
         cout << SECTION_SEPARATOR
              << "Assign multiple passengers to the seating plan at once.\n"
              << R"(The assignment entry should be formatted as "<Name>/<Passport ID>/<Seat Location>", for example "Chan Tai Man/HK12345678A/10D".)" "\n"
+             << R"(Replace the seat location with a ticket class (e.g. "Economy") or "*" to allocate a seat automatically, and append "/<Party>" to seat a party together.)" "\n"
              << "Note that previous requests for the same passenger will be replaced by the new one.\n"
              << '\n';
 
@@ -1049,104 +960,110 @@ void add_assignments_in_batch()
 
         typedef vector<AssignmentRequest> RequestsVector;
 
-        /** The occupation state when the valid requests were committed. */
-        map<SeatLocation, bool> occupation_state;
-
-        /** The list of valid requests. */
-        RequestsVector valid_requests;
+        /** The batches larger than this were validated on all cores. */
+        static const size_t kParallelValidationThreshold = 4096;
 
-        /** The list of invalid requests, which is because the passenger was assigned a seat. */
-        RequestsVector invalid_requests_assigned;
-        /** The list of invalid requests, which is because the seat was occupied. */
-        RequestsVector invalid_requests_occupied;
+        auto newline_before_reassignment_confirmation = true;
 
         /**
-         * Determine whether the seat was occupied.
+         * Asks whether an assigned passenger should be moved to the requested seat.
          *
-         * @param location The location of the seat.
+         * @param request           The request.
+         * @param assigned_location The assigned seat of the passenger.
          **/
-        const auto is_occupied = [&](const SeatLocation& location)
-        {
-            return occupation_state.count(location)
-                ? occupation_state[location]
-                : seating_plan.is_occupied(location);
-        };
-
-        auto newline_before_reassignment_confirmation = true;
-        for (auto request : requests)
+        const auto confirm_reassignment = [&](const AssignmentRequest &request, const SeatLocation &assigned_location)
         {
-            /** The requesting passenger. */
-            auto passenger = request.passenger();
-            /** The location of the requested seat. */
-            auto location = request.location();
-
-            if (seating_plan.is_assigned(request.passenger()))
+            if (newline_before_reassignment_confirmation)
             {
-                // Things to do if the passenger was already assigned.
+                // Add a newline character before the first confirmation.
 
-                /** The assigned seat of the passenger in the seating plan. */
-                auto assigned_location = *(seating_plan.location_of(passenger));
-                // Marks the assigned seat as occupied.
-                occupation_state[assigned_location] = true;
+                cout << '\n';
+                newline_before_reassignment_confirmation = false;
+            }
 
-                if (newline_before_reassignment_confirmation)
-                {
-                    // Add a newline character before the first confirmation.
+            return get_confirmation(messages::confirm_reassignment_for_assigned_passenger(request.passenger(), assigned_location, *request.location()), true);
+        };
 
-                    cout << '\n';
-                    newline_before_reassignment_confirmation = false;
-                }
+        const auto thread_count = (requests.size() > kParallelValidationThreshold)
+            ? std::max<size_t>(1, std::thread::hardware_concurrency())
+            : 1;
 
-                if (!get_confirmation(messages::confirm_reassignment_for_assigned_passenger(passenger, assigned_location, location), true))
-                {
-                    // Invalid request if the operator not intended to reassign the seat.
+        auto validation = validate_assignments(seating_plan, requests, confirm_reassignment, thread_count);
 
-                    invalid_requests_assigned.push_back(request);
-                }
-                else if (is_occupied(location))
-                {
-                    // Invalid request if the requested seat was occupied.
+        /** The list of valid requests. */
+        RequestsVector &valid_requests = validation.valid;
+        /** The list of requests without a seat or with an occupied seat, which will be allocated a seat automatically. */
+        const RequestsVector &unseated_requests = validation.unseated;
+        /** The list of requests that were allocated a seat automatically. */
+        RequestsVector allocated_requests;
 
-                    // Marks the requested seat as occupied.
-                    occupation_state[location] = true;
-                    invalid_requests_occupied.push_back(request);
-                }
-                else
-                {
-                    // Otherwise, valid request.
+        /** The list of invalid requests, which is because the passenger was assigned a seat. */
+        const RequestsVector &invalid_requests_assigned = validation.assigned;
+        /** The list of invalid requests, which is because no seats were available. */
+        RequestsVector invalid_requests_unavailable;
 
-                    // Marks the assigned seat as free.
-                    occupation_state[assigned_location] = false;
-                    // Marks the requested seat as occupied.
-                    occupation_state[location] = true;
+        if (!unseated_requests.empty())
+        {
+            // Allocates the seats for the unseated requests, after the seats of the valid requests.
 
-                    valid_requests.push_back(request);
-                }
+            auto allocator = SeatAllocator(seating_plan);
+            for (const auto &[location, is_location_occupied] : validation.occupation)
+            {
+                if (is_location_occupied) { allocator.reserve(location); }
+                else { allocator.release(location); }
+            }
+
+            /** The seat of a member of each party, which the other members will be seated next to. */
+            map<string, SeatLocation> party_seats;
+            for (const auto &request : valid_requests)
+            {
+                if (!request.party().empty()) { party_seats.emplace(request.party(), *request.location()); }
             }
-            else if (is_occupied(location))
+
+            /** The unseated requests grouped by party, in the order of their first appearance. */
+            vector<RequestsVector> groups;
+            /** The group of each party. */
+            map<string, size_t> party_groups;
+            for (const auto &request : unseated_requests)
             {
-                // Invalid request if the requested seat was occupied.
+                if (request.party().empty())
+                {
+                    groups.push_back({ request });
+                    continue;
+                }
 
-                // Marks the requested seat as occupied.
-                occupation_state[location] = true;
-                invalid_requests_occupied.push_back(request);
+                const auto [entry, inserted] = party_groups.emplace(request.party(), groups.size());
+                if (inserted) { groups.emplace_back(); }
+                groups[entry->second].push_back(request);
             }
-            else
+
+            for (const auto &group : groups)
             {
-                // Otherwise, valid request.
+                const auto &first = group.front();
+
+                auto preferred = first.location();
+                if (!preferred && party_seats.count(first.party())) { preferred = party_seats.at(first.party()); }
+
+                const auto seats = allocator.allocate_party(group.size(), first.ticket_class(), preferred);
+                if (!seats)
+                {
+                    invalid_requests_unavailable.insert(invalid_requests_unavailable.end(), group.begin(), group.end());
+                    continue;
+                }
 
-                // Marks the requested seat as occupied.
-                occupation_state[location] = true;
-                valid_requests.push_back(request);
+                for (size_t i = 0; i < group.size(); i++)
+                {
+                    allocated_requests.push_back(group[i].with_location((*seats)[i]));
+                }
             }
         }
 
         /** The number of valid requests. */
-        const auto valid_count = valid_requests.size();
+        const auto valid_count = valid_requests.size() + allocated_requests.size();
         /** The number of invalid requests, which is because the passenger was assigned a seat. */
         const auto invalid_assigned_count = invalid_requests_assigned.size();
-        /** The number of invalid requests, which is because the seat was occupied. */
-        const auto invalid_occupied_count = invalid_requests_occupied.size();
+        /** The number of invalid requests, which is because no seats were available. */
+        const auto invalid_unavailable_count = invalid_requests_unavailable.size();
 
         /**
          * Prints the list of requests in point form.
@@ -1169,10 +1086,16 @@ void add_assignments_in_batch()
                  << "These requests will be committed:\n";
 
             print_requests_list(valid_requests);
+
+            if (!allocated_requests.empty())
+            {
+                cout << "- Allocated automatically:\n";
+                print_requests_list(allocated_requests, 1);
+            }
         }
 
         // List the invalid requests, if any.
-        if ((invalid_assigned_count > 0) || (invalid_occupied_count > 0))
+        if ((invalid_assigned_count > 0) || (invalid_unavailable_count > 0))
         {
             cout << '\n'
                  << "These requests will be dropped:\n";
@@ -1183,10 +1106,10 @@ void add_assignments_in_batch()
                 print_requests_list(invalid_requests_assigned, 1);
             }
 
-            if (invalid_occupied_count > 0)
+            if (invalid_unavailable_count > 0)
             {
-                cout << "- Seat was occupied:\n";
-                print_requests_list(invalid_requests_occupied, 1);
+                cout << "- No seats were available:\n";
+                print_requests_list(invalid_requests_unavailable, 1);
             }
         }
 
@@ -1203,20 +1126,31 @@ void add_assignments_in_batch()
         {
             // Commit the valid requests if confirmed.
 
-            for (auto request : valid_requests)
+            valid_requests.insert(valid_requests.end(), allocated_requests.begin(), allocated_requests.end());
+
+            // Commits the requests all at once, or none of them.
+            auto transaction = seating_plan.begin();
+            for (const auto &request : valid_requests)
             {
-                if (seating_plan.is_assigned(request.passenger()))
-                {
-                    // Removes the passenger from the current seat if the passenger was already assigned.
-                    seating_plan.remove(request.passenger());
-                }
+                // Moves the passenger from the current seat if the passenger was already assigned.
+                transaction.move(request.passenger(), *request.location());
+            }
 
-                // Assign the passenger to the requested seat.
-                seating_plan.assign(request.location(), request.passenger());
+            try
+            {
+                transaction.commit();
+                wait_for_journal();
+
+                cout << messages::report_committed_requests(valid_count) << '\n'
+                     << '\n';
             }
+            catch (const std::exception &e)
+            {
+                std::cerr << "    Error: " << e.what() << '\n';
 
-            cout << messages::report_committed_requests(valid_count) << '\n'
-                 << '\n';
+                cout << "No requests were committed.\n"
+                     << '\n';
+            }
         }
         else
         {
@@ -1242,33 +1176,50 @@ void show_latest_seating_plan()
 
     static const auto kColumnWidth = 3;
     static const auto kFirstColumnWidth = 3;
+    static const auto kAisleWidth = 2;
 
     static const auto kLegendSymbolWidth = 3;
     static const auto kLegendSymbolNameWidth = 13;
 
     static const auto kEmptySymbol = '*';
     static const auto kOccupiedSymbol = 'X';
+    static const auto kBlockedSymbol = '#';
+
+    /** A consistent view of the seating plan, as of now. */
+    const auto snapshot = seating_plan.snapshot();
+
+    /** The cabin layout of the seating plan. */
+    const auto &layout = snapshot->layout();
 
     cout << right;
 
     // Prints the header row.
     cout << setw(kFirstColumnWidth) << ' ';
-    for (auto column = 0; column < JET_COLUMN_LENGTH; column++)
+    for (size_t column = 0; column < layout.columns(); column++)
     {
-        cout << setw(kColumnWidth) << ((char) ('A' + column));
+        cout << setw(kColumnWidth) << layout.column_letter(column);
+        if (layout.has_aisle_after(column)) { cout << string(kAisleWidth, ' '); }
     }
     cout << '\n';
 
     // Prints each row of the seating plan.
-    for (auto row = 0; row < JET_ROW_LENGTH; row++)
+    for (size_t row = 0; row < layout.rows(); row++)
     {
         // Prints the row number.
         cout << setw(kFirstColumnWidth) << (row + 1);
 
+        const auto blocked = layout.blocked_bits(row);
+        const auto occupied = snapshot->occupied_bits(row);
+
         // Prints the occupation state of each column for the row.
-        for (auto column = 0; column < JET_COLUMN_LENGTH; column++)
+        for (size_t column = 0; column < layout.columns(); column++)
         {
-            cout << setw(kColumnWidth) << (seating_plan.is_occupied(row, column) ? kOccupiedSymbol : kEmptySymbol);
+            const auto symbol = ((blocked >> column) & 1)
+                ? kBlockedSymbol
+                : (((occupied >> column) & 1) ? kOccupiedSymbol : kEmptySymbol);
+
+            cout << setw(kColumnWidth) << symbol;
+            if (layout.has_aisle_after(column)) { cout << string(kAisleWidth, ' '); }
         }
 
         cout << '\n';
@@ -1279,8 +1230,14 @@ void show_latest_seating_plan()
     cout << left
          << "Legend:\n"
          << setw(kLegendSymbolWidth) << kEmptySymbol    << setw(kLegendSymbolNameWidth) << "Empty"
-         << setw(kLegendSymbolWidth) << kOccupiedSymbol << setw(kLegendSymbolNameWidth) << "Occupied"
-         << '\n'
+         << setw(kLegendSymbolWidth) << kOccupiedSymbol << setw(kLegendSymbolNameWidth) << "Occupied";
+
+    if (layout.has_blocked_seats())
+    {
+        cout << setw(kLegendSymbolWidth) << kBlockedSymbol << setw(kLegendSymbolNameWidth) << "Blocked";
+    }
+
+    cout << '\n'
          << '\n';
 
     wait_for_enter("Press ENTER to return to the main menu...");
@@ -1295,12 +1252,13 @@ long show_details()
     cout << SECTION_SEPARATOR;
 
     /** The "show details" menu. */
-    static const Menu<3> menu =
+    static const Menu<4> menu =
     {
         "Details",
         {{
             "Passenger",
             "Class",
+            "Passenger Name",
             "Back",
         }},
     };
@@ -1325,14 +1283,17 @@ void show_details_passenger()
         const auto passport_id = get_passport_id();
         cout << '\n';
 
-        if (seating_plan.is_assigned(passport_id))
+        /** A consistent view of the seating plan, as of now. */
+        const auto snapshot = seating_plan.snapshot();
+
+        if (const auto assigned_location = snapshot->location_of(passport_id))
         {
             // Prints the ticket information of the passenger with a matching passport ID, if exists.
 
-            const auto location = *(seating_plan.location_of(passport_id));
+            const auto location = *assigned_location;
 
             cout << "A matching passenger was found!\n"
-                 << "Passenger Name: " << seating_plan.at(location)->name() << '\n'
+                 << "Passenger Name: " << snapshot->at(location)->name() << '\n'
                  << "Passport    ID: " << passport_id << '\n'
                  << "Seat  Location: " << location << " (" << to_string(location.ticket_class()) << " Class)\n"
                  << '\n';
@@ -1355,6 +1316,7 @@ void show_details_class()
 
     using jetassign::seating_plan;
     using jetassign::core::SeatLocation;
+    using jetassign::core::TicketClass;
     using jetassign::input::wait_for_enter;
     using jetassign::input::get_confirmation;
     using jetassign::input::get_menu_option;
@@ -1367,8 +1329,8 @@ void show_details_class()
              << "List the passengers of a particular ticket class.\n"
              << '\n';
 
-        size_t starting_row;
-        size_t ending_row;
+        /** The selected ticket class. */
+        TicketClass ticket_class;
 
         /** The "ticket class" menu. */
         static const Menu<4> menu =
@@ -1387,18 +1349,15 @@ void show_details_class()
         switch (get_menu_option(menu.options.size()))
         {
             case 1: // First class.
-                starting_row = 0;
-                ending_row   = 2;
+                ticket_class = TicketClass::kFirst;
                 break;
 
             case 2: // Business class.
-                starting_row = 2;
-                ending_row   = 7;
+                ticket_class = TicketClass::kBusiness;
                 break;
 
             case 3: // Economy class.
-                starting_row = 7;
-                ending_row   = 13;
+                ticket_class = TicketClass::kEconomy;
                 break;
 
             case 4:
@@ -1415,15 +1374,26 @@ void show_details_class()
         static const auto kLocationColumnWidth = 4;
         static const auto kPassengerNameColumnWidth = 67;
 
-        for (auto row = starting_row; row < ending_row; row++)
+        /** The cabin layout of the seating plan. */
+        const auto &layout = seating_plan.layout();
+
+        for (size_t row = 0; row < layout.rows(); row++)
         {
-            for (auto column = 0; column < JET_COLUMN_LENGTH; column++)
+            // Skips the rows of the other ticket classes.
+            if (layout.ticket_class(row) != ticket_class) { continue; }
+
+            const auto blocked = layout.blocked_bits(row);
+            const auto occupied = seating_plan.occupied_bits(row);
+
+            for (size_t column = 0; column < layout.columns(); column++)
             {
-                // Prints each row of the table.
+                // Prints each row of the table, except the blocked seats.
+
+                if ((blocked >> column) & 1) { continue; }
 
                 const auto location = SeatLocation(row, column);
 
-                const auto passenger_name = seating_plan.is_occupied(location)
+                const auto passenger_name = ((occupied >> column) & 1)
                     ? seating_plan.at(location)->name()
                     : "[vacant]";
 
@@ -1440,302 +1410,455 @@ void show_details_class()
         cout << "+------+---------------------------------------------------------------------+\n"
              << '\n';
 
-        wait_for_enter();
+        wait_for_enter();
+    }
+    while (get_confirmation("Do you want to list the passengers of another ticket class?", true));
+}
+
+void show_details_name()
+{
+    using std::left;
+    using std::right;
+    using std::setw;
+
+    using jetassign::name_index;
+    using jetassign::search::NameIndex;
+    using jetassign::input::wait_for_enter;
+    using jetassign::input::get_confirmation;
+    using jetassign::input::get_passenger_name;
+
+    static const auto kLocationColumnWidth = 4;
+    static const auto kFlightColumnWidth = 16;
+    static const auto kPassengerNameColumnWidth = 32;
+    static const auto kPassportIdColumnWidth = 15;
+
+    do
+    {
+        cout << SECTION_SEPARATOR
+             << "Search for the passengers using their names, or the beginning of their names.\n";
+        const auto name = get_passenger_name();
+        cout << '\n';
+
+        auto matches = name_index.find_prefix(name);
+        if (jetassign::database)
+        {
+            // Also searches the flights of the database that were not loaded yet, which the name
+            // index does not cover.
+            for (auto &match : jetassign::search::find_prefix(*jetassign::database, jetassign::flights, name))
+            {
+                matches.push_back(std::move(match));
+            }
+
+            std::stable_sort(matches.begin(), matches.end(), [](const auto &a, const auto &b)
+            {
+                return (NameIndex::normalize(a.passenger.name()) < NameIndex::normalize(b.passenger.name()));
+            });
+
+            if (matches.size() > NameIndex::kDefaultLimit) { matches.erase(matches.begin() + NameIndex::kDefaultLimit, matches.end()); }
+        }
+
+        if (matches.empty())
+        {
+            // Looks for the misspelled names, if nothing starts with the given name.
+            matches = name_index.find_similar(name);
+            if (jetassign::database)
+            {
+                for (auto &match : jetassign::search::find_similar(*jetassign::database, jetassign::flights, name))
+                {
+                    matches.push_back(std::move(match));
+                }
+
+                std::stable_sort(matches.begin(), matches.end(), [](const auto &a, const auto &b)
+                {
+                    return (std::make_pair(a.distance, NameIndex::normalize(a.passenger.name())) < std::make_pair(b.distance, NameIndex::normalize(b.passenger.name())));
+                });
+
+                if (matches.size() > NameIndex::kDefaultLimit) { matches.erase(matches.begin() + NameIndex::kDefaultLimit, matches.end()); }
+            }
+
+            if (!matches.empty()) { cout << "No exact matches were found, did you mean:\n"; }
+        }
+
+        if (matches.empty())
+        {
+            cout << "No matching passenger were found.\n";
+            continue;
+        }
+
+        // Prints the header of the table.
+        cout << "+------+------------------+----------------------------------+-----------------+\n"
+             << "| Seat | Flight           | Passenger Name                   | Passport ID     |\n"
+             << "+------+------------------+----------------------------------+-----------------+\n";
+
+        for (const auto &match : matches)
+        {
+            const auto flight = match.flight.flight_number.empty()
+                ? string("-")
+                : (match.flight.flight_number + ' ' + match.flight.date);
+
+            cout << "| "
+                 << setw(kLocationColumnWidth) << right << match.location
+                 << " | "
+                 << setw(kFlightColumnWidth) << left << flight
+                 << " | "
+                 << setw(kPassengerNameColumnWidth) << left << match.passenger.name()
+                 << " | "
+                 << setw(kPassportIdColumnWidth) << left << match.passenger.passport_id()
+                 << " |\n";
+        }
+
+        cout << "+------+------------------+----------------------------------+-----------------+\n"
+             << '\n';
+
+        wait_for_enter();
+    }
+    while (get_confirmation("Do you want to search for another passenger?", true));
+}
+
+void show_occupancy_summary()
+{
+    using std::left;
+    using std::right;
+    using std::setw;
+
+    using jetassign::flights;
+    using jetassign::seating_plan;
+    using jetassign::core::Occupancy;
+    using jetassign::core::SeatingPlan;
+    using jetassign::core::TicketClass;
+    using jetassign::input::wait_for_enter;
+
+    static const auto kPartColumnWidth = 14;
+    static const auto kCountColumnWidth = 8;
+    static const auto kLoadColumnWidth = 6;
+
+    static const auto kTableSeparator = "+----------------+----------+----------+----------+--------+\n";
+
+    /** Prints a row of the table. */
+    const auto print_occupancy = [](const string &part, const Occupancy &occupancy)
+    {
+        // Formats the load factor without changing the format flags of the standard output.
+        char load[16];
+        std::snprintf(load, sizeof(load), "%.1f%%", occupancy.load_factor() * 100);
+
+        cout << "| "
+             << setw(kPartColumnWidth) << left << part
+             << " | "
+             << setw(kCountColumnWidth) << right << occupancy.seats()
+             << " | "
+             << setw(kCountColumnWidth) << right << occupancy.occupied
+             << " | "
+             << setw(kCountColumnWidth) << right << occupancy.vacant
+             << " | "
+             << setw(kLoadColumnWidth) << right << load
+             << " |\n";
+    };
+
+    /** Prints the header of the table. */
+    const auto print_header = [](const string &part)
+    {
+        cout << kTableSeparator
+             << "| " << setw(kPartColumnWidth) << left << part << " |    Seats | Occupied |   Vacant |   Load |\n"
+             << kTableSeparator;
+    };
+
+    cout << SECTION_SEPARATOR
+         << "The occupancy of the seating plan, excluding the blocked seats.\n"
+         << '\n';
+
+    print_header("Ticket Class");
+    print_occupancy("First Class", seating_plan.occupancy(TicketClass::kFirst));
+    print_occupancy("Business Class", seating_plan.occupancy(TicketClass::kBusiness));
+    print_occupancy("Economy Class", seating_plan.occupancy(TicketClass::kEconomy));
+    cout << kTableSeparator;
+    print_occupancy("Total", seating_plan.occupancy());
+    cout << kTableSeparator
+         << '\n';
+
+    /** The cabin layout of the seating plan. */
+    const auto &layout = seating_plan.layout();
+
+    print_header("Column");
+    for (size_t column = 0; column < layout.columns(); column++)
+    {
+        print_occupancy(string(1, layout.column_letter(column)), seating_plan.column_occupancy(column));
+    }
+    cout << kTableSeparator
+         << '\n';
+
+    print_header("Row");
+    for (size_t row = 0; row < layout.rows(); row++)
+    {
+        print_occupancy(std::to_string(row + 1), seating_plan.row_occupancy(row));
+    }
+    cout << kTableSeparator;
+
+    if (flights.size() > 0)
+    {
+        // Sums up the counters of the flights, without scanning their seats.
+        auto total = Occupancy();
+        for (const auto &flight : flights.flights())
+        {
+            const auto occupancy = flight->read([](const SeatingPlan &plan) { return plan.occupancy(); });
+            total.occupied += occupancy.occupied;
+            total.vacant += occupancy.vacant;
+        }
+
+        cout << '\n';
+        print_header("Flights");
+        print_occupancy(std::to_string(flights.size()) + " open", total);
+        cout << kTableSeparator;
     }
-    while (get_confirmation("Do you want to list the passengers of another ticket class?", true));
+
+    cout << '\n';
+    wait_for_enter();
 }
 
-void save_and_exit()
+bool save_and_exit()
 {
-    using std::flush;
-    using std::left;
-    using std::right;
-    using std::setw;
-
-    using std::random_device;
-    using std::default_random_engine;
-    using std::uniform_int_distribution;
-
-    using namespace std::chrono_literals;
-
+    using jetassign::snapshot_path;
+    using jetassign::input::get_confirmation;
     using jetassign::input::wait_for_enter;
-    using jetassign::output::Spinner;
-    using jetassign::output::build_progress_bar;
 
-    namespace this_thread = std::this_thread;
+    namespace chrono = std::chrono;
 
     cout << SECTION_SEPARATOR
-         << "Upload the seating plan to the central database.\n"
+         << "Save the seating plan to " << snapshot_path << ".\n"
          << '\n';
 
-    /**
-     * Executes a fake operation.
-     * 
-     * @param operation The name of the operation.
-     * @param max_step  The maximum progress increase for each step.
-     **/
-    const auto execute_operation = [](const string& operation, int max_step)
+    try
     {
-        // The randomizer thingy.
-        random_device device;
-        default_random_engine engine(device());
-
-        // The spinner.
-        auto spinner = Spinner();
+        const auto started_at = chrono::steady_clock::now();
+        const auto size = compact_seating_plans();
+        const auto elapsed = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - started_at);
 
-        /**
-         * Prints the progress animation.
-         * 
-         * @param progress The current progress.
-         **/
-        const auto print_progress = [&](size_t progress)
-        {
-            if (progress > 100) { progress = 100; }
-            const auto is_finished = (progress == 100);
-
-            cout << '\r'
-                 << (is_finished ? 'O' : spinner.spin()) << " "
-                 << operation << ": "
-                 << build_progress_bar(progress, 58) << " "
-                 << setw(3) << right << progress << '%'
-                 << (is_finished ? '\n' : '\0')
-                 << flush;
-        };
-
-        /** The current progress. */
-        size_t progress = 0;
-        print_progress(progress);
-
-        // The other randomizer thingy.
-        uniform_int_distribution progress_step(1, max_step);
-        uniform_int_distribution progress_freeze(0, 3);
+        cout << "The seating plan was saved successfully! (" << size << " bytes in " << (elapsed.count() / 1000.0) << " ms)\n"
+             << SECTION_SEPARATOR;
+    }
+    catch (const jetassign::exceptions::StorageError &e)
+    {
+        std::cerr << "    Error: " << e.what() << '\n';
 
-        do
+        if (!get_confirmation("\nDo you want to leave without saving?", false))
         {
-            // Sleep for 100ms.
-            this_thread::sleep_for(100ms);
-
-            // Increase the progress if this tick should not be frozen.
-            if (!progress_freeze(engine)) { progress += progress_step(engine); }
-            print_progress(progress);
+            return false;
         }
-        while (progress < 100);
-    };
 
-    // Prepare the upload.
-    execute_operation("Preparing", 40);
-    // Upload the seating plan.
-    execute_operation("Uploading", 15);
-
-    cout << '\n'
-         << "The seating plan was uploaded to the central database successfully!\n"
-         << SECTION_SEPARATOR;
+        cout << SECTION_SEPARATOR;
+    }
 
     wait_for_enter("Press ENTER to leave the application...");
+    return true;
 }
 
-namespace jetassign::core
+int import_assignments(const string &path)
 {
-    using std::range_error;
+    using jetassign::seating_plan;
+    using jetassign::input::import_compact_assignments;
 
-    SeatingPlan::SeatingPlan() {}
+    namespace chrono = std::chrono;
 
-    bool SeatingPlan::is_occupied(const SeatLocation &location) const noexcept
+    std::ifstream input(path, std::ios::binary);
+    if (!input)
     {
-        return this->is_occupied(location.row(), location.column());
+        std::cerr << "Error: Unable to open \"" << path << "\".\n";
+        return 1;
     }
 
-    bool SeatingPlan::is_occupied(size_t row, size_t column) const noexcept
-    {
-        return ((bool) seating_plan.at(row).at(column));
-    }
+    const auto started_at = chrono::steady_clock::now();
 
-    bool SeatingPlan::is_assigned(const string &passport_id) const noexcept
+    const auto report = import_compact_assignments(input, seating_plan, [&](size_t line_number, const string &reason)
     {
-        return ((bool) this->location_of(passport_id));
-    }
+        std::cerr << path << ':' << line_number << ": " << reason << '\n';
+    });
 
-    bool SeatingPlan::is_assigned(const Passenger &passenger) const noexcept
-    {
-        return ((bool) this->location_of(passenger));
-    }
+    const auto elapsed = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - started_at);
+
+    cout << "Imported " << path << " in " << (elapsed.count() / 1000.0) << " ms: "
+         << report.accepted << " accepted, "
+         << report.rejected << " rejected.\n";
 
-    SeatingPlan::const_reference SeatingPlan::at(const SeatLocation &location) const
+    try
     {
-        return this->at(location.row(), location.column());
+        compact_seating_plans();
     }
-
-    SeatingPlan::const_reference SeatingPlan::at(size_t row, size_t column) const
+    catch (const jetassign::exceptions::StorageError &e)
     {
-        return seating_plan.at(row).at(column);
+        std::cerr << "Error: " << e.what() << '\n';
+        return 1;
     }
 
-    optional<SeatLocation> SeatingPlan::location_of(const string &passport_id) const
-    {
-        for (auto row = 0; row < JET_ROW_LENGTH; row++)
-        {
-            for (auto column = 0; column < JET_COLUMN_LENGTH; column++)
-            {
-                const auto maybe_passenger = seating_plan.at(row).at(column);
-                if (maybe_passenger && (maybe_passenger->passport_id() == passport_id))
-                {
-                    return SeatLocation(row, column);
-                }
-            }
-        }
+    // The accepted lines were kept, but the caller should know about the rejected ones.
+    return (report.rejected == 0) ? 0 : 1;
+}
 
-        return std::nullopt;
-    }
+int run_script(const string &path)
+{
+    using jetassign::seating_plan;
 
-    optional<SeatLocation> SeatingPlan::location_of(const Passenger &passenger) const
+    std::ifstream file;
+    if (path != "-")
     {
-        for (auto r = 0; r < JET_ROW_LENGTH; r++)
+        file.open(path, std::ios::binary);
+        if (!file)
         {
-            for (auto c = 0; c < JET_COLUMN_LENGTH; c++)
-            {
-                if (seating_plan.at(r).at(c) == passenger)
-                {
-                    return SeatLocation(r, c);
-                }
-            }
+            std::cerr << "Error: Unable to open \"" << path << "\".\n";
+            return 1;
         }
-
-        return std::nullopt;
     }
 
-    void SeatingPlan::assign(const SeatLocation &location, const_reference passenger)
-    {
-        if (this->is_occupied(location))
-        {
-            throw exceptions::SeatOccupiedError(location);
-        }
+    const auto report = jetassign::server::run_script((path == "-") ? cin : file, cout, seating_plan, wait_for_journal);
 
-        seating_plan.at(location.row()).at(location.column()) = passenger;
+    try
+    {
+        compact_seating_plans();
+    }
+    catch (const jetassign::exceptions::StorageError &e)
+    {
+        std::cerr << "Error: " << e.what() << '\n';
+        return 1;
     }
 
-    void SeatingPlan::remove(const SeatLocation &location)
+    return (report.failed == 0) ? 0 : 1;
+}
+
+int export_seat_maps(jetassign::seatmap::Format format)
+{
+    using jetassign::seating_plan;
+    using jetassign::seatmap::SeatMapWriter;
+
+    auto writer = SeatMapWriter(cout, format);
+
+    writer.write(jetassign::core::FlightKey(), *seating_plan.snapshot());
+    for (const auto &flight : jetassign::flights.flights())
     {
-        if (this->is_occupied(location))
-        {
-            seating_plan.at(location.row()).at(location.column()) = std::nullopt;
-        }
+        const auto snapshot = flight->read([](const jetassign::core::SeatingPlan &plan) { return plan.snapshot(); });
+        writer.write(flight->key(), *snapshot);
     }
 
-    void SeatingPlan::remove(const Passenger &passenger)
+    if (jetassign::database)
     {
-        if (this->is_assigned(passenger))
+        // Streams the flights that were not loaded yet straight from the database, rather than
+        // loading every flight into the registry.
+        for (size_t i = 0; i < jetassign::database->size(); i++)
         {
-            const auto location = *(this->location_of(passenger));
-            seating_plan.at(location.row()).at(location.column()) = std::nullopt;
+            const auto mapped = jetassign::database->at(i);
+            const auto key = mapped.key();
+            if (key.flight_number.empty() || jetassign::flights.is_loaded(key) || jetassign::flights.is_closed(key)) { continue; }
+
+            writer.write(key, mapped, seating_plan.layout());
         }
     }
 
-    Passenger::Passenger(const string &name, const string &passport_id)
-        : m_name { name }, m_passport_id { passport_id } {}
+    writer.finish();
 
-    bool Passenger::equals(const Passenger &other) const
+    if (!cout)
     {
-        return ((m_name == other.m_name) && (m_passport_id == other.m_passport_id));
+        std::cerr << "Error: Unable to write the seating plans.\n";
+        return 1;
     }
 
-    #define RANGE_ERROR_MESSAGE(name, max) "The range of the " #name " must between 0 (inclusive) and " STRINGIFY(max) " (exclusive)."
-
-    #define ROW_RANGE_ERROR_MESSAGE RANGE_ERROR_MESSAGE(row, JET_ROW_LENGTH)
+    return 0;
+}
 
-    #define COLUMN_RANGE_ERROR_MESSAGE RANGE_ERROR_MESSAGE(column, JET_COLUMN_LENGTH)
+void wait_for_journal()
+{
+    jetassign::journal->wait(jetassign::journal->ticket());
+}
 
-    string SeatLocation::row_to_string(size_t row)
+bool commit_changes()
+{
+    try
     {
-        if (row >= JET_ROW_LENGTH)
-        {
-            throw range_error(ROW_RANGE_ERROR_MESSAGE);
-        }
-
-        return std::to_string(row + 1);
+        wait_for_journal();
+        return true;
     }
-
-    string SeatLocation::column_to_string(size_t column)
+    catch (const jetassign::exceptions::StorageError &e)
     {
-        if (column >= JET_COLUMN_LENGTH)
-        {
-            throw range_error(COLUMN_RANGE_ERROR_MESSAGE);
-        }
-
-        return string(1, (char) ('A' + column));
+        std::cerr << "    Error: " << e.what() << '\n';
+        return false;
     }
+}
 
-    SeatLocation::SeatLocation(size_t row, size_t column)
-        : m_row { row }, m_column { column }
+size_t compact_seating_plans()
+{
+    using jetassign::database;
+    using jetassign::flights;
+    using jetassign::journal;
+    using jetassign::seating_plan;
+    using jetassign::snapshot_path;
+
+    if (jetassign::use_database)
     {
-        if (row >= JET_ROW_LENGTH)
-        {
-            throw range_error(ROW_RANGE_ERROR_MESSAGE);
-        }
-        else if (column >= JET_COLUMN_LENGTH)
-        {
-            throw range_error(COLUMN_RANGE_ERROR_MESSAGE);
-        }
+        return jetassign::storage::compact_database(snapshot_path, *journal, seating_plan, flights, database);
     }
 
-    TicketClass SeatLocation::ticket_class() const
+    return jetassign::storage::compact(snapshot_path, *journal, seating_plan, flights);
+}
+
+#ifdef __linux__
+int serve(const std::vector<string> &addresses, size_t worker_count)
+{
+    using jetassign::seating_plan;
+    using jetassign::server::Server;
+
+    try
     {
-        if (m_row < 2)
-        {
-            return TicketClass::kFirst;
-        }
-        else if (m_row < 7)
+        Server server(seating_plan, worker_count, wait_for_journal);
+
+        for (const auto &address : addresses)
         {
-            return TicketClass::kBusiness;
+            if (!address.empty() && std::all_of(address.begin(), address.end(), [](char c) { return std::isdigit(static_cast<unsigned char>(c)); }))
+            {
+                const auto port = server.listen_tcp(static_cast<std::uint16_t>(std::stoul(address)));
+                cout << "Listening on 127.0.0.1:" << port << '\n';
+            }
+            else
+            {
+                server.listen_unix(address);
+                cout << "Listening on " << address << '\n';
+            }
         }
-        else
+        cout << flush;
+
+        // The signals were blocked in every thread by main(), thus they could be waited for here.
+        std::thread waiter([&server]()
         {
-            return TicketClass::kEconomy;
-        }
-    }
+            sigset_t signals;
+            sigemptyset(&signals);
+            sigaddset(&signals, SIGINT);
+            sigaddset(&signals, SIGTERM);
 
-    bool SeatLocation::equals(const SeatLocation& other) const
-    {
-        return ((m_row == other.m_row) && (m_column == other.m_column));
-    }
+            int signal;
+            sigwait(&signals, &signal);
+            server.stop();
+        });
 
-    bool SeatLocation::less_than(const SeatLocation &other) const
-    {
-        return ((m_row < other.m_row) || ((m_row == other.m_row) && (m_column < other.m_column)));
-    }
+        server.run();
 
-    string SeatLocation::to_string() const
+        // Wakes up the waiter, in case the server stopped for another reason.
+        pthread_kill(waiter.native_handle(), SIGTERM);
+        waiter.join();
+    }
+    catch (const std::exception &e)
     {
-        return (row_to_string(m_row) + column_to_string(m_column));
+        std::cerr << "Error: " << e.what() << '\n';
+        return 1;
     }
 
-    std::ostream& operator<<(std::ostream& os, const SeatLocation& location)
+    try
     {
-        os << location.to_string();
-        return os;
+        compact_seating_plans();
     }
-
-    #undef COLUMN_RANGE_ERROR_MESSAGE
-    #undef ROW_RANGE_ERROR_MESSAGE
-    #undef RANGE_ERROR_MESSAGE
-
-    string to_string(TicketClass ticket_class) noexcept
+    catch (const jetassign::exceptions::StorageError &e)
     {
-        switch (ticket_class)
-        {
-            case TicketClass::kFirst:
-                return "First";
-            case TicketClass::kBusiness:
-                return "Business";
-            case TicketClass::kEconomy:
-                return "Economy";
-        }
+        std::cerr << "Error: " << e.what() << '\n';
+        return 1;
     }
-}
-
-namespace jetassign::exceptions
-{
 
+    return 0;
 }
+#endif
 
 namespace jetassign::output
 {
@@ -1780,7 +1903,44 @@ namespace jetassign::output
             cout << "[" << ordinal << "] " << option << '\n';
         }
 
-        cout << "*****************" << endl;
+        cout << "*****************\n";
+    }
+
+    BufferedConsole::BufferedConsole(bool report)
+        : m_report { report },
+          m_output(1),
+          m_error(2),
+          m_original_output { cout.rdbuf(&m_output) },
+          m_original_error { std::cerr.rdbuf(&m_error) }
+    {
+        // The errors were written with the rest of the screen, rather than after every insertion.
+        std::cerr.unsetf(std::ios_base::unitbuf);
+    }
+
+    BufferedConsole::~BufferedConsole()
+    {
+        flush_prompt();
+
+        cout.rdbuf(m_original_output);
+        std::cerr.rdbuf(m_original_error);
+        std::cerr.setf(std::ios_base::unitbuf);
+
+        if (m_report)
+        {
+            const auto &output = m_output.statistics();
+            const auto screens = std::max<size_t>(output.screens, 1);
+
+            std::cerr << "Console: " << output.screens << " screens, "
+                      << output.bytes << " bytes and " << output.writes << " writes to the standard output ("
+                      << (output.bytes / screens) << " bytes and " << (static_cast<double>(output.writes) / screens) << " writes per screen), "
+                      << m_error.statistics().writes << " writes to the standard error.\n";
+        }
+    }
+
+    void flush_prompt()
+    {
+        std::cerr.flush();
+        cout.flush();
     }
 
     string build_progress_bar(size_t progress, size_t size)
@@ -1843,12 +2003,15 @@ namespace jetassign::input
 
     void wait_for_enter(const string &message)
     {
-        cout << message << flush;
+        cout << message;
+        output::flush_prompt();
         cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
     }
 
     string read_line()
     {
+        output::flush_prompt();
+
         string line;
         std::getline(cin, line);
 
@@ -1859,7 +2022,7 @@ namespace jetassign::input
     {
         while (true)
         {
-            cout << message << " [y/n] " << flush;
+            cout << message << " [y/n] ";
             auto input = read_line();
 
             try
@@ -1877,7 +2040,7 @@ namespace jetassign::input
     {
         while (true)
         {
-            cout << message << " [" << (default_value ? "Y/n" : "y/N") << "] " << flush;
+            cout << message << " [" << (default_value ? "Y/n" : "y/N") << "] ";
             auto input = read_line();
 
             try
@@ -1908,7 +2071,7 @@ namespace jetassign::input
                 const auto selection = parsers::parse_menu_option(input);
                 if ((selection < min) || (selection > max))
                 {
-                    std::cerr << "    Error: The option selection must between " << min << " and " << max << " (inclusive)." << endl;
+                    std::cerr << "    Error: The option selection must between " << min << " and " << max << " (inclusive).\n";
                     continue;
                 }
 
@@ -1916,7 +2079,7 @@ namespace jetassign::input
             }
             catch(const InvalidInputError &e)
             {
-                std::cerr << "    Error: " << e.what() << endl;;
+                std::cerr << "    Error: " << e.what() << '\n';
             }
         }
     }
@@ -1934,7 +2097,7 @@ namespace jetassign::input
             }
             catch(const InvalidInputError &e)
             {
-                std::cerr << "    Error: " << e.what() << endl;;
+                std::cerr << "    Error: " << e.what() << '\n';
             }
         }
     }
@@ -1952,7 +2115,7 @@ namespace jetassign::input
             }
             catch(const InvalidInputError &e)
             {
-                std::cerr << "    Error: " << e.what() << endl;;
+                std::cerr << "    Error: " << e.what() << '\n';
             }
         }
     }
@@ -1978,7 +2141,7 @@ namespace jetassign::input
             }
             catch(const InvalidInputError &e)
             {
-                std::cerr << "    Error: " << e.what() << endl;;
+                std::cerr << "    Error: " << e.what() << '\n';
             }
         }
     }
@@ -2008,174 +2171,12 @@ namespace jetassign::input
             }
             catch(const InvalidInputError &e)
             {
-                std::cerr << "    Error: " << e.what() << endl;
+                std::cerr << "    Error: " << e.what() << '\n';
             }
         }
 
         return requests;
     }
-
-    AssignmentRequest::AssignmentRequest(const Passenger &passenger, const SeatLocation &location)
-        : m_passenger { passenger }, m_location { location } {}
-
-    AssignmentRequest::AssignmentRequest(const string &passenger_name, const string &passport_id, const SeatLocation &seat_location)
-        : AssignmentRequest(Passenger(passenger_name, passport_id), seat_location) {};
-
-    bool AssignmentRequest::is_same_passenger(const AssignmentRequest &other) const
-    {
-        return (m_passenger == other.m_passenger);
-    }
-
-    bool AssignmentRequest::equals(const AssignmentRequest &other) const
-    {
-        return ((m_passenger == other.m_passenger) && (m_location == other.m_location));
-    }
-
-    string AssignmentRequest::to_string() const
-    {
-        return (m_passenger.name() + "/" + m_passenger.passport_id() + "/" + m_location.to_string());
-    }
-
-    namespace parsers
-    {
-        using std::regex_match;
-        using std::smatch;
-
-        using exceptions::EmptyInputError;
-        using exceptions::MalformedInputError;
-
-        namespace
-        {
-            using std::regex;
-
-            /** Regex pattern for menu options. */
-            const regex kMenuOptionPattern(R"((\d+))");
-
-            /** Regex pattern for passport ID. */
-            const regex kPassportIdPattern("([0-9A-Z]+)", regex::icase);
-
-            /** Regex pattern for seat location. */
-            const regex kSeatLocationPattern("(1[0-3]|[1-9])([A-F])");
-
-            /** Separator for compact assignment. */
-            const auto kCompactAssignmentSeparator = "/";
-        }
-
-        bool parse_confirmation(const string &input)
-        {
-            const auto confirmation = stringutil::trim(input);
-            if (confirmation.empty())
-            {
-                throw EmptyInputError("Please enter a command.");
-            }
-
-            // Check the first character only.
-            switch (confirmation.at(0))
-            {
-                case 'Y':
-                case 'y':
-                    return true;
-
-                case 'N':
-                case 'n':
-                    return false;
-
-                default:
-                    throw MalformedInputError("Invalid response. Please enter a correct command.");
-            }
-        }
-
-        bool parse_confirmation(const string &input, bool default_value)
-        {
-            try
-            {
-                return parse_confirmation(input);
-            }
-            catch (const EmptyInputError& e)
-            {
-                return default_value;
-            }
-        }
-
-        long parse_menu_option(const string &input)
-        {
-            const auto selection = stringutil::trim(input);
-            if (selection.empty())
-            {
-                throw EmptyInputError("The option selection must not be empty.");
-            }
-
-            if (!regex_match(selection, kMenuOptionPattern))
-            {
-                throw MalformedInputError("Only numeric characters were allowed.");
-            }
-
-            // Parse the string into long.
-            return std::stol(selection);
-        }
-
-        string parse_passenger_name(const string &input)
-        {
-            const auto passenger_name = stringutil::trim(input);
-            if (passenger_name.empty())
-            {
-                throw EmptyInputError("The passenger's name must not be empty.");
-            }
-
-            return passenger_name;
-        }
-
-        string parse_passport_id(const string &input)
-        {
-            auto passport_id = stringutil::trim(input);
-            if (passport_id.empty())
-            {
-                throw EmptyInputError("The passport ID must not be empty.");
-            }
-
-            if (!regex_match(passport_id, kPassportIdPattern))
-            {
-                throw MalformedInputError("Only alphanumeric characters were allowed.");
-            }
-
-            return passport_id;
-        }
-
-        SeatLocation parse_seat_location(const string &input)
-        {
-            auto seat_location = stringutil::to_uppercase(stringutil::trim(input));
-            if (seat_location.empty())
-            {
-                throw EmptyInputError("The seat location must not be empty.");
-            }
-
-            std::smatch match_result;
-            if (!regex_match(seat_location, match_result, kSeatLocationPattern))
-            {
-                throw MalformedInputError(R"(The seat location must be formatted as the row (1-13) followed by the column (A-F), e.g. "10D".)");
-            }
-
-            auto row = std::stoi(match_result.str(1)) - 1;
-            auto column = match_result.str(2).at(0) - 'A';
-
-            return SeatLocation(row, column);
-        }
-
-        AssignmentRequest parse_compact_assignment(const string &input)
-        {
-            const auto input_segments = stringutil::split(stringutil::trim(input), kCompactAssignmentSeparator);
-            if (input_segments.size() != 3)
-            {
-                throw exceptions::MalformedInputError(R"(The assignment entry should be formatted as "<Name>/<Passport ID>/<Seat Location>".)");
-            }
-
-            auto passenger_name = parse_passenger_name(input_segments.at(0));
-            auto passport_id = parse_passport_id(input_segments.at(1));
-            auto seat_location = parse_seat_location(input_segments.at(2));
-
-            return AssignmentRequest(passenger_name, passport_id, seat_location);
-        }
-    }
 }
 
 namespace numericutil
@@ -2186,80 +2187,3 @@ namespace numericutil
         return ((value % 2) == 0);
     }
 }
-
-namespace stringutil
-{
-    namespace
-    {
-        /**
-         * The set of characters that considered whitespace characters.
-         **/
-        const auto kWhitespace = "\t\n\v\f\r\x20\xA0";
-    }
-
-    string trim(const string &input)
-    {
-        return trim_end(trim_start(input));
-    }
-
-    string trim_start(const string &input)
-    {
-        /** The position of the first character that not a whitespace character. */
-        const auto index = input.find_first_not_of(kWhitespace);
-
-        // Returns the substring of the input if there were some non-whitespace characters,
-        // otherwise returns an empty string.
-        return ((index == string::npos) ? "" : input.substr(index));
-    }
-
-    string trim_end(const string &input)
-    {
-        /** The position of the last character that not a whitespace character. */
-        const auto index = input.find_last_not_of(kWhitespace);
-
-        // Returns the substring of the input if there were some non-whitespace characters,
-        // otherwise returns an empty string.
-        return ((index == string::npos) ? "" : input.substr(0, index + 1));
-    }
-
-    string to_uppercase(string input)
-    {
-        string output = input;
-        std::transform(input.begin(), input.end(), output.begin(), [](unsigned char c) { return std::toupper(c); });
-
-        return output;
-    }
-
-    vector<string> split(const string &input, const string &separator)
-    {
-        // This function resembles JavaScript's String.prototype.split function.
-
-        /** The segments that were split from the input. */
-        vector<string> segments;
-
-        if (separator.empty())
-        {
-            // Pushes the whole input as a segment if the separator was empty.
-            segments.push_back(input);
-        }
-        else
-        {
-            /** The starting position for each substr and find calls. */
-            size_t start_pos = 0;
-
-            // Splits the input until it reaches its end.
-            do
-            {
-                /** One of the segment that was split from the input. */
-                auto segment = input.substr(start_pos, input.find(separator, start_pos) - start_pos);
-
-                // Pushes the segment to the list and updates the starting position.
-                segments.push_back(segment);
-                start_pos += segment.length() + separator.length();
-            }
-            while (start_pos <= input.length());
-        }
-
-        return segments;
-    }
-}
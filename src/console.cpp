@@ -0,0 +1,111 @@
+/**
+ * Copyright (c) 2021 Jason Kwok, Ben Ho, Ben Yip, Harry Lam, and Hins To.
+ *
+ * Licensed under the GNU Affero General Public License, Version 3.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of the License at
+ *
+ *     https://github.com/JasonHK-HKCC/SEHH2042-Group-Project/blob/master/LICENSE
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under the License
+ * is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ * or implied. See the License for the specific language governing permissions and limitations under
+ * the License.
+ **/
+
+#include "jetassign/console.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace jetassign::console
+{
+    ConsoleBuffer::ConsoleBuffer(int fd, size_t capacity)
+        : m_fd { fd }, m_buffer(std::max<size_t>(capacity, 1))
+    {
+        setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
+    }
+
+    ConsoleBuffer::~ConsoleBuffer()
+    {
+        write_pending();
+    }
+
+    ConsoleBuffer::int_type ConsoleBuffer::overflow(int_type character)
+    {
+        // The buffer was full, thus the screen was written in parts.
+        if (!write_pending()) { return traits_type::eof(); }
+
+        if (!traits_type::eq_int_type(character, traits_type::eof()))
+        {
+            *pptr() = traits_type::to_char_type(character);
+            pbump(1);
+        }
+
+        return traits_type::not_eof(character);
+    }
+
+    std::streamsize ConsoleBuffer::xsputn(const char_type *data, std::streamsize size)
+    {
+        std::streamsize written = 0;
+        while (written < size)
+        {
+            if (pptr() == epptr() && !write_pending()) { break; }
+
+            const auto chunk = std::min<std::streamsize>(size - written, epptr() - pptr());
+            std::memcpy(pptr(), data + written, chunk);
+            pbump(static_cast<int>(chunk));
+            written += chunk;
+        }
+
+        return written;
+    }
+
+    int ConsoleBuffer::sync()
+    {
+        if (pptr() == pbase()) { return 0; }
+        if (!write_pending()) { return -1; }
+
+        m_statistics.screens++;
+        return 0;
+    }
+
+    bool ConsoleBuffer::write_pending()
+    {
+        const auto pending = static_cast<size_t>(pptr() - pbase());
+        if (pending == 0) { return true; }
+
+        size_t offset = 0;
+        while (offset < pending)
+        {
+#ifdef _WIN32
+            const auto written = _write(m_fd, m_buffer.data() + offset, static_cast<unsigned int>(pending - offset));
+#else
+            const auto written = ::write(m_fd, m_buffer.data() + offset, pending - offset);
+#endif
+            m_statistics.writes++;
+
+            if (written < 0)
+            {
+                if (errno == EINTR) { continue; }
+
+                // Discards the output that could not be written, e.g. the terminal was closed.
+                setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
+                return false;
+            }
+
+            offset += static_cast<size_t>(written);
+        }
+
+        m_statistics.bytes += pending;
+
+        setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
+        return true;
+    }
+}
@@ -0,0 +1,1807 @@
+/**
+ * Copyright (c) 2021 Jason Kwok, Ben Ho, Ben Yip, Harry Lam, and Hins To.
+ *
+ * Licensed under the GNU Affero General Public License, Version 3.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of the License at
+ *
+ *     https://github.com/JasonHK-HKCC/SEHH2042-Group-Project/blob/master/LICENSE
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under the License
+ * is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ * or implied. See the License for the specific language governing permissions and limitations under
+ * the License.
+ **/
+
+#include "jetassign/core.hpp"
+#include "jetassign/exceptions.hpp"
+#include "jetassign/stringutil.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <new>
+#include <stdexcept>
+#include <unordered_set>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace jetassign::core
+{
+    using std::range_error;
+
+    namespace
+    {
+        /**
+         * Allocates from a shared memory resource, and keeps the resource alive until everything
+         * that was allocated by it or its copies was released.
+         **/
+        template<typename T>
+        class SharedResourceAllocator
+        {
+            public:
+                typedef T value_type;
+
+                explicit SharedResourceAllocator(std::shared_ptr<std::pmr::memory_resource> resource) noexcept
+                    : m_resource { std::move(resource) } {}
+
+                template<typename U>
+                SharedResourceAllocator(const SharedResourceAllocator<U> &other) noexcept
+                    : m_resource { other.m_resource } {}
+
+                T* allocate(size_t count) { return static_cast<T*>(m_resource->allocate(count * sizeof(T), alignof(T))); }
+
+                void deallocate(T *pointer, size_t count) { m_resource->deallocate(pointer, count * sizeof(T), alignof(T)); }
+
+                template<typename U>
+                bool operator ==(const SharedResourceAllocator<U> &other) const noexcept { return (*m_resource == *other.m_resource); }
+
+                template<typename U>
+                bool operator !=(const SharedResourceAllocator<U> &other) const noexcept { return !(*this == other); }
+
+            private:
+                template<typename U>
+                friend class SharedResourceAllocator;
+
+                /**
+                 * The memory resource.
+                 **/
+                std::shared_ptr<std::pmr::memory_resource> m_resource;
+        };
+
+        /**
+         * A pool that was guarded by a lock. Unlike the synchronized pool of the standard library,
+         * it does not reserve any thread-specific storage, thus each flight could own one.
+         **/
+        class LockedPoolResource : public std::pmr::memory_resource
+        {
+            public:
+                /**
+                 * Initialize an empty pool.
+                 *
+                 * @param upstream The memory resource that the pool was refilled from.
+                 **/
+                explicit LockedPoolResource(std::pmr::memory_resource *upstream) : m_pool(upstream) {}
+
+            private:
+                /**
+                 * The lock that guards the pool.
+                 **/
+                std::mutex m_mutex;
+
+                /**
+                 * The pool.
+                 **/
+                std::pmr::unsynchronized_pool_resource m_pool;
+
+                void* do_allocate(size_t bytes, size_t alignment) override
+                {
+                    const std::lock_guard<std::mutex> lock(m_mutex);
+                    return m_pool.allocate(bytes, alignment);
+                }
+
+                void do_deallocate(void *pointer, size_t bytes, size_t alignment) override
+                {
+                    const std::lock_guard<std::mutex> lock(m_mutex);
+                    m_pool.deallocate(pointer, bytes, alignment);
+                }
+
+                bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+                {
+                    return (this == &other);
+                }
+        };
+
+        /**
+         * Allocates a block of a snapshot from a shared memory resource.
+         *
+         * @param resource  The memory resource, which was kept alive by the block.
+         * @param arguments The arguments of the constructor.
+         **/
+        template<typename T, typename... TArguments>
+        std::shared_ptr<T> allocate_block(const std::shared_ptr<std::pmr::memory_resource> &resource, TArguments&&... arguments)
+        {
+            return std::allocate_shared<T>(SharedResourceAllocator<T>(resource), std::forward<TArguments>(arguments)...);
+        }
+
+        /**
+         * Returns the number of bits that were set.
+         *
+         * @param bits The bits.
+         **/
+        inline size_t count_bits(std::uint64_t bits)
+        {
+#ifdef _MSC_VER
+            return static_cast<size_t>(__popcnt64(bits));
+#else
+            return static_cast<size_t>(__builtin_popcountll(bits));
+#endif
+        }
+
+        /**
+         * Returns the position of the lowest bit that was set, the bits must not be zero.
+         *
+         * @param bits The bits.
+         **/
+        inline size_t lowest_bit(std::uint64_t bits)
+        {
+#ifdef _MSC_VER
+            unsigned long position;
+            _BitScanForward64(&position, bits);
+            return static_cast<size_t>(position);
+#else
+            return static_cast<size_t>(__builtin_ctzll(bits));
+#endif
+        }
+
+        /**
+         * Returns the position of the highest bit that was set, the bits must not be zero.
+         *
+         * @param bits The bits.
+         **/
+        inline size_t highest_bit(std::uint64_t bits)
+        {
+#ifdef _MSC_VER
+            unsigned long position;
+            _BitScanReverse64(&position, bits);
+            return static_cast<size_t>(position);
+#else
+            return static_cast<size_t>(63 - __builtin_clzll(bits));
+#endif
+        }
+
+        /**
+         * Returns the columns where a group of vacant seats that were side by side starts.
+         *
+         * @param vacant   The vacant seats of a row.
+         * @param adjacent The columns that were side by side with the next column.
+         * @param count    The number of seats in the group.
+         **/
+        inline std::uint64_t adjacent_vacant_bits(std::uint64_t vacant, std::uint64_t adjacent, size_t count)
+        {
+            // Extends the groups by one seat on each iteration, i.e. bit N was kept if the seat after
+            // the group starting from the Nth column was also vacant and side by side.
+            auto starts = vacant;
+            for (size_t length = 1; (length < count) && (starts != 0); length++)
+            {
+                starts = (vacant & adjacent & (starts >> 1));
+            }
+
+            return starts;
+        }
+    }
+
+    SeatingPlan::SeatingPlan(std::pmr::memory_resource *resource, std::shared_ptr<std::pmr::memory_resource> snapshot_resource)
+        : m_layout { CabinLayout::active() },
+          seating_plan(m_layout->seats(), resource),
+          m_occupancy(m_layout->rows(), 0, resource),
+          m_class_occupancy {},
+          m_column_occupancy(m_layout->columns(), Occupancy(), resource),
+          passenger_index(resource),
+          m_publication { std::make_shared<Publication>() },
+          m_snapshot_resource { std::move(snapshot_resource) },
+          m_is_applying { false }
+    {
+        if (!m_snapshot_resource)
+        {
+            // Refers to the default resource without owning it, which never allocates.
+            m_snapshot_resource = std::shared_ptr<std::pmr::memory_resource>(std::shared_ptr<void>(), std::pmr::get_default_resource());
+        }
+
+        // Counts the seats that could be assigned, i.e. excluding the blocked seats.
+        for (size_t row = 0; row < m_layout->rows(); row++)
+        {
+            const auto vacant = this->vacant_bits(row);
+            const auto count = count_bits(vacant);
+
+            m_total_occupancy.vacant += count;
+            m_class_occupancy[static_cast<size_t>(m_layout->ticket_class(row))].vacant += count;
+            for (size_t column = 0; column < m_layout->columns(); column++)
+            {
+                if ((vacant >> column) & 1) { m_column_occupancy[column].vacant++; }
+            }
+        }
+
+        // The empty rows and index chunks were shared by the first snapshot.
+        const auto block_resource = m_snapshot_resource.get();
+
+        auto empty_row = allocate_block<Snapshot::Row>(m_snapshot_resource, block_resource);
+        empty_row->seats.resize(m_layout->columns());
+
+        auto empty_row_chunk = allocate_block<Snapshot::RowChunk>(m_snapshot_resource);
+        empty_row_chunk->fill(empty_row);
+
+        auto empty_shard = allocate_block<Snapshot::IndexShard>(m_snapshot_resource);
+        empty_shard->fill(allocate_block<Snapshot::IndexChunk>(m_snapshot_resource, block_resource));
+
+        auto snapshot = allocate_block<Snapshot>(m_snapshot_resource, block_resource);
+        snapshot->m_layout = m_layout;
+        snapshot->m_rows.assign((m_layout->rows() + Snapshot::kRowsPerChunk - 1) / Snapshot::kRowsPerChunk, empty_row_chunk);
+        snapshot->m_index.fill(empty_shard);
+
+        m_publication->snapshot = std::move(snapshot);
+    }
+
+    bool SeatingPlan::is_occupied(const SeatLocation &location) const noexcept
+    {
+        return this->is_occupied(location.row(), location.column());
+    }
+
+    bool SeatingPlan::is_occupied(size_t row, size_t column) const noexcept
+    {
+        return ((row < m_occupancy.size()) && (column < m_layout->columns()) && ((m_occupancy[row] >> column) & 1));
+    }
+
+    bool SeatingPlan::is_blocked(const SeatLocation &location) const
+    {
+        return m_layout->is_blocked(location.row(), location.column());
+    }
+
+    std::uint64_t SeatingPlan::vacant_bits(size_t row) const
+    {
+        return (m_layout->row_bits() & ~(m_occupancy.at(row) | m_layout->blocked_bits(row)));
+    }
+
+    Occupancy SeatingPlan::row_occupancy(size_t row) const
+    {
+        return Occupancy { count_bits(m_occupancy.at(row)), count_bits(this->vacant_bits(row)) };
+    }
+
+    optional<size_t> SeatingPlan::first_vacant_column(size_t row) const
+    {
+        const auto vacant = this->vacant_bits(row);
+        if (vacant == 0)
+        {
+            return std::nullopt;
+        }
+
+        return lowest_bit(vacant);
+    }
+
+    optional<SeatLocation> SeatingPlan::find_adjacent_vacant_seats(size_t count, optional<TicketClass> ticket_class) const
+    {
+        if ((count == 0) || (count > m_layout->columns()))
+        {
+            return std::nullopt;
+        }
+
+        const auto adjacent = m_layout->adjacent_bits();
+        for (size_t row = 0; row < m_occupancy.size(); row++)
+        {
+            if (ticket_class && (m_layout->ticket_class(row) != *ticket_class)) { continue; }
+
+            const auto starts = adjacent_vacant_bits(this->vacant_bits(row), adjacent, count);
+            if (starts != 0)
+            {
+                return SeatLocation(row, lowest_bit(starts));
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    bool SeatingPlan::is_assigned(string_view passport_id) const noexcept
+    {
+        return ((bool) this->location_of(passport_id));
+    }
+
+    bool SeatingPlan::is_assigned(const Passenger &passenger) const noexcept
+    {
+        return ((bool) this->location_of(passenger));
+    }
+
+    SeatingPlan::const_reference SeatingPlan::at(const SeatLocation &location) const
+    {
+        return this->at(location.row(), location.column());
+    }
+
+    SeatingPlan::const_reference SeatingPlan::at(size_t row, size_t column) const
+    {
+        return seating_plan.at(m_layout->index_of(row, column));
+    }
+
+    optional<SeatLocation> SeatingPlan::location_of(string_view passport_id) const
+    {
+        // No passengers could have a passport ID longer than the maximum length.
+        if (passport_id.size() > PassportId::kMaxLength) { return std::nullopt; }
+
+        const auto entry = passenger_index.find(passport_id);
+        if (entry == passenger_index.end())
+        {
+            return std::nullopt;
+        }
+
+        return entry->second;
+    }
+
+    optional<SeatLocation> SeatingPlan::location_of(const Passenger &passenger) const
+    {
+        const auto entry = passenger_index.find(passenger.passport_key());
+        const auto location = (entry != passenger_index.end()) ? optional<SeatLocation>(entry->second) : std::nullopt;
+        if (location && (this->at(*location) == passenger))
+        {
+            return location;
+        }
+
+        return std::nullopt;
+    }
+
+    void SeatingPlan::assign(const SeatLocation &location, const_reference passenger)
+    {
+        if (this->is_blocked(location))
+        {
+            throw exceptions::SeatBlockedError(location);
+        }
+
+        if (this->is_occupied(location))
+        {
+            throw exceptions::SeatOccupiedError(location);
+        }
+
+        if (passenger)
+        {
+            // Each passport ID could only be assigned to one seat.
+            const auto [entry, inserted] = passenger_index.emplace(passenger->passport_key(), location);
+            if (!inserted)
+            {
+                throw exceptions::PassengerAssignedError(entry->second);
+            }
+        }
+
+        seating_plan.at(m_layout->index_of(location.row(), location.column())) = passenger;
+
+        if (passenger)
+        {
+            m_occupancy[location.row()] |= (std::uint64_t(1) << location.column());
+            this->count_seat(location, true);
+
+            m_dirty_rows.push_back(location.row());
+            m_dirty_passports.push_back(passenger->passport_key());
+            this->publish();
+
+            for (const auto observer : m_observers) { observer->on_assigned(*this, location, *passenger); }
+        }
+    }
+
+    void SeatingPlan::remove(const SeatLocation &location)
+    {
+        if (this->is_occupied(location))
+        {
+            auto &maybe_passenger = seating_plan.at(m_layout->index_of(location.row(), location.column()));
+            const auto passenger = std::move(*maybe_passenger);
+
+            passenger_index.erase(passenger.passport_key());
+            maybe_passenger = std::nullopt;
+            m_occupancy[location.row()] &= ~(std::uint64_t(1) << location.column());
+            this->count_seat(location, false);
+
+            m_dirty_rows.push_back(location.row());
+            m_dirty_passports.push_back(passenger.passport_key());
+            this->publish();
+
+            for (const auto observer : m_observers) { observer->on_removed(*this, location, passenger); }
+        }
+    }
+
+    void SeatingPlan::remove(const Passenger &passenger)
+    {
+        const auto location = this->location_of(passenger);
+        if (location)
+        {
+            this->remove(*location);
+        }
+    }
+
+    void SeatingPlan::count_seat(const SeatLocation &location, bool occupied) noexcept
+    {
+        for (auto occupancy : { &m_total_occupancy, &m_class_occupancy[static_cast<size_t>(m_layout->ticket_class(location.row()))], &m_column_occupancy[location.column()] })
+        {
+            if (occupied)
+            {
+                occupancy->occupied++;
+                occupancy->vacant--;
+            }
+            else
+            {
+                occupancy->occupied--;
+                occupancy->vacant++;
+            }
+        }
+    }
+
+    SeatingPlan::Transaction SeatingPlan::begin()
+    {
+        return Transaction(*this);
+    }
+
+    std::shared_ptr<const SeatingPlan::Snapshot> SeatingPlan::snapshot() const
+    {
+        return std::atomic_load(&m_publication->snapshot);
+    }
+
+    void SeatingPlan::publish()
+    {
+        if (m_is_applying || m_dirty_rows.empty()) { return; }
+
+        // Only the writer replaces the snapshot, thus it could be read without synchronization.
+        const auto &previous = *m_publication->snapshot;
+        const auto block_resource = m_snapshot_resource.get();
+
+        auto next = allocate_block<Snapshot>(m_snapshot_resource, block_resource);
+        next->m_layout = previous.m_layout;
+        next->m_version = previous.m_version + 1;
+        next->m_rows = previous.m_rows;
+        next->m_index = previous.m_index;
+
+        // Copies the changed rows and their chunks only, once for each publication.
+        std::sort(m_dirty_rows.begin(), m_dirty_rows.end());
+        m_dirty_rows.erase(std::unique(m_dirty_rows.begin(), m_dirty_rows.end()), m_dirty_rows.end());
+
+        const auto columns = m_layout->columns();
+        std::shared_ptr<Snapshot::RowChunk> next_row_chunk;
+        for (const auto row : m_dirty_rows)
+        {
+            const auto chunk = row / Snapshot::kRowsPerChunk;
+            if (!next_row_chunk || (next->m_rows[chunk] != next_row_chunk))
+            {
+                // The dirty rows were sorted, thus each chunk was copied once.
+                next_row_chunk = allocate_block<Snapshot::RowChunk>(m_snapshot_resource, *previous.m_rows[chunk]);
+                next->m_rows[chunk] = next_row_chunk;
+            }
+
+            auto next_row = allocate_block<Snapshot::Row>(m_snapshot_resource, block_resource);
+            next_row->occupied = m_occupancy[row];
+            next_row->seats.assign(seating_plan.begin() + (row * columns), seating_plan.begin() + ((row + 1) * columns));
+
+            (*next_row_chunk)[row % Snapshot::kRowsPerChunk] = std::move(next_row);
+        }
+
+        // Copies the changed chunks of the passport index and their shards only, once for each
+        // publication.
+        std::array<std::shared_ptr<Snapshot::IndexShard>, Snapshot::kIndexShards> next_shards;
+        std::array<std::array<std::shared_ptr<Snapshot::IndexChunk>, Snapshot::kIndexChunks>, Snapshot::kIndexShards> next_chunks;
+        for (const auto &passport_id : m_dirty_passports)
+        {
+            const auto shard = Snapshot::shard_of(passport_id);
+            if (!next_shards[shard])
+            {
+                next_shards[shard] = allocate_block<Snapshot::IndexShard>(m_snapshot_resource, *previous.m_index[shard]);
+                next->m_index[shard] = next_shards[shard];
+            }
+
+            const auto chunk = Snapshot::chunk_of(passport_id);
+            auto &next_chunk = next_chunks[shard][chunk];
+            if (!next_chunk)
+            {
+                next_chunk = allocate_block<Snapshot::IndexChunk>(m_snapshot_resource, *(*previous.m_index[shard])[chunk], block_resource);
+                (*next_shards[shard])[chunk] = next_chunk;
+            }
+
+            const auto entry = passenger_index.find(passport_id);
+            if (entry != passenger_index.end())
+            {
+                next_chunk->insert_or_assign(passport_id, entry->second);
+            }
+            else
+            {
+                next_chunk->erase(passport_id);
+            }
+        }
+
+        m_dirty_rows.clear();
+        m_dirty_passports.clear();
+
+        const auto version = next->m_version;
+        std::atomic_store(&m_publication->snapshot, std::shared_ptr<const Snapshot>(std::move(next)));
+        m_publication->version.store(version, std::memory_order_release);
+    }
+
+    bool SeatingPlan::Snapshot::is_occupied(size_t row, size_t column) const
+    {
+        return ((row < m_layout->rows()) && (column < m_layout->columns()) && ((this->row(row).occupied >> column) & 1));
+    }
+
+    SeatingPlan::const_reference SeatingPlan::Snapshot::at(const SeatLocation &location) const
+    {
+        // Validates the location of the seat.
+        m_layout->index_of(location.row(), location.column());
+
+        return this->row(location.row()).seats[location.column()];
+    }
+
+    optional<SeatLocation> SeatingPlan::Snapshot::location_of(string_view passport_id) const
+    {
+        if (passport_id.size() > PassportId::kMaxLength) { return std::nullopt; }
+
+        const auto &chunk = *(*m_index[shard_of(passport_id)])[chunk_of(passport_id)];
+
+        const auto entry = chunk.find(passport_id);
+        if (entry == chunk.end())
+        {
+            return std::nullopt;
+        }
+
+        return entry->second;
+    }
+
+    const SeatingPlan::Snapshot::Row& SeatingPlan::Snapshot::row(size_t row) const
+    {
+        if (row >= m_layout->rows())
+        {
+            throw std::out_of_range("The row of the snapshot was out of range.");
+        }
+
+        return *(*m_rows[row / kRowsPerChunk])[row % kRowsPerChunk];
+    }
+
+    SeatingPlan::DeferredPublication::DeferredPublication(SeatingPlan &plan)
+        : m_plan { plan }, m_was_applying { plan.m_is_applying }
+    {
+        m_plan.m_is_applying = true;
+    }
+
+    SeatingPlan::DeferredPublication::~DeferredPublication()
+    {
+        m_plan.m_is_applying = m_was_applying;
+
+        try
+        {
+            m_plan.publish();
+        }
+        catch (...)
+        {
+            // The changes stay dirty, thus the next publication still includes them.
+        }
+    }
+
+    SeatingPlan::Reader::Reader(const SeatingPlan &plan)
+        : m_publication { plan.m_publication }, m_snapshot { plan.snapshot() } {}
+
+    const SeatingPlan::Snapshot& SeatingPlan::Reader::current()
+    {
+        // Only fetches the snapshot, which contends on the reference count, if it was outdated.
+        if (m_snapshot->version() != m_publication->version.load(std::memory_order_acquire))
+        {
+            m_snapshot = std::atomic_load(&m_publication->snapshot);
+        }
+
+        return *m_snapshot;
+    }
+
+    void SeatingPlan::subscribe(SeatingPlanObserver *observer)
+    {
+        if (std::find(m_observers.begin(), m_observers.end(), observer) == m_observers.end())
+        {
+            m_observers.push_back(observer);
+        }
+    }
+
+    void SeatingPlan::unsubscribe(SeatingPlanObserver *observer)
+    {
+        m_observers.erase(std::remove(m_observers.begin(), m_observers.end(), observer), m_observers.end());
+    }
+
+    SeatingPlan::Transaction::Transaction(SeatingPlan &plan) : m_plan { &plan } {}
+
+    SeatingPlan::Transaction::Transaction(Transaction &&other) noexcept
+        : m_plan { other.m_plan }, m_changes { std::move(other.m_changes) }
+    {
+        other.m_plan = nullptr;
+    }
+
+    SeatingPlan::Transaction::~Transaction()
+    {
+        this->rollback();
+    }
+
+    void SeatingPlan::Transaction::assign(const SeatLocation &location, Passenger passenger)
+    {
+        m_changes.push_back({ true, location, std::move(passenger) });
+    }
+
+    void SeatingPlan::Transaction::remove(const SeatLocation &location)
+    {
+        m_changes.push_back({ false, location, std::nullopt });
+    }
+
+    void SeatingPlan::Transaction::remove(const Passenger &passenger)
+    {
+        m_changes.push_back({ false, std::nullopt, passenger });
+    }
+
+    void SeatingPlan::Transaction::move(const Passenger &passenger, const SeatLocation &location)
+    {
+        this->remove(passenger);
+        this->assign(location, passenger);
+    }
+
+    void SeatingPlan::Transaction::commit()
+    {
+        if (m_plan == nullptr)
+        {
+            throw std::logic_error("The transaction was already finished.");
+        }
+
+        auto &plan = *m_plan;
+        const auto &layout = plan.layout();
+
+        // 1. Validates the changes against the staged state, without touching the seating plan.
+
+        /** The staged passenger of each seat that was changed, by the index of the seat. */
+        std::unordered_map<size_t, const Passenger*> staged_seats;
+        /** The staged seat of each passenger that was changed, by the passport ID. */
+        std::unordered_map<PassportId, optional<SeatLocation>, PassportIdHash> staged_passengers;
+
+        const auto passenger_at = [&](const SeatLocation &location) -> const Passenger*
+        {
+            const auto seat = staged_seats.find(layout.index_of(location.row(), location.column()));
+            if (seat != staged_seats.end()) { return seat->second; }
+
+            const auto &maybe_passenger = plan.at(location);
+            return maybe_passenger ? &(*maybe_passenger) : nullptr;
+        };
+
+        const auto location_of = [&](const PassportId &passport_id) -> optional<SeatLocation>
+        {
+            const auto passenger = staged_passengers.find(passport_id);
+            return (passenger != staged_passengers.end()) ? passenger->second : plan.location_of(passport_id);
+        };
+
+        /** The changes with the locations resolved. */
+        std::vector<std::pair<SeatLocation, const Passenger*>> resolved_changes;
+        resolved_changes.reserve(m_changes.size());
+
+        for (const auto &change : m_changes)
+        {
+            if (change.is_assignment)
+            {
+                const auto &location = *change.location;
+                if (plan.is_blocked(location))
+                {
+                    throw exceptions::SeatBlockedError(location);
+                }
+
+                if (passenger_at(location) != nullptr)
+                {
+                    throw exceptions::SeatOccupiedError(location);
+                }
+
+                const auto assigned_location = location_of(change.passenger->passport_key());
+                if (assigned_location)
+                {
+                    throw exceptions::PassengerAssignedError(*assigned_location);
+                }
+
+                staged_seats[layout.index_of(location.row(), location.column())] = &(*change.passenger);
+                staged_passengers[change.passenger->passport_key()] = location;
+                resolved_changes.emplace_back(location, &(*change.passenger));
+            }
+            else
+            {
+                auto location = change.location;
+                if (!location)
+                {
+                    // Removes the passenger only if the name also matches.
+                    location = location_of(change.passenger->passport_key());
+                    const auto occupant = location ? passenger_at(*location) : nullptr;
+                    if ((occupant == nullptr) || (*occupant != *change.passenger)) { location = std::nullopt; }
+                }
+
+                const auto passenger = location ? passenger_at(*location) : nullptr;
+                if (passenger == nullptr) { continue; }
+
+                staged_passengers[passenger->passport_key()] = std::nullopt;
+                staged_seats[layout.index_of(location->row(), location->column())] = nullptr;
+                resolved_changes.emplace_back(*location, nullptr);
+            }
+        }
+
+        // 2. Applies the changes, and reverts them if anything unexpected happened.
+
+        for (const auto observer : plan.m_observers) { observer->on_transaction_begun(plan); }
+
+        // Publishes a snapshot once, after all the changes were applied or reverted, unless the
+        // publication was deferred by the caller.
+        const auto was_applying = plan.m_is_applying;
+        plan.m_is_applying = true;
+
+        /** The changes that were applied, for reverting them. */
+        std::vector<std::pair<SeatLocation, optional<Passenger>>> undo_log;
+        undo_log.reserve(resolved_changes.size());
+
+        try
+        {
+            for (const auto &[location, passenger] : resolved_changes)
+            {
+                if (passenger != nullptr)
+                {
+                    plan.assign(location, *passenger);
+                    undo_log.emplace_back(location, std::nullopt);
+                }
+                else
+                {
+                    undo_log.emplace_back(location, plan.at(location));
+                    plan.remove(location);
+                }
+            }
+        }
+        catch (...)
+        {
+            for (auto change = undo_log.rbegin(); change != undo_log.rend(); change++)
+            {
+                if (change->second) { plan.assign(change->first, change->second); }
+                else { plan.remove(change->first); }
+            }
+
+            plan.m_is_applying = was_applying;
+            plan.publish();
+
+            for (const auto observer : plan.m_observers) { observer->on_transaction_ended(plan, false); }
+            throw;
+        }
+
+        plan.m_is_applying = was_applying;
+        plan.publish();
+
+        for (const auto observer : plan.m_observers) { observer->on_transaction_ended(plan, true); }
+
+        m_changes.clear();
+        m_plan = nullptr;
+    }
+
+    void SeatingPlan::Transaction::rollback()
+    {
+        m_changes.clear();
+        m_plan = nullptr;
+    }
+
+    SeatAllocator::SeatAllocator(const SeatingPlan &plan)
+        : m_layout { plan.layout() }, m_vacant(m_layout.rows()), m_vacant_count { 0 }
+    {
+        for (size_t row = 0; row < m_layout.rows(); row++)
+        {
+            m_vacant[row] = plan.vacant_bits(row);
+            m_vacant_count += count_bits(m_vacant[row]);
+        }
+    }
+
+    bool SeatAllocator::is_vacant(const SeatLocation &location) const
+    {
+        // Validates the location of the seat.
+        m_layout.index_of(location.row(), location.column());
+
+        return ((m_vacant[location.row()] >> location.column()) & 1);
+    }
+
+    void SeatAllocator::reserve(const SeatLocation &location)
+    {
+        if (this->is_vacant(location))
+        {
+            m_vacant[location.row()] &= ~(std::uint64_t(1) << location.column());
+            m_vacant_count--;
+        }
+    }
+
+    void SeatAllocator::release(const SeatLocation &location)
+    {
+        if (!this->is_vacant(location) && !m_layout.is_blocked(location.row(), location.column()))
+        {
+            m_vacant[location.row()] |= (std::uint64_t(1) << location.column());
+            m_vacant_count++;
+        }
+    }
+
+    optional<SeatLocation> SeatAllocator::allocate(optional<TicketClass> ticket_class, optional<SeatLocation> preferred)
+    {
+        const auto seats = this->allocate_party(1, ticket_class, preferred);
+        if (!seats)
+        {
+            return std::nullopt;
+        }
+
+        return seats->front();
+    }
+
+    optional<std::vector<SeatLocation>> SeatAllocator::allocate_party(size_t count, optional<TicketClass> ticket_class, optional<SeatLocation> preferred)
+    {
+        if (count > m_vacant_count)
+        {
+            return std::nullopt;
+        }
+
+        if (!ticket_class && preferred)
+        {
+            // Prefers the ticket class of the preferred seat.
+            ticket_class = m_layout.ticket_class(preferred->row());
+        }
+
+        const auto anchor = this->anchor_of(ticket_class, preferred);
+
+        std::vector<SeatLocation> seats;
+        seats.reserve(count);
+
+        // Seats the whole party side by side, in the preferred ticket class first.
+        auto start = this->find_nearest(count, ticket_class, anchor);
+        if (!start && ticket_class) { start = this->find_nearest(count, std::nullopt, anchor); }
+
+        if (start)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                seats.push_back(SeatLocation(start->row(), start->column() + i));
+                this->reserve(seats.back());
+            }
+
+            return seats;
+        }
+
+        // Otherwise, seats each member nearest to the previous one.
+        auto next_anchor = anchor;
+        for (size_t i = 0; i < count; i++)
+        {
+            auto seat = this->find_nearest(1, ticket_class, next_anchor);
+            if (!seat) { seat = this->find_nearest(1, std::nullopt, next_anchor); }
+
+            seats.push_back(*seat);
+            this->reserve(*seat);
+            next_anchor = *seat;
+        }
+
+        return seats;
+    }
+
+    optional<SeatLocation> SeatAllocator::find_nearest(size_t count, optional<TicketClass> ticket_class, const SeatLocation &anchor) const
+    {
+        if ((count == 0) || (count > m_layout.columns()))
+        {
+            return std::nullopt;
+        }
+
+        const auto adjacent = m_layout.adjacent_bits();
+        const auto anchor_column = anchor.column();
+
+        optional<SeatLocation> nearest;
+        size_t nearest_distance = 0;
+
+        /**
+         * Considers the groups of vacant seats in a row.
+         *
+         * @param row The row.
+         **/
+        const auto visit = [&](size_t row)
+        {
+            if ((m_vacant[row] == 0) || (ticket_class && (m_layout.ticket_class(row) != *ticket_class))) { return; }
+
+            const auto starts = adjacent_vacant_bits(m_vacant[row], adjacent, count);
+            if (starts == 0) { return; }
+
+            // The nearest group on the left and on the right of the anchor column, the left wins the ties.
+            const auto right = (starts >> anchor_column);
+            const auto left = (starts & ((std::uint64_t(1) << anchor_column) - 1));
+
+            if (left != 0)
+            {
+                const auto column = highest_bit(left);
+                const auto distance = (anchor_column - column);
+                if (!nearest || (distance < nearest_distance))
+                {
+                    nearest = SeatLocation(row, column);
+                    nearest_distance = distance;
+                }
+            }
+
+            if (right != 0)
+            {
+                const auto distance = lowest_bit(right);
+                if (!nearest || (distance < nearest_distance))
+                {
+                    nearest = SeatLocation(row, anchor_column + distance);
+                    nearest_distance = distance;
+                }
+            }
+        };
+
+        // Searches the rows outwards from the anchor, where the nearer rows always win.
+        const auto rows = m_layout.rows();
+        for (size_t offset = 0; (offset < rows) && !nearest; offset++)
+        {
+            if (anchor.row() >= offset) { visit(anchor.row() - offset); }
+            if ((offset > 0) && ((anchor.row() + offset) < rows)) { visit(anchor.row() + offset); }
+        }
+
+        return nearest;
+    }
+
+    SeatLocation SeatAllocator::anchor_of(optional<TicketClass> ticket_class, const optional<SeatLocation> &preferred) const
+    {
+        if (preferred)
+        {
+            return *preferred;
+        }
+
+        // The front of the ticket class.
+        for (size_t row = 0; ticket_class && (row < m_layout.rows()); row++)
+        {
+            if (m_layout.ticket_class(row) == *ticket_class) { return SeatLocation(row, 0); }
+        }
+
+        return SeatLocation(0, 0);
+    }
+
+    SeatClaimBoard::SeatClaimBoard(const SeatingPlan &plan)
+        : m_layout { plan.layout() },
+          m_states { std::make_unique<std::atomic<std::uint8_t>[]>(m_layout.seats()) },
+          m_claimants(m_layout.seats()),
+          m_claim_count { 0 }
+    {
+        // Each seat holds at most one passport ID, thus the table was at most half full.
+        size_t capacity = 2;
+        while (capacity < (m_layout.seats() * 2)) { capacity *= 2; }
+        m_passports = std::make_unique<PassportSlot[]>(capacity);
+        m_passport_mask = capacity - 1;
+
+        for (size_t row = 0; row < m_layout.rows(); row++)
+        {
+            const auto vacant = plan.vacant_bits(row);
+            const auto occupied = plan.occupied_bits(row);
+            for (size_t column = 0; column < m_layout.columns(); column++)
+            {
+                const auto state = ((vacant >> column) & 1) ? kVacant : kUnavailable;
+                m_states[m_layout.index_of(row, column)].store(state, std::memory_order_relaxed);
+
+                // The assigned passengers could not claim another seat.
+                if ((occupied >> column) & 1) { this->insert_passport(plan.at(row, column)->passport_key()); }
+            }
+        }
+    }
+
+    bool SeatClaimBoard::try_claim(const SeatLocation &location, const Passenger &passenger)
+    {
+        const auto index = m_layout.index_of(location.row(), location.column());
+        auto &state = m_states[index];
+
+        // Checks before claiming, so the losers of a hot seat would not contend on it.
+        if (state.load(std::memory_order_relaxed) != kVacant) { return false; }
+
+        auto expected = std::uint8_t(kVacant);
+        if (!state.compare_exchange_strong(expected, kClaiming, std::memory_order_acquire, std::memory_order_relaxed))
+        {
+            return false;
+        }
+
+        // Only the winners of a seat take a passport slot, so a lost seat never holds a passenger.
+        if (!this->insert_passport(passenger.passport_key()))
+        {
+            state.store(kVacant, std::memory_order_release);
+            return false;
+        }
+
+        m_claimants[index] = passenger;
+        state.store(kClaimed, std::memory_order_release);
+        m_claim_count.fetch_add(1, std::memory_order_release);
+
+        return true;
+    }
+
+    optional<Passenger> SeatClaimBoard::claimant(const SeatLocation &location) const
+    {
+        const auto index = m_layout.index_of(location.row(), location.column());
+        const auto state = m_states[index].load(std::memory_order_acquire);
+        if ((state != kClaimed) && (state != kCommitting))
+        {
+            return std::nullopt;
+        }
+
+        return m_claimants[index];
+    }
+
+    void SeatClaimBoard::commit(SeatingPlan &plan)
+    {
+        // Takes each claimed seat in a single pass, the seats claimed afterwards were left claimed.
+        std::vector<size_t> committing;
+        auto transaction = plan.begin();
+        for (size_t index = 0; index < m_layout.seats(); index++)
+        {
+            auto expected = std::uint8_t(kClaimed);
+            if (m_states[index].compare_exchange_strong(expected, kCommitting, std::memory_order_acquire, std::memory_order_relaxed))
+            {
+                committing.push_back(index);
+                transaction.assign(SeatLocation(index / m_layout.columns(), index % m_layout.columns()), *m_claimants[index]);
+            }
+        }
+
+        try
+        {
+            transaction.commit();
+        }
+        catch (...)
+        {
+            for (const auto index : committing) { m_states[index].store(kClaimed, std::memory_order_release); }
+            throw;
+        }
+
+        // The committed seats were no longer vacant, and their passengers stay in the passport table.
+        for (const auto index : committing)
+        {
+            m_claimants[index] = std::nullopt;
+            m_states[index].store(kUnavailable, std::memory_order_release);
+        }
+
+        m_claim_count.fetch_sub(committing.size(), std::memory_order_release);
+    }
+
+    bool SeatClaimBoard::insert_passport(const PassportId &passport_id)
+    {
+        for (auto slot = PassportIdHash()(passport_id) & m_passport_mask; ; slot = (slot + 1) & m_passport_mask)
+        {
+            auto &entry = m_passports[slot];
+
+            auto state = entry.state.load(std::memory_order_acquire);
+            if (state == kEmptySlot)
+            {
+                if (entry.state.compare_exchange_strong(state, kWritingSlot, std::memory_order_acquire, std::memory_order_acquire))
+                {
+                    entry.passport_id = passport_id;
+                    entry.state.store(kReadySlot, std::memory_order_release);
+                    return true;
+                }
+            }
+
+            // Waits for the slot that was being written by another claimant.
+            while (state == kWritingSlot) { state = entry.state.load(std::memory_order_acquire); }
+
+            if (entry.passport_id == passport_id) { return false; }
+        }
+    }
+
+    size_t FlightKeyHash::operator()(const FlightKey &key) const noexcept
+    {
+        const auto hash = std::hash<string>();
+        return (hash(key.flight_number) ^ (hash(key.date) * 31));
+    }
+
+    Flight::Flight(const FlightKey &key, std::pmr::memory_resource *resource)
+        : m_key { key },
+          m_pool(resource),
+          m_snapshot_pool { std::make_shared<LockedPoolResource>(resource) },
+          m_seating_plan(&m_pool, m_snapshot_pool) {}
+
+    FlightRegistry::FlightRegistry(size_t shard_count)
+    {
+        for (size_t i = 0; i < std::max<size_t>(shard_count, 1); i++)
+        {
+            m_shards.push_back(std::make_unique<Shard>());
+        }
+    }
+
+    void FlightRegistry::set_loader(Loader loader)
+    {
+        m_loader = std::move(loader);
+    }
+
+    void FlightRegistry::set_prober(Prober prober)
+    {
+        m_prober = std::move(prober);
+    }
+
+    void FlightRegistry::set_unloader(Unloader unloader)
+    {
+        m_unloader = std::move(unloader);
+    }
+
+    std::shared_ptr<Flight> FlightRegistry::open(const FlightKey &key)
+    {
+        auto &shard = shard_of(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        const auto entry = shard.flights.find(key);
+        if (entry != shard.flights.end()) { return entry->second; }
+
+        auto flight = load(shard, key);
+        if (!flight)
+        {
+            // Allocates both the flight and its seating plan from the pool of the shard.
+            flight = std::allocate_shared<Flight>(std::pmr::polymorphic_allocator<Flight>(&shard.pool), key, &shard.pool);
+            shard.closed_flights.erase(key);
+        }
+
+        shard.flights.emplace(key, flight);
+        return flight;
+    }
+
+    std::shared_ptr<Flight> FlightRegistry::find(const FlightKey &key) const
+    {
+        auto &shard = shard_of(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        const auto entry = shard.flights.find(key);
+        if (entry != shard.flights.end()) { return entry->second; }
+
+        auto flight = load(shard, key);
+        if (flight) { shard.flights.emplace(key, flight); }
+
+        return flight;
+    }
+
+    bool FlightRegistry::close(const FlightKey &key)
+    {
+        std::shared_ptr<Flight> flight;
+        auto closed = false;
+        {
+            auto &shard = shard_of(key);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+
+            const auto entry = shard.flights.find(key);
+            if (entry != shard.flights.end())
+            {
+                flight = std::move(entry->second);
+                shard.flights.erase(entry);
+                closed = true;
+            }
+            else if (m_prober && (shard.closed_flights.count(key) == 0))
+            {
+                // A flight that was never loaded was closed as well, if it exists in the backing
+                // store, which was only probed rather than loaded.
+                closed = m_prober(key);
+            }
+
+            // Remembers the closed flights, so the copies in the backing store were not loaded again.
+            if (m_loader) { shard.closed_flights.insert(key); }
+        }
+
+        if (flight && m_unloader)
+        {
+            flight->modify([&](SeatingPlan &plan) { m_unloader(key, plan); });
+        }
+
+        return closed;
+    }
+
+    bool FlightRegistry::is_closed(const FlightKey &key) const
+    {
+        const auto &shard = shard_of(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        return (shard.closed_flights.count(key) > 0);
+    }
+
+    bool FlightRegistry::is_loaded(const FlightKey &key) const
+    {
+        const auto &shard = shard_of(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        return (shard.flights.count(key) > 0);
+    }
+
+    std::shared_ptr<Flight> FlightRegistry::load(Shard &shard, const FlightKey &key) const
+    {
+        if (!m_loader || (shard.closed_flights.count(key) > 0)) { return nullptr; }
+
+        auto flight = std::allocate_shared<Flight>(std::pmr::polymorphic_allocator<Flight>(&shard.pool), key, &shard.pool);
+        const auto exists = flight->modify([&](SeatingPlan &plan) { return m_loader(key, plan); });
+
+        return exists ? flight : nullptr;
+    }
+
+    size_t FlightRegistry::size() const
+    {
+        size_t size = 0;
+        for (const auto &shard : m_shards)
+        {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            size += shard->flights.size();
+        }
+
+        return size;
+    }
+
+    std::vector<std::shared_ptr<Flight>> FlightRegistry::flights() const
+    {
+        std::vector<std::shared_ptr<Flight>> flights;
+        for (const auto &shard : m_shards)
+        {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            for (const auto &[key, flight] : shard->flights)
+            {
+                flights.push_back(flight);
+            }
+        }
+
+        return flights;
+    }
+
+    FlightRegistry::Shard& FlightRegistry::shard_of(const FlightKey &key) const
+    {
+        return *m_shards[FlightKeyHash()(key) % m_shards.size()];
+    }
+
+    namespace
+    {
+        /**
+         * Interns the names of the passengers, so each distinct name was stored once while any
+         * passenger with the name was alive, and the passengers only hold a reference to it.
+         **/
+        class NameTable
+        {
+            public:
+                /**
+                 * Returns the interned copy of a name, with a reference added.
+                 *
+                 * @param name The name.
+                 **/
+                InternedName* intern(string_view name)
+                {
+                    auto &shard = shard_of(name);
+                    const std::lock_guard<std::mutex> lock(shard.mutex);
+
+                    const auto entry = shard.names.find(name);
+                    if (entry != shard.names.end())
+                    {
+                        // The last reference could only be released under the lock, which also
+                        // erases the entry, thus the entry was still alive.
+                        entry->second->references.fetch_add(1, std::memory_order_relaxed);
+                        return entry->second;
+                    }
+
+                    // The name was copied right after the entry, within one block of the pool.
+                    const auto memory = static_cast<char*>(shard.pool.allocate(sizeof(InternedName) + name.size(), alignof(InternedName)));
+                    const auto data = memory + sizeof(InternedName);
+                    std::copy(name.begin(), name.end(), data);
+
+                    const auto interned = new (memory) InternedName { string_view(data, name.size()), { 1 } };
+                    try
+                    {
+                        shard.names.emplace(interned->value, interned);
+                    }
+                    catch (...)
+                    {
+                        shard.pool.deallocate(memory, sizeof(InternedName) + name.size(), alignof(InternedName));
+                        throw;
+                    }
+
+                    return interned;
+                }
+
+                /**
+                 * Adds a reference to an interned name, which must already have one.
+                 *
+                 * @param name The interned name.
+                 **/
+                static void retain(InternedName *name) noexcept
+                {
+                    name->references.fetch_add(1, std::memory_order_relaxed);
+                }
+
+                /**
+                 * Releases a reference to an interned name, which was erased after the last one.
+                 *
+                 * @param name The interned name.
+                 **/
+                void release(InternedName *name) noexcept
+                {
+                    // Releases without the lock unless it might be the last reference.
+                    auto references = name->references.load(std::memory_order_relaxed);
+                    while (references > 1)
+                    {
+                        if (name->references.compare_exchange_weak(references, references - 1, std::memory_order_release, std::memory_order_relaxed)) { return; }
+                    }
+
+                    auto &shard = shard_of(name->value);
+                    const std::lock_guard<std::mutex> lock(shard.mutex);
+
+                    if (name->references.fetch_sub(1, std::memory_order_acq_rel) != 1) { return; }
+
+                    const auto size = name->value.size();
+                    shard.names.erase(name->value);
+                    name->~InternedName();
+                    shard.pool.deallocate(name, sizeof(InternedName) + size, alignof(InternedName));
+                }
+
+                /**
+                 * Returns the number of distinct names that were interned.
+                 **/
+                size_t size()
+                {
+                    size_t count = 0;
+                    for (auto &shard : m_shards)
+                    {
+                        const std::lock_guard<std::mutex> lock(shard.mutex);
+                        count += shard.names.size();
+                    }
+
+                    return count;
+                }
+
+                /**
+                 * Returns the table shared by the program, which was never destroyed, so the names
+                 * stay valid during the destruction of the static objects.
+                 **/
+                static NameTable& shared()
+                {
+                    static auto *const table = new NameTable();
+                    return *table;
+                }
+
+            private:
+                /**
+                 * The number of shards, each with its own lock.
+                 **/
+                static constexpr size_t kShardCount = 16;
+
+                /**
+                 * A shard of the table. The names were allocated from the pool of the shard, thus the
+                 * blocks of the released names were recycled by the new ones.
+                 **/
+                struct Shard
+                {
+                    std::mutex mutex;
+                    std::pmr::unsynchronized_pool_resource pool;
+                    std::pmr::unordered_map<string_view, InternedName*> names { &pool };
+                };
+
+                /**
+                 * The shards of the table.
+                 **/
+                std::array<Shard, kShardCount> m_shards;
+
+                /**
+                 * Returns the shard of a name.
+                 *
+                 * @param name The name.
+                 **/
+                Shard& shard_of(string_view name) { return m_shards[std::hash<string_view>()(name) % kShardCount]; }
+        };
+    }
+
+    PassportId::PassportId(string_view value)
+        : m_value {}, m_length { static_cast<std::uint8_t>(value.size()) }
+    {
+        if (value.size() > kMaxLength)
+        {
+            throw std::length_error("The passport ID must not be longer than " + std::to_string(kMaxLength) + " characters.");
+        }
+
+        std::copy(value.begin(), value.end(), m_value.begin());
+    }
+
+    Passenger::Passenger(string_view name, string_view passport_id)
+        : m_name { nullptr }, m_passport_id { passport_id }
+    {
+        // Interns the name after the passport ID was validated, which might throw.
+        m_name = NameTable::shared().intern(name);
+    }
+
+    Passenger::Passenger(const Passenger &other) noexcept
+        : m_name { other.m_name }, m_passport_id { other.m_passport_id }
+    {
+        NameTable::retain(m_name);
+    }
+
+    Passenger& Passenger::operator =(const Passenger &other) noexcept
+    {
+        // Retains the other name first, in case both names were the same.
+        NameTable::retain(other.m_name);
+        NameTable::shared().release(m_name);
+
+        m_name = other.m_name;
+        m_passport_id = other.m_passport_id;
+        return *this;
+    }
+
+    Passenger::~Passenger()
+    {
+        NameTable::shared().release(m_name);
+    }
+
+    size_t Passenger::interned_names()
+    {
+        return NameTable::shared().size();
+    }
+
+    bool Passenger::equals(const Passenger &other) const
+    {
+        // The interned names were equal only if they were the same copy.
+        return ((m_name == other.m_name) && (m_passport_id == other.m_passport_id));
+    }
+
+    namespace
+    {
+        /**
+         * Builds the error message for an out-of-range row or column.
+         *
+         * @param name The name of the dimension.
+         * @param max  The number of rows or columns.
+         **/
+        string range_error_message(const string &name, size_t max)
+        {
+            return ("The range of the " + name + " must between 0 (inclusive) and " + std::to_string(max) + " (exclusive).");
+        }
+
+        /**
+         * The layout that was activated.
+         **/
+        struct ActiveLayout
+        {
+            /**
+             * The owner of the layout, which must be accessed atomically.
+             **/
+            std::shared_ptr<const CabinLayout> owner;
+
+            /**
+             * The layout, cached for the readers that do not share its ownership.
+             **/
+            std::atomic<const CabinLayout*> layout;
+        };
+
+        /**
+         * Returns the layout that was activated.
+         **/
+        ActiveLayout& active_layout()
+        {
+            // Constructed on first use, since the global seating plan requires it during the static
+            // initialization.
+            static auto active = []()
+            {
+                auto owner = std::make_shared<const CabinLayout>();
+                const auto layout = owner.get();
+                return ActiveLayout { std::move(owner), { layout } };
+            }();
+
+            return active;
+        }
+    }
+
+    std::shared_ptr<const CabinLayout> CabinLayout::active()
+    {
+        return std::atomic_load(&active_layout().owner);
+    }
+
+    const CabinLayout& CabinLayout::current() noexcept
+    {
+        return *active_layout().layout.load(std::memory_order_acquire);
+    }
+
+    void CabinLayout::activate(const CabinLayout &layout)
+    {
+        auto &active = active_layout();
+        auto owner = std::make_shared<const CabinLayout>(layout);
+
+        active.layout.store(owner.get(), std::memory_order_release);
+        std::atomic_store(&active.owner, std::shared_ptr<const CabinLayout>(std::move(owner)));
+    }
+
+    CabinLayout CabinLayout::load(std::istream &input)
+    {
+        using exceptions::MalformedInputError;
+
+        optional<size_t> rows;
+        optional<string> columns;
+        std::vector<std::pair<TicketClass, string>> bands;
+        std::vector<string> blocked_seats;
+
+        string line;
+        size_t line_number = 0;
+        while (std::getline(input, line))
+        {
+            line_number++;
+
+            /** The line without the comment. */
+            const auto content = stringutil::trim(line.substr(0, line.find('#')));
+            if (content.empty()) { continue; }
+
+            const auto separator = content.find('=');
+            if (separator == string::npos)
+            {
+                throw MalformedInputError("Line " + std::to_string(line_number) + R"( of the cabin layout should be formatted as "<key> = <value>".)");
+            }
+
+            const auto key = stringutil::trim(content.substr(0, separator));
+            const auto value = stringutil::trim(content.substr(separator + 1));
+
+            if (key == "rows")
+            {
+                if (value.empty() || (value.size() > 4) || (value.find_first_not_of("0123456789") != string::npos) || (std::stoul(value) == 0))
+                {
+                    throw MalformedInputError("The number of rows of the cabin layout must be a positive integer.");
+                }
+
+                rows = std::stoul(value);
+            }
+            else if (key == "columns")
+            {
+                columns = stringutil::to_uppercase(value);
+            }
+            else if (key == "first")
+            {
+                bands.emplace_back(TicketClass::kFirst, value);
+            }
+            else if (key == "business")
+            {
+                bands.emplace_back(TicketClass::kBusiness, value);
+            }
+            else if (key == "economy")
+            {
+                bands.emplace_back(TicketClass::kEconomy, value);
+            }
+            else if (key == "blocked")
+            {
+                for (const auto &seat : stringutil::split(value, " "))
+                {
+                    if (!seat.empty()) { blocked_seats.push_back(stringutil::to_uppercase(seat)); }
+                }
+            }
+            else
+            {
+                throw MalformedInputError("Unknown key \"" + key + "\" at line " + std::to_string(line_number) + " of the cabin layout.");
+            }
+        }
+
+        if (!rows || !columns)
+        {
+            throw MalformedInputError("The cabin layout must specify both the rows and the columns.");
+        }
+
+        auto layout = CabinLayout(*rows, *columns);
+
+        /**
+         * Parses a row of a band, which must consist of the digits only.
+         *
+         * @param bound The row.
+         **/
+        const auto parse_row = [](const string &bound)
+        {
+            const auto digits = stringutil::trim(bound);
+            const auto end = digits.data() + digits.size();
+
+            size_t row = 0;
+            const auto [last, error] = std::from_chars(digits.data(), end, row);
+            if (digits.empty() || (error != std::errc()) || (last != end)) { throw std::invalid_argument(bound); }
+
+            return row;
+        };
+
+        for (const auto &[ticket_class, range] : bands)
+        {
+            // Each band was formatted as "<first row>-<last row>" or "<row>", both are 1-based.
+            const auto bounds = stringutil::split(range, "-");
+            try
+            {
+                if (bounds.size() > 2) { throw std::invalid_argument(range); }
+
+                const auto first_row = parse_row(bounds.front());
+                const auto last_row = parse_row(bounds.back());
+                if ((first_row == 0) || (first_row > last_row) || (last_row > *rows)) { throw std::out_of_range(range); }
+
+                layout.set_ticket_class(first_row - 1, last_row - 1, ticket_class);
+            }
+            catch (const std::logic_error &e)
+            {
+                throw MalformedInputError("The " + to_string(ticket_class) + " class rows \"" + range + "\" of the cabin layout were not valid.");
+            }
+        }
+
+        for (const auto &seat : blocked_seats)
+        {
+            // Each blocked seat was formatted as a seat location, e.g. "10D".
+            const auto column = seat.empty() ? std::nullopt : layout.column_of(seat.back());
+            const auto row = seat.substr(0, seat.empty() ? 0 : (seat.size() - 1));
+            if (!column || row.empty() || (row.size() > 4) || (row.find_first_not_of("0123456789") != string::npos)
+                || (std::stoul(row) == 0) || (std::stoul(row) > *rows))
+            {
+                throw MalformedInputError("The blocked seat \"" + seat + "\" of the cabin layout was not valid.");
+            }
+
+            layout.block(std::stoul(row) - 1, *column);
+        }
+
+        return layout;
+    }
+
+    CabinLayout CabinLayout::load(const string &path)
+    {
+        std::ifstream input(path);
+        if (!input)
+        {
+            throw std::runtime_error("Unable to open the cabin layout \"" + path + "\".");
+        }
+
+        return load(input);
+    }
+
+    CabinLayout::CabinLayout() : CabinLayout(13, "ABCDEF")
+    {
+        set_ticket_class(0, 1, TicketClass::kFirst);
+        set_ticket_class(2, 6, TicketClass::kBusiness);
+    }
+
+    CabinLayout::CabinLayout(size_t rows, const string &columns)
+        : m_rows { rows }
+    {
+        using exceptions::MalformedInputError;
+
+        for (const auto letter : columns)
+        {
+            if (letter == ' ')
+            {
+                // An aisle after the previous column.
+                if (!m_aisles.empty()) { m_aisles.back() = true; }
+                continue;
+            }
+
+            if ((letter < 'A') || (letter > 'Z') || (m_column_letters.find(letter) != string::npos))
+            {
+                throw MalformedInputError("The columns of the cabin layout must be distinct uppercased letters.");
+            }
+
+            m_column_letters.push_back(letter);
+            m_aisles.push_back(false);
+        }
+
+        if ((m_rows == 0) || m_column_letters.empty())
+        {
+            throw MalformedInputError("The cabin layout must contain at least one seat.");
+        }
+
+        // The aisle after the last column was meaningless.
+        m_aisles.back() = false;
+
+        m_adjacent = 0;
+        for (size_t column = 0; (column + 1) < m_column_letters.size(); column++)
+        {
+            if (!m_aisles[column]) { m_adjacent |= (std::uint64_t(1) << column); }
+        }
+
+        m_row_classes.assign(m_rows, TicketClass::kEconomy);
+        m_blocked.assign(m_rows, 0);
+    }
+
+    optional<size_t> CabinLayout::column_of(char letter) const
+    {
+        const auto column = m_column_letters.find(letter);
+        if (column == string::npos)
+        {
+            return std::nullopt;
+        }
+
+        return column;
+    }
+
+    void CabinLayout::set_ticket_class(size_t first_row, size_t last_row, TicketClass ticket_class)
+    {
+        if ((first_row > last_row) || (last_row >= m_rows))
+        {
+            throw range_error(range_error_message("row", m_rows));
+        }
+
+        std::fill(m_row_classes.begin() + first_row, m_row_classes.begin() + last_row + 1, ticket_class);
+    }
+
+    bool CabinLayout::is_blocked(size_t row, size_t column) const
+    {
+        // Validates the location of the seat.
+        index_of(row, column);
+
+        return ((m_blocked[row] >> column) & 1);
+    }
+
+    bool CabinLayout::has_blocked_seats() const
+    {
+        return std::any_of(m_blocked.begin(), m_blocked.end(), [](std::uint64_t bits) { return (bits != 0); });
+    }
+
+    void CabinLayout::block(size_t row, size_t column)
+    {
+        // Validates the location of the seat.
+        index_of(row, column);
+
+        m_blocked[row] |= (std::uint64_t(1) << column);
+    }
+
+    size_t CabinLayout::index_of(size_t row, size_t column) const
+    {
+        if (row >= m_rows)
+        {
+            throw range_error(range_error_message("row", m_rows));
+        }
+        else if (column >= m_column_letters.size())
+        {
+            throw range_error(range_error_message("column", m_column_letters.size()));
+        }
+
+        return ((row * m_column_letters.size()) + column);
+    }
+
+    string SeatLocation::row_to_string(size_t row)
+    {
+        const auto rows = CabinLayout::current().rows();
+        if (row >= rows)
+        {
+            throw range_error(range_error_message("row", rows));
+        }
+
+        return std::to_string(row + 1);
+    }
+
+    string SeatLocation::column_to_string(size_t column)
+    {
+        const auto &layout = CabinLayout::current();
+        if (column >= layout.columns())
+        {
+            throw range_error(range_error_message("column", layout.columns()));
+        }
+
+        return string(1, layout.column_letter(column));
+    }
+
+    SeatLocation::SeatLocation(size_t row, size_t column)
+        : m_row { row }, m_column { column }
+    {
+        // Validates the location against the active layout.
+        CabinLayout::current().index_of(row, column);
+    }
+
+    TicketClass SeatLocation::ticket_class() const
+    {
+        return CabinLayout::current().ticket_class(m_row);
+    }
+
+    bool SeatLocation::equals(const SeatLocation& other) const
+    {
+        return ((m_row == other.m_row) && (m_column == other.m_column));
+    }
+
+    bool SeatLocation::less_than(const SeatLocation &other) const
+    {
+        return ((m_row < other.m_row) || ((m_row == other.m_row) && (m_column < other.m_column)));
+    }
+
+    string SeatLocation::to_string() const
+    {
+        return (row_to_string(m_row) + column_to_string(m_column));
+    }
+
+    std::ostream& operator<<(std::ostream& os, const SeatLocation& location)
+    {
+        os << location.to_string();
+        return os;
+    }
+
+    string to_string(TicketClass ticket_class) noexcept
+    {
+        switch (ticket_class)
+        {
+            case TicketClass::kFirst:
+                return "First";
+            case TicketClass::kBusiness:
+                return "Business";
+            case TicketClass::kEconomy:
+                return "Economy";
+        }
+    }
+}
+
+namespace jetassign::exceptions
+{
+
+}
@@ -0,0 +1,737 @@
+/**
+ * Copyright (c) 2021 Jason Kwok, Ben Ho, Ben Yip, Harry Lam, and Hins To.
+ *
+ * Licensed under the GNU Affero General Public License, Version 3.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of the License at
+ *
+ *     https://github.com/JasonHK-HKCC/SEHH2042-Group-Project/blob/master/LICENSE
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under the License
+ * is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ * or implied. See the License for the specific language governing permissions and limitations under
+ * the License.
+ **/
+
+#include "jetassign/database.hpp"
+#include "jetassign/exceptions.hpp"
+#include "jetassign/stringutil.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <filesystem>
+#include <set>
+#include <tuple>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace jetassign::storage
+{
+    using std::uint8_t;
+    using std::uint16_t;
+    using std::uint32_t;
+    using std::uint64_t;
+
+    using core::FlightKey;
+    using core::FlightRegistry;
+    using core::Passenger;
+    using core::PassportId;
+    using core::SeatingPlan;
+    using core::SeatLocation;
+
+    using exceptions::StorageError;
+
+    namespace
+    {
+        /**
+         * The magic of a flight database.
+         **/
+        constexpr char kDatabaseMagic[4] = { 'J', 'A', 'S', 'D' };
+
+        /**
+         * The sizes of the header, a directory entry, a seat record and a name table entry.
+         **/
+        constexpr size_t kHeaderSize = 48;
+        constexpr size_t kEntrySize = 32;
+        constexpr size_t kRecordSize = 24;
+        constexpr size_t kNameEntrySize = 16;
+
+        /**
+         * The size of the header of the databases of version 1, which have no name table.
+         **/
+        constexpr size_t kHeaderSizeV1 = 32;
+
+        /**
+         * The maximum length of a passport ID in a seat record.
+         **/
+        constexpr size_t kRecordPassportIdSize = 16;
+
+        uint16_t load_u16(const char *data)
+        {
+            const auto bytes = reinterpret_cast<const unsigned char*>(data);
+            return static_cast<uint16_t>(bytes[0] | (bytes[1] << 8));
+        }
+
+        uint32_t load_u32(const char *data)
+        {
+            return (uint32_t(load_u16(data)) | (uint32_t(load_u16(data + 2)) << 16));
+        }
+
+        uint64_t load_u64(const char *data)
+        {
+            return (uint64_t(load_u32(data)) | (uint64_t(load_u32(data + 4)) << 32));
+        }
+
+        void store_u16(string &output, uint16_t value)
+        {
+            output.push_back(static_cast<char>(value & 0xFF));
+            output.push_back(static_cast<char>((value >> 8) & 0xFF));
+        }
+
+        void store_u32(string &output, uint32_t value)
+        {
+            store_u16(output, static_cast<uint16_t>(value & 0xFFFF));
+            store_u16(output, static_cast<uint16_t>(value >> 16));
+        }
+
+        void store_u64(string &output, uint64_t value)
+        {
+            store_u32(output, static_cast<uint32_t>(value & 0xFFFFFFFF));
+            store_u32(output, static_cast<uint32_t>(value >> 32));
+        }
+
+        [[noreturn]] void throw_corrupted()
+        {
+            throw StorageError("The flight database was corrupted.");
+        }
+
+        /**
+         * Returns the part of a region, or throws if it was outside the region.
+         *
+         * @param region The region.
+         * @param offset The offset of the part.
+         * @param size   The size of the part.
+         **/
+        string_view slice(string_view region, uint64_t offset, uint64_t size)
+        {
+            if ((offset > region.size()) || (size > (region.size() - offset))) { throw_corrupted(); }
+            return region.substr(offset, size);
+        }
+
+        /**
+         * A seating plan to be saved, either from the registry or from the previous database.
+         **/
+        struct PendingFlight
+        {
+            FlightKey key;
+
+            size_t rows;
+
+            size_t columns;
+
+            /**
+             * The occupied bits of each row.
+             **/
+            std::vector<uint64_t> occupied;
+
+            /**
+             * The passengers by their seat index, which refer to the snapshot or the mapping.
+             **/
+            std::vector<std::pair<size_t, MappedPassenger>> passengers;
+
+            /**
+             * Keeps the passengers of a seating plan alive while saving.
+             **/
+            std::shared_ptr<const SeatingPlan::Snapshot> snapshot;
+        };
+
+        PendingFlight pending_flight_of(const FlightKey &key, std::shared_ptr<const SeatingPlan::Snapshot> snapshot)
+        {
+            const auto &layout = snapshot->layout();
+
+            auto flight = PendingFlight { key, layout.rows(), layout.columns(), {}, {}, nullptr };
+            for (size_t row = 0; row < layout.rows(); row++)
+            {
+                const auto occupied = snapshot->occupied_bits(row);
+                flight.occupied.push_back(occupied);
+
+                for (size_t column = 0; column < layout.columns(); column++)
+                {
+                    if (!((occupied >> column) & 1)) { continue; }
+
+                    const auto &passenger = *snapshot->at(SeatLocation(row, column));
+                    flight.passengers.emplace_back(layout.index_of(row, column), MappedPassenger { passenger.name(), passenger.passport_id() });
+                }
+            }
+
+            flight.snapshot = std::move(snapshot);
+            return flight;
+        }
+
+        PendingFlight pending_flight_of(const MappedFlight &mapped)
+        {
+            auto flight = PendingFlight { mapped.key(), mapped.rows(), mapped.columns(), {}, {}, nullptr };
+            for (size_t row = 0; row < mapped.rows(); row++)
+            {
+                const auto occupied = mapped.occupied_bits(row);
+                flight.occupied.push_back(occupied);
+
+                for (size_t column = 0; column < mapped.columns(); column++)
+                {
+                    if ((occupied >> column) & 1)
+                    {
+                        flight.passengers.emplace_back((row * mapped.columns()) + column, *mapped.at(row, column));
+                    }
+                }
+            }
+
+            return flight;
+        }
+
+        /**
+         * Collects the strings of a database, storing each distinct string once.
+         **/
+        class HeapWriter
+        {
+            public:
+                /**
+                 * Appends a string to the heap, returns its offset.
+                 *
+                 * @param value     The string.
+                 * @param deduplicate Whether to reuse an equal string in the heap.
+                 **/
+                uint32_t append(string_view value, bool deduplicate = true)
+                {
+                    if (deduplicate)
+                    {
+                        const auto entry = m_offsets.find(value);
+                        if (entry != m_offsets.end()) { return entry->second; }
+                    }
+
+                    if ((m_heap.size() + value.size()) > UINT32_MAX)
+                    {
+                        throw StorageError("The flight database was too large to be saved.");
+                    }
+
+                    const auto offset = static_cast<uint32_t>(m_heap.size());
+                    m_heap.append(value);
+
+                    if (deduplicate) { m_offsets.emplace(value, offset); }
+                    return offset;
+                }
+
+                const string& heap() const { return m_heap; }
+
+            private:
+                string m_heap;
+
+                std::unordered_map<string_view, uint32_t> m_offsets;
+        };
+
+        /**
+         * Serializes the seating plans into a flight database.
+         **/
+        string write_database(std::vector<PendingFlight> &pending, uint32_t generation)
+        {
+            std::sort(pending.begin(), pending.end(), [](const PendingFlight &a, const PendingFlight &b)
+            {
+                return std::tie(a.key.flight_number, a.key.date) < std::tie(b.key.flight_number, b.key.date);
+            });
+
+            string directory;
+            string flights;
+            HeapWriter heap;
+
+            /** The normalized name, the position of the flight and the seat index of each passenger. */
+            std::vector<std::tuple<string, uint32_t, uint32_t>> names;
+
+            const auto flights_offset = kHeaderSize + (pending.size() * kEntrySize);
+
+            for (size_t position = 0; position < pending.size(); position++)
+            {
+                const auto &flight = pending[position];
+
+                if ((flight.key.flight_number.size() > UINT16_MAX) || (flight.key.date.size() > UINT16_MAX))
+                {
+                    throw StorageError("The string was too long to be saved.");
+                }
+
+                // The flight number was followed by the date in the heap.
+                const auto key_offset = heap.append(flight.key.flight_number, false);
+                heap.append(flight.key.date, false);
+
+                store_u32(directory, key_offset);
+                store_u16(directory, static_cast<uint16_t>(flight.key.flight_number.size()));
+                store_u16(directory, static_cast<uint16_t>(flight.key.date.size()));
+                store_u32(directory, static_cast<uint32_t>(flight.rows));
+                store_u32(directory, static_cast<uint32_t>(flight.columns));
+                store_u64(directory, flights_offset + flights.size());
+                store_u32(directory, static_cast<uint32_t>(flight.passengers.size()));
+                store_u32(directory, 0);
+
+                for (const auto occupied : flight.occupied) { store_u64(flights, occupied); }
+
+                // The vacant seats were left as zeros.
+                const auto records = flights.size();
+                flights.resize(records + (flight.rows * flight.columns * kRecordSize), '\0');
+
+                for (const auto &[index, passenger] : flight.passengers)
+                {
+                    if ((passenger.name.size() > UINT16_MAX) || (passenger.passport_id.size() >= kRecordPassportIdSize))
+                    {
+                        throw StorageError("The passenger was too long to be saved.");
+                    }
+
+                    string record;
+                    store_u32(record, heap.append(passenger.name));
+                    store_u16(record, static_cast<uint16_t>(passenger.name.size()));
+                    record.push_back(static_cast<char>(passenger.passport_id.size()));
+                    record.push_back('\0');
+                    record.append(passenger.passport_id);
+
+                    std::copy(record.begin(), record.end(), flights.begin() + records + (index * kRecordSize));
+
+                    names.emplace_back(stringutil::fold(passenger.name), static_cast<uint32_t>(position), static_cast<uint32_t>(index));
+                }
+            }
+
+            // The normalized names were added to the heap after sorting, which must not move them.
+            std::sort(names.begin(), names.end());
+
+            string name_table;
+            name_table.reserve(names.size() * kNameEntrySize);
+            for (const auto &[name, position, index] : names)
+            {
+                store_u32(name_table, heap.append(name));
+                store_u16(name_table, static_cast<uint16_t>(name.size()));
+                store_u16(name_table, 0);
+                store_u32(name_table, position);
+                store_u32(name_table, index);
+            }
+
+            const auto names_offset = flights_offset + flights.size();
+
+            string database;
+            database.reserve(names_offset + name_table.size() + heap.heap().size());
+
+            database.append(kDatabaseMagic, sizeof(kDatabaseMagic));
+            store_u16(database, kDatabaseVersion);
+            store_u16(database, 0);
+            store_u32(database, generation);
+            store_u32(database, static_cast<uint32_t>(pending.size()));
+            store_u64(database, kHeaderSize);
+            store_u64(database, names_offset + name_table.size());
+            store_u64(database, names_offset);
+            store_u32(database, static_cast<uint32_t>(names.size()));
+            store_u32(database, 0);
+
+            database.append(directory);
+            database.append(flights);
+            database.append(name_table);
+            database.append(heap.heap());
+
+            return database;
+        }
+    }
+
+    struct FlightDatabase::Mapping
+    {
+        const char *data = nullptr;
+
+        size_t size = 0;
+
+#ifdef _WIN32
+        HANDLE file = INVALID_HANDLE_VALUE;
+
+        HANDLE mapping = nullptr;
+#endif
+
+        ~Mapping()
+        {
+#ifdef _WIN32
+            if (data != nullptr) { UnmapViewOfFile(data); }
+            if (mapping != nullptr) { CloseHandle(mapping); }
+            if (file != INVALID_HANDLE_VALUE) { CloseHandle(file); }
+#else
+            if (data != nullptr) { munmap(const_cast<char*>(data), size); }
+#endif
+        }
+    };
+
+    std::unique_ptr<FlightDatabase> FlightDatabase::open(const string &path)
+    {
+        auto mapping = std::make_unique<Mapping>();
+
+#ifdef _WIN32
+        mapping->file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+        if (mapping->file == INVALID_HANDLE_VALUE)
+        {
+            if (GetLastError() == ERROR_FILE_NOT_FOUND) { return nullptr; }
+            throw StorageError("Unable to open \"" + path + "\".");
+        }
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(mapping->file, &size)) { throw StorageError("Unable to open \"" + path + "\"."); }
+        mapping->size = static_cast<size_t>(size.QuadPart);
+
+        if (mapping->size >= kHeaderSizeV1)
+        {
+            mapping->mapping = CreateFileMappingA(mapping->file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            const auto view = (mapping->mapping != nullptr) ? MapViewOfFile(mapping->mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+            if (view == nullptr) { throw StorageError("Unable to map \"" + path + "\"."); }
+
+            mapping->data = static_cast<const char*>(view);
+        }
+#else
+        const auto fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            if (errno == ENOENT) { return nullptr; }
+            throw StorageError("Unable to open \"" + path + "\".");
+        }
+
+        struct stat status;
+        if (fstat(fd, &status) != 0)
+        {
+            ::close(fd);
+            throw StorageError("Unable to open \"" + path + "\".");
+        }
+        mapping->size = static_cast<size_t>(status.st_size);
+
+        if (mapping->size >= kHeaderSizeV1)
+        {
+            const auto view = mmap(nullptr, mapping->size, PROT_READ, MAP_SHARED, fd, 0);
+            if (view == MAP_FAILED)
+            {
+                ::close(fd);
+                throw StorageError("Unable to map \"" + path + "\".");
+            }
+
+            // Only the pages of the flights in use were read, rather than reading ahead.
+            madvise(view, mapping->size, MADV_RANDOM);
+            mapping->data = static_cast<const char*>(view);
+        }
+
+        ::close(fd);
+#endif
+
+        if (mapping->data == nullptr)
+        {
+            throw StorageError("The file was not a flight database of JetAssign.");
+        }
+
+        return std::unique_ptr<FlightDatabase>(new FlightDatabase(std::move(mapping)));
+    }
+
+    FlightDatabase::FlightDatabase(std::unique_ptr<Mapping> mapping)
+        : m_mapping { std::move(mapping) }, m_file(m_mapping->data, m_mapping->size)
+    {
+        // Only the header was validated, the flights were validated when they were used.
+        if (m_file.substr(0, sizeof(kDatabaseMagic)) != string_view(kDatabaseMagic, sizeof(kDatabaseMagic)))
+        {
+            throw StorageError("The file was not a flight database of JetAssign.");
+        }
+
+        const auto version = load_u16(m_file.data() + 4);
+        if ((version < 1) || (version > kDatabaseVersion) || ((version >= 2) && (m_file.size() < kHeaderSize)))
+        {
+            throw StorageError("The version of the flight database was not supported.");
+        }
+
+        m_generation = load_u32(m_file.data() + 8);
+        m_size = load_u32(m_file.data() + 12);
+
+        m_directory = slice(m_file, load_u64(m_file.data() + 16), uint64_t(m_size) * kEntrySize).data();
+
+        const auto heap_offset = load_u64(m_file.data() + 24);
+        m_heap = slice(m_file, heap_offset, m_file.size() - std::min<uint64_t>(heap_offset, m_file.size()));
+
+        m_names = nullptr;
+        m_names_size = 0;
+        if (version >= 2)
+        {
+            m_names_size = load_u32(m_file.data() + 40);
+            m_names = slice(m_file, load_u64(m_file.data() + 32), uint64_t(m_names_size) * kNameEntrySize).data();
+        }
+    }
+
+    FlightDatabase::~FlightDatabase() = default;
+
+    MappedFlight FlightDatabase::at(size_t index) const
+    {
+        if (index >= m_size) { throw std::out_of_range("The flight was not in the flight database."); }
+
+        const auto entry = m_directory + (index * kEntrySize);
+
+        const auto key_offset = load_u32(entry);
+        const auto flight_number = slice(m_heap, key_offset, load_u16(entry + 4));
+        const auto date = slice(m_heap, key_offset + flight_number.size(), load_u16(entry + 6));
+
+        const auto rows = load_u32(entry + 8);
+        const auto columns = load_u32(entry + 12);
+        if ((columns == 0) || (columns > 64)) { throw_corrupted(); }
+
+        const auto data = slice(m_file, load_u64(entry + 16), (uint64_t(rows) * 8) + (uint64_t(rows) * columns * kRecordSize));
+
+        return MappedFlight(m_heap, flight_number, date, rows, columns, load_u32(entry + 24), data.data());
+    }
+
+    optional<MappedFlight> FlightDatabase::find(const FlightKey &key) const
+    {
+        // Binary searches the directory, which was sorted by the flight number and date.
+        size_t first = 0;
+        size_t last = m_size;
+        while (first < last)
+        {
+            const auto middle = first + ((last - first) / 2);
+            const auto entry = m_directory + (middle * kEntrySize);
+
+            const auto key_offset = load_u32(entry);
+            const auto flight_number = slice(m_heap, key_offset, load_u16(entry + 4));
+            const auto date = slice(m_heap, key_offset + flight_number.size(), load_u16(entry + 6));
+
+            const auto order = (flight_number != key.flight_number)
+                ? flight_number.compare(key.flight_number)
+                : date.compare(key.date);
+
+            if (order == 0) { return at(middle); }
+
+            if (order < 0) { first = middle + 1; }
+            else { last = middle; }
+        }
+
+        return std::nullopt;
+    }
+
+    MappedName FlightDatabase::name_at(size_t index) const
+    {
+        if (index >= m_names_size) { throw std::out_of_range("The name was not in the flight database."); }
+
+        const auto entry = m_names + (index * kNameEntrySize);
+
+        const auto flight = load_u32(entry + 8);
+        if (flight >= m_size) { throw_corrupted(); }
+
+        return MappedName { slice(m_heap, load_u32(entry), load_u16(entry + 4)), flight, load_u32(entry + 12) };
+    }
+
+    size_t FlightDatabase::lower_bound_name(string_view normalized_name) const
+    {
+        // Binary searches the name table, which was sorted by the normalized names.
+        size_t first = 0;
+        size_t last = m_names_size;
+        while (first < last)
+        {
+            const auto middle = first + ((last - first) / 2);
+            const auto entry = m_names + (middle * kNameEntrySize);
+
+            if (slice(m_heap, load_u32(entry), load_u16(entry + 4)) < normalized_name) { first = middle + 1; }
+            else { last = middle; }
+        }
+
+        return first;
+    }
+
+    uint64_t MappedFlight::occupied_bits(size_t row) const
+    {
+        return (row < m_rows) ? load_u64(m_data + (row * 8)) : 0;
+    }
+
+    bool MappedFlight::is_occupied(size_t row, size_t column) const
+    {
+        return ((column < m_columns) && ((occupied_bits(row) >> column) & 1));
+    }
+
+    optional<MappedPassenger> MappedFlight::at(size_t row, size_t column) const
+    {
+        if (!is_occupied(row, column)) { return std::nullopt; }
+
+        const auto record = m_data + (m_rows * 8) + (((row * m_columns) + column) * kRecordSize);
+
+        const auto passport_id_length = static_cast<uint8_t>(record[6]);
+        if (passport_id_length >= kRecordPassportIdSize) { throw_corrupted(); }
+
+        return MappedPassenger { slice(m_heap, load_u32(record), load_u16(record + 4)), string_view(record + 8, passport_id_length) };
+    }
+
+    optional<SeatLocation> MappedFlight::location_of(string_view passport_id) const
+    {
+        for (size_t row = 0; row < m_rows; row++)
+        {
+            const auto occupied = occupied_bits(row);
+            for (size_t column = 0; column < m_columns; column++)
+            {
+                if (((occupied >> column) & 1) && (at(row, column)->passport_id == passport_id))
+                {
+                    return SeatLocation(row, column);
+                }
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    void MappedFlight::restore(SeatingPlan &plan) const
+    {
+        const auto &layout = plan.layout();
+        if ((m_rows != layout.rows()) || (m_columns != layout.columns()))
+        {
+            throw StorageError("The flight database was saved with a different cabin layout.");
+        }
+
+        // Publishes the restored seats at once.
+        const auto deferred_publication = SeatingPlan::DeferredPublication(plan);
+
+        for (size_t row = 0; row < m_rows; row++)
+        {
+            const auto occupied = occupied_bits(row);
+            for (size_t column = 0; column < m_columns; column++)
+            {
+                if (!((occupied >> column) & 1)) { continue; }
+
+                const auto passenger = *at(row, column);
+                try
+                {
+                    plan.assign(SeatLocation(row, column), Passenger(passenger.name, passenger.passport_id));
+                }
+                catch (const std::exception &e)
+                {
+                    throw StorageError("The flight database contains a seat that could not be restored: " + string(e.what()));
+                }
+            }
+        }
+    }
+
+    size_t save_database(const string &path, const SeatingPlan &seating_plan, const FlightRegistry &flights, std::unique_ptr<FlightDatabase> &database, uint32_t generation, Journal *journal)
+    {
+        std::vector<PendingFlight> pending;
+
+        // The seating plan of the console, without a flight number and date.
+        pending.push_back(pending_flight_of(FlightKey(), seating_plan.snapshot()));
+        if (journal != nullptr) { journal->capture(seating_plan); }
+
+        std::set<std::pair<string, string>> saved_keys;
+        for (const auto &flight : flights.flights())
+        {
+            auto snapshot = flight->read([journal](const SeatingPlan &plan)
+            {
+                if (journal != nullptr) { journal->capture(plan); }
+                return plan.snapshot();
+            });
+            pending.push_back(pending_flight_of(flight->key(), std::move(snapshot)));
+            saved_keys.emplace(flight->key().flight_number, flight->key().date);
+        }
+
+        if (database)
+        {
+            // Copies the flights that were never loaded from the previous database.
+            for (size_t i = 0; i < database->size(); i++)
+            {
+                const auto mapped = database->at(i);
+                if (mapped.flight_number().empty() && mapped.date().empty()) { continue; }
+
+                const auto key = mapped.key();
+                if ((saved_keys.count({ key.flight_number, key.date }) > 0) || flights.is_closed(key)) { continue; }
+
+                pending.push_back(pending_flight_of(mapped));
+            }
+        }
+
+        const auto contents = write_database(pending, generation);
+        pending.clear();
+
+        const auto temporary_path = path + ".tmp";
+
+        const auto file = std::fopen(temporary_path.c_str(), "wb");
+        if (file == nullptr)
+        {
+            throw StorageError("Unable to create \"" + temporary_path + "\".");
+        }
+
+        const auto written = std::fwrite(contents.data(), 1, contents.size(), file);
+        sync_file(file);
+
+        if ((std::fclose(file) != 0) || (written != contents.size()))
+        {
+            std::remove(temporary_path.c_str());
+            throw StorageError("Unable to write \"" + temporary_path + "\".");
+        }
+
+        // The mapped file could not be replaced on some platforms, thus it was unmapped first.
+        database.reset();
+
+        std::error_code error;
+        std::filesystem::rename(temporary_path, path, error);
+
+        database = FlightDatabase::open(path);
+
+        if (error)
+        {
+            std::remove(temporary_path.c_str());
+            throw StorageError("Unable to replace \"" + path + "\": " + error.message());
+        }
+
+        return contents.size();
+    }
+
+    optional<uint32_t> load_database(const string &path, SeatingPlan &seating_plan, FlightRegistry &flights, std::unique_ptr<FlightDatabase> &database)
+    {
+        database = FlightDatabase::open(path);
+        if (!database)
+        {
+            return std::nullopt;
+        }
+
+        if (const auto console = database->find(FlightKey()))
+        {
+            console->restore(seating_plan);
+        }
+
+        flights.set_loader([&database](const FlightKey &key, SeatingPlan &plan)
+        {
+            const auto mapped = database ? database->find(key) : std::nullopt;
+            if (!mapped || key.flight_number.empty()) { return false; }
+
+            mapped->restore(plan);
+            return true;
+        });
+
+        flights.set_prober([&database](const FlightKey &key)
+        {
+            return (database && !key.flight_number.empty() && database->find(key));
+        });
+
+        return database->generation();
+    }
+
+    size_t compact_database(const string &path, Journal &journal, const SeatingPlan &seating_plan, const FlightRegistry &flights, std::unique_ptr<FlightDatabase> &database)
+    {
+        // The database includes every recorded change, so the journal continues with a new generation.
+        // The changes after a plan was saved were held until then, rather than being discarded.
+        const auto generation = journal.begin_compaction();
+
+        size_t size;
+        try
+        {
+            size = save_database(path, seating_plan, flights, database, generation, &journal);
+        }
+        catch (...)
+        {
+            journal.cancel_compaction();
+            throw;
+        }
+
+        journal.reset(generation);
+
+        return size;
+    }
+}
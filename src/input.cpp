@@ -0,0 +1,728 @@
+/**
+ * Copyright (c) 2021 Jason Kwok, Ben Ho, Ben Yip, Harry Lam, and Hins To.
+ *
+ * Licensed under the GNU Affero General Public License, Version 3.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of the License at
+ *
+ *     https://github.com/JasonHK-HKCC/SEHH2042-Group-Project/blob/master/LICENSE
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under the License
+ * is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ * or implied. See the License for the specific language governing permissions and limitations under
+ * the License.
+ **/
+
+#include "jetassign/input.hpp"
+#include "jetassign/exceptions.hpp"
+#include "jetassign/stringutil.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <thread>
+#include <unordered_map>
+
+namespace jetassign::input
+{
+    using exceptions::InvalidInputError;
+
+    ImportReport import_compact_assignments(
+        istream &input,
+        core::SeatingPlan &plan,
+        const std::function<void(size_t, const string&)> &on_reject)
+    {
+        /** The size of each chunk that was read from the input. */
+        static const size_t kChunkSize = 1 << 20;
+
+        ImportReport report;
+
+        // Publishes the imported seats at once, rather than a snapshot for each line.
+        const auto deferred_publication = core::SeatingPlan::DeferredPublication(plan);
+
+        /** The allocator of the requests without a seat location. */
+        auto allocator = core::SeatAllocator(plan);
+        /** The seat of the latest member of each party. */
+        std::unordered_map<string, SeatLocation> party_seats;
+
+        /** The number of the current line. */
+        size_t line_number = 0;
+        /** The buffer of the current line, reused across the lines. */
+        string line;
+
+        /**
+         * Rejects the current line.
+         *
+         * @param reason The reason of the rejection.
+         **/
+        const auto reject = [&](const string &reason)
+        {
+            report.rejected++;
+            if (on_reject) { on_reject(line_number, reason); }
+        };
+
+        /**
+         * Imports a line of compact assignment.
+         **/
+        const auto import_line = [&]()
+        {
+            line_number++;
+            if (line.find_first_not_of("\t\n\v\f\r\x20") == string::npos) { return; }
+
+            try
+            {
+                const auto request = parsers::parse_compact_assignment(line);
+                const auto passenger = request.passenger();
+                auto location = request.location();
+
+                const auto assigned_location = plan.location_of(passenger.passport_id());
+                if (assigned_location && (plan.at(*assigned_location) != passenger))
+                {
+                    reject("A passenger with the same passport ID was already assigned a seat.");
+                    return;
+                }
+
+                if (!location && !assigned_location)
+                {
+                    // Allocates a seat next to the previous member of the party, if any.
+                    const auto party_seat = party_seats.find(request.party());
+                    location = allocator.allocate(
+                        request.ticket_class(),
+                        (party_seat != party_seats.end()) ? optional<SeatLocation>(party_seat->second) : std::nullopt);
+
+                    if (!location)
+                    {
+                        reject("No seats were available for the passenger.");
+                        return;
+                    }
+                }
+
+                if (location && (assigned_location != location))
+                {
+                    if (plan.is_occupied(*location))
+                    {
+                        // Allocates the nearest seat instead, as the batch of the menus does.
+                        location = allocator.allocate(request.ticket_class(), *location);
+                        if (!location)
+                        {
+                            reject("No seats were available for the passenger.");
+                            return;
+                        }
+                    }
+
+                    // Moves the passenger if the passenger was already assigned.
+                    if (assigned_location)
+                    {
+                        plan.remove(*assigned_location);
+                        allocator.release(*assigned_location);
+                    }
+
+                    plan.assign(*location, passenger);
+                    allocator.reserve(*location);
+                }
+
+                if (!request.party().empty()) { party_seats.insert_or_assign(request.party(), location.value_or(*assigned_location)); }
+
+                report.accepted++;
+            }
+            catch (const InvalidInputError &e)
+            {
+                reject(e.what());
+            }
+        };
+
+        /** The chunk that was read from the input. */
+        std::vector<char> chunk(kChunkSize);
+        while (input)
+        {
+            input.read(chunk.data(), chunk.size());
+            const auto chunk_size = static_cast<size_t>(input.gcount());
+
+            size_t start = 0;
+            while (start < chunk_size)
+            {
+                const auto newline = static_cast<const char*>(std::memchr(chunk.data() + start, '\n', chunk_size - start));
+                if (newline == nullptr)
+                {
+                    // Keeps the incomplete line for the next chunk.
+                    line.append(chunk.data() + start, chunk_size - start);
+                    break;
+                }
+
+                const auto end = static_cast<size_t>(newline - chunk.data());
+                line.append(chunk.data() + start, end - start);
+
+                import_line();
+                line.clear();
+
+                start = end + 1;
+            }
+        }
+
+        // Imports the last line without a trailing newline.
+        if (!line.empty()) { import_line(); }
+
+        return report;
+    }
+
+    namespace
+    {
+        /**
+         * Runs the parts of a job on the threads, the calling thread included.
+         *
+         * @param part_count   The number of parts.
+         * @param thread_count The number of threads.
+         * @param run_part     Runs a part of the job.
+         **/
+        void run_in_parallel(size_t part_count, size_t thread_count, const std::function<void(size_t)> &run_part)
+        {
+            thread_count = std::max<size_t>(1, std::min(thread_count, part_count));
+
+            const auto run_parts = [&](size_t first_part)
+            {
+                for (auto part = first_part; part < part_count; part += thread_count) { run_part(part); }
+            };
+
+            std::vector<std::thread> threads;
+            for (size_t i = 1; i < thread_count; i++) { threads.emplace_back(run_parts, i); }
+
+            run_parts(0);
+            for (auto &thread : threads) { thread.join(); }
+        }
+
+        /**
+         * Validates a batch of assignment requests one by one.
+         **/
+        BatchValidation validate_assignments_sequentially(
+            const core::SeatingPlan &plan,
+            const vector<AssignmentRequest> &requests,
+            const std::function<bool(const AssignmentRequest&, const SeatLocation&)> &confirm_reassignment)
+        {
+            BatchValidation result;
+
+            /** The occupation state when the valid requests were committed. */
+            std::map<SeatLocation, bool> occupation_state;
+            /** The first passenger who requested each passport ID in the batch. */
+            std::unordered_map<core::PassportId, Passenger, core::PassportIdHash> passport_owners;
+
+            /**
+             * Determine whether the seat was occupied.
+             *
+             * @param location The location of the seat.
+             **/
+            const auto is_occupied = [&](const SeatLocation &location)
+            {
+                const auto state = occupation_state.find(location);
+                return (state != occupation_state.end()) ? state->second : plan.is_occupied(location);
+            };
+
+            for (const auto &request : requests)
+            {
+                const auto passenger = request.passenger();
+                const auto location = request.location();
+                const auto assigned_location = plan.location_of(passenger.passport_id());
+
+                const auto owner = passport_owners.emplace(passenger.passport_key(), passenger).first;
+                if ((assigned_location && (plan.at(*assigned_location) != passenger)) || (owner->second != passenger))
+                {
+                    // Invalid request if the passport ID was taken by another passenger.
+
+                    result.assigned.push_back(request);
+                }
+                else if (assigned_location)
+                {
+                    // Marks the assigned seat as occupied.
+                    occupation_state[*assigned_location] = true;
+
+                    if (!location || (location == assigned_location) || !confirm_reassignment(request, *assigned_location))
+                    {
+                        // Invalid request if the passenger keeps the assigned seat.
+
+                        result.assigned.push_back(request);
+                        continue;
+                    }
+
+                    // Marks the assigned seat as free.
+                    occupation_state[*assigned_location] = false;
+
+                    // Allocates another seat if the requested seat was occupied.
+                    (is_occupied(*location) ? result.unseated : result.valid).push_back(request);
+                    occupation_state[*location] = true;
+                }
+                else if (!location || is_occupied(*location))
+                {
+                    // Allocates a seat if no seats or an occupied seat was requested.
+
+                    if (location) { occupation_state[*location] = true; }
+                    result.unseated.push_back(request);
+                }
+                else
+                {
+                    // Otherwise, valid request.
+
+                    occupation_state[*location] = true;
+                    result.valid.push_back(request);
+                }
+            }
+
+            result.occupation.assign(occupation_state.begin(), occupation_state.end());
+            return result;
+        }
+    }
+
+    BatchValidation validate_assignments(
+        const core::SeatingPlan &plan,
+        const vector<AssignmentRequest> &requests,
+        const std::function<bool(const AssignmentRequest&, const SeatLocation&)> &confirm_reassignment,
+        size_t thread_count)
+    {
+        if (thread_count <= 1)
+        {
+            return validate_assignments_sequentially(plan, requests, confirm_reassignment);
+        }
+
+        const auto &layout = plan.layout();
+        const auto count = requests.size();
+        const auto part_count = thread_count;
+
+        /** The verdict of each request. */
+        enum Verdict : std::uint8_t { kPending, kValid, kUnseated, kAssigned };
+
+        /** The state of each request. */
+        struct RequestState
+        {
+            /** The seat that was assigned to the passenger in the seating plan, if any. */
+            optional<SeatLocation> assigned_location;
+
+            /** The verdict of the request. */
+            Verdict verdict = kPending;
+
+            /** Whether the request was for a passenger who was assigned a seat, which marks the seat. */
+            bool is_seated = false;
+
+            /** Whether the passenger was moved from the assigned seat. */
+            bool is_moving = false;
+        };
+
+        /**
+         * A change of the occupation state of a seat.
+         **/
+        struct SeatEvent
+        {
+            /** The request that changed the seat. */
+            size_t request;
+
+            /** The index of the seat. */
+            size_t seat;
+
+            /** Whether the seat became occupied. */
+            bool is_occupied;
+
+            /** Whether the request requested the seat, which reads the state before changing it. */
+            bool is_requested;
+        };
+
+        std::vector<RequestState> states(count);
+
+        /**
+         * Returns the range of the requests in a part.
+         *
+         * @param part The part.
+         **/
+        const auto range_of = [&](size_t part)
+        {
+            return std::make_pair((count * part) / part_count, (count * (part + 1)) / part_count);
+        };
+
+        // 1. Looks up the passengers in the seating plan, and partitions the requests by passport ID.
+        std::vector<std::vector<std::vector<size_t>>> passport_partitions(part_count, std::vector<std::vector<size_t>>(part_count));
+        run_in_parallel(part_count, thread_count, [&](size_t part)
+        {
+            const auto hash = core::PassportIdHash();
+            const auto [first, last] = range_of(part);
+            for (auto i = first; i < last; i++)
+            {
+                const auto passenger = requests[i].passenger();
+                states[i].assigned_location = plan.location_of(passenger.passport_id());
+                if (states[i].assigned_location && (plan.at(*states[i].assigned_location) != passenger))
+                {
+                    states[i].verdict = kAssigned;
+                }
+
+                passport_partitions[part][hash(passenger.passport_key()) % part_count].push_back(i);
+            }
+        });
+
+        // 2. Rejects the requests for a passport ID that was requested by another passenger earlier.
+        run_in_parallel(part_count, thread_count, [&](size_t partition)
+        {
+            std::unordered_map<core::PassportId, Passenger, core::PassportIdHash> passport_owners;
+            for (size_t part = 0; part < part_count; part++)
+            {
+                for (const auto i : passport_partitions[part][partition])
+                {
+                    const auto passenger = requests[i].passenger();
+                    const auto owner = passport_owners.emplace(passenger.passport_key(), passenger).first;
+                    if (owner->second != passenger) { states[i].verdict = kAssigned; }
+                }
+            }
+        });
+
+        // 3. Asks for the reassignments in the input order.
+        for (size_t i = 0; i < count; i++)
+        {
+            auto &state = states[i];
+            const auto location = requests[i].location();
+            if ((state.verdict != kPending) || !state.assigned_location) { continue; }
+
+            state.is_seated = true;
+            if (!location || (location == state.assigned_location) || !confirm_reassignment(requests[i], *state.assigned_location))
+            {
+                state.verdict = kAssigned;
+            }
+            else
+            {
+                state.is_moving = true;
+            }
+        }
+
+        // 4. Partitions the changes of the seats by cabin section, i.e. a range of rows.
+        const auto section_of = [&](size_t seat) { return (((seat / layout.columns()) * part_count) / layout.rows()); };
+
+        std::vector<std::vector<std::vector<SeatEvent>>> section_partitions(part_count, std::vector<std::vector<SeatEvent>>(part_count));
+        run_in_parallel(part_count, thread_count, [&](size_t part)
+        {
+            const auto [first, last] = range_of(part);
+            for (auto i = first; i < last; i++)
+            {
+                const auto &state = states[i];
+                if (state.is_seated)
+                {
+                    const auto seat = layout.index_of(state.assigned_location->row(), state.assigned_location->column());
+                    section_partitions[part][section_of(seat)].push_back({ i, seat, !state.is_moving, false });
+                }
+
+                if (state.verdict == kPending)
+                {
+                    const auto location = requests[i].location();
+                    if (location)
+                    {
+                        const auto seat = layout.index_of(location->row(), location->column());
+                        section_partitions[part][section_of(seat)].push_back({ i, seat, true, true });
+                    }
+                }
+            }
+        });
+
+        // 5. Replays the changes of each cabin section in the input order.
+        std::vector<std::vector<std::pair<SeatLocation, bool>>> section_occupations(part_count);
+        run_in_parallel(part_count, thread_count, [&](size_t section)
+        {
+            std::map<size_t, bool> occupation_state;
+            for (size_t part = 0; part < part_count; part++)
+            {
+                for (const auto &event : section_partitions[part][section])
+                {
+                    const auto row = event.seat / layout.columns();
+                    const auto column = event.seat % layout.columns();
+
+                    if (event.is_requested)
+                    {
+                        const auto state = occupation_state.find(event.seat);
+                        const auto is_occupied = (state != occupation_state.end()) ? state->second : plan.is_occupied(row, column);
+                        states[event.request].verdict = (is_occupied ? kUnseated : kValid);
+                    }
+
+                    occupation_state[event.seat] = event.is_occupied;
+                }
+            }
+
+            for (const auto &[seat, is_occupied] : occupation_state)
+            {
+                section_occupations[section].emplace_back(SeatLocation(seat / layout.columns(), seat % layout.columns()), is_occupied);
+            }
+        });
+
+        // 6. Collects the requests in the input order.
+        BatchValidation result;
+        for (size_t i = 0; i < count; i++)
+        {
+            switch (states[i].verdict)
+            {
+                case kValid:
+                    result.valid.push_back(requests[i]);
+                    break;
+
+                case kAssigned:
+                    result.assigned.push_back(requests[i]);
+                    break;
+
+                default:
+                    // Including the requests without a seat location.
+                    result.unseated.push_back(requests[i]);
+                    break;
+            }
+        }
+
+        for (auto &occupation : section_occupations)
+        {
+            result.occupation.insert(result.occupation.end(), occupation.begin(), occupation.end());
+        }
+
+        return result;
+    }
+
+    AssignmentRequest::AssignmentRequest(Passenger passenger, optional<SeatLocation> location, optional<TicketClass> ticket_class, string party)
+        : m_passenger { std::move(passenger) }, m_location { location }, m_ticket_class { ticket_class }, m_party { std::move(party) } {}
+
+    AssignmentRequest::AssignmentRequest(string passenger_name, string passport_id, const SeatLocation &seat_location)
+        : AssignmentRequest(Passenger(std::move(passenger_name), std::move(passport_id)), seat_location) {};
+
+    bool AssignmentRequest::is_same_passenger(const AssignmentRequest &other) const
+    {
+        return (m_passenger == other.m_passenger);
+    }
+
+    AssignmentRequest AssignmentRequest::with_location(const SeatLocation &location) const
+    {
+        return AssignmentRequest(m_passenger, location, m_ticket_class, m_party);
+    }
+
+    bool AssignmentRequest::equals(const AssignmentRequest &other) const
+    {
+        return ((m_passenger == other.m_passenger)
+            && (m_location == other.m_location)
+            && (m_ticket_class == other.m_ticket_class)
+            && (m_party == other.m_party));
+    }
+
+    string AssignmentRequest::to_string() const
+    {
+        const auto seat = m_location
+            ? m_location->to_string()
+            : (m_ticket_class ? core::to_string(*m_ticket_class) : string(kAnySeat));
+
+        return (string(m_passenger.name()) + "/" + string(m_passenger.passport_id()) + "/" + seat + (m_party.empty() ? "" : ("/" + m_party)));
+    }
+
+    namespace parsers
+    {
+        using exceptions::EmptyInputError;
+        using exceptions::MalformedInputError;
+
+        namespace
+        {
+            /** The maximum number of digits of a row in seat location. */
+            const size_t kSeatLocationMaxRowDigits = 4;
+
+            /** Separator for compact assignment. */
+            const auto kCompactAssignmentSeparator = "/";
+
+            /**
+             * Parse the ticket class from the input, which was case-insensitive.
+             *
+             * @param input The user's input.
+             **/
+            optional<TicketClass> parse_ticket_class(string_view input)
+            {
+                for (const auto ticket_class : { TicketClass::kFirst, TicketClass::kBusiness, TicketClass::kEconomy })
+                {
+                    const auto name = core::to_string(ticket_class);
+                    if ((input.size() == name.size())
+                        && std::equal(input.begin(), input.end(), name.begin(), [](char a, char b) { return (stringutil::to_uppercase(a) == stringutil::to_uppercase(b)); }))
+                    {
+                        return ticket_class;
+                    }
+                }
+
+                return std::nullopt;
+            }
+
+            /**
+             * Determine whether the character is an ASCII digit.
+             *
+             * @param character The character to check.
+             **/
+            bool is_digit(char character)
+            {
+                return ((character >= '0') && (character <= '9'));
+            }
+
+            /**
+             * Determine whether the character is an ASCII letter or digit.
+             *
+             * @param character The character to check.
+             **/
+            bool is_alphanumeric(char character)
+            {
+                return (is_digit(character)
+                    || ((character >= 'A') && (character <= 'Z'))
+                    || ((character >= 'a') && (character <= 'z')));
+            }
+        }
+
+        bool parse_confirmation(string_view input)
+        {
+            const auto confirmation = stringutil::trim_view(input);
+            if (confirmation.empty())
+            {
+                throw EmptyInputError("Please enter a command.");
+            }
+
+            // Check the first character only.
+            switch (confirmation.at(0))
+            {
+                case 'Y':
+                case 'y':
+                    return true;
+
+                case 'N':
+                case 'n':
+                    return false;
+
+                default:
+                    throw MalformedInputError("Invalid response. Please enter a correct command.");
+            }
+        }
+
+        bool parse_confirmation(string_view input, bool default_value)
+        {
+            try
+            {
+                return parse_confirmation(input);
+            }
+            catch (const EmptyInputError& e)
+            {
+                return default_value;
+            }
+        }
+
+        long parse_menu_option(string_view input)
+        {
+            const auto selection = string(stringutil::trim_view(input));
+            if (selection.empty())
+            {
+                throw EmptyInputError("The option selection must not be empty.");
+            }
+
+            if (!std::all_of(selection.begin(), selection.end(), is_digit))
+            {
+                throw MalformedInputError("Only numeric characters were allowed.");
+            }
+
+            // Parse the string into long.
+            return std::stol(selection);
+        }
+
+        string parse_passenger_name(string_view input)
+        {
+            const auto passenger_name = stringutil::trim_view(input);
+            if (passenger_name.empty())
+            {
+                throw EmptyInputError("The passenger's name must not be empty.");
+            }
+
+            return string(passenger_name);
+        }
+
+        string parse_passport_id(string_view input)
+        {
+            const auto passport_id = stringutil::trim_view(input);
+            if (passport_id.empty())
+            {
+                throw EmptyInputError("The passport ID must not be empty.");
+            }
+
+            if (!std::all_of(passport_id.begin(), passport_id.end(), is_alphanumeric))
+            {
+                throw MalformedInputError("Only alphanumeric characters were allowed.");
+            }
+
+            if (passport_id.size() > core::PassportId::kMaxLength)
+            {
+                throw MalformedInputError("The passport ID must not be longer than " + std::to_string(core::PassportId::kMaxLength) + " characters.");
+            }
+
+            return string(passport_id);
+        }
+
+        SeatLocation parse_seat_location(string_view input)
+        {
+            const auto seat_location = stringutil::trim_view(input);
+            if (seat_location.empty())
+            {
+                throw EmptyInputError("The seat location must not be empty.");
+            }
+
+            const auto &layout = core::CabinLayout::current();
+
+            // The seat location should be formatted as the row, without leading zeros, followed by a
+            // letter of the column.
+            const auto row_digits = seat_location.size() - 1;
+            const auto is_matched = (row_digits >= 1)
+                && (row_digits <= kSeatLocationMaxRowDigits)
+                && (seat_location.front() != '0')
+                && std::all_of(seat_location.begin(), seat_location.end() - 1, is_digit);
+
+            size_t row = 0;
+            for (size_t i = 0; is_matched && (i < row_digits); i++)
+            {
+                row = (row * 10) + (seat_location[i] - '0');
+            }
+            row--;
+
+            const auto column = is_matched ? layout.column_of(stringutil::to_uppercase(seat_location.back())) : std::nullopt;
+
+            if (!is_matched || (row >= layout.rows()) || !column)
+            {
+                throw MalformedInputError(
+                    "The seat location must be formatted as the row (1-" + std::to_string(layout.rows()) + ") "
+                    "followed by the column (" + layout.column_letter(0) + "-" + layout.column_letter(layout.columns() - 1) + R"(), e.g. "10D".)");
+            }
+
+            if (layout.is_blocked(row, *column))
+            {
+                throw MalformedInputError("The seat " + stringutil::to_uppercase(seat_location) + " was not available for assignment.");
+            }
+
+            return SeatLocation(row, *column);
+        }
+
+        AssignmentRequest parse_compact_assignment(string_view input)
+        {
+            auto input_segments = stringutil::Splitter(stringutil::trim_view(input), kCompactAssignmentSeparator);
+
+            const auto passenger_name_segment = input_segments.next();
+            const auto passport_id_segment = input_segments.next();
+            const auto seat_location_segment = input_segments.next();
+            const auto party_segment = input_segments.next();
+            if (!seat_location_segment || input_segments.next())
+            {
+                throw exceptions::MalformedInputError(R"(The assignment entry should be formatted as "<Name>/<Passport ID>/<Seat Location>[/<Party>]".)");
+            }
+
+            auto passenger_name = parse_passenger_name(*passenger_name_segment);
+            auto passport_id = parse_passport_id(*passport_id_segment);
+
+            // The seat location could be replaced by a ticket class, or "*" for any seats.
+            const auto seat_segment = stringutil::trim_view(*seat_location_segment);
+            const auto ticket_class = parse_ticket_class(seat_segment);
+            const auto seat_location = (ticket_class || (seat_segment == kAnySeat))
+                ? std::nullopt
+                : optional<SeatLocation>(parse_seat_location(seat_segment));
+
+            auto party = string();
+            if (party_segment)
+            {
+                const auto party_name = stringutil::trim_view(*party_segment);
+                if (party_name.empty())
+                {
+                    throw MalformedInputError("The party must not be empty.");
+                }
+
+                party = string(party_name);
+            }
+
+            return AssignmentRequest(Passenger(std::move(passenger_name), std::move(passport_id)), seat_location, ticket_class, std::move(party));
+        }
+    }
+}
@@ -0,0 +1,392 @@
+/**
+ * Copyright (c) 2021 Jason Kwok, Ben Ho, Ben Yip, Harry Lam, and Hins To.
+ *
+ * Licensed under the GNU Affero General Public License, Version 3.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of the License at
+ *
+ *     https://github.com/JasonHK-HKCC/SEHH2042-Group-Project/blob/master/LICENSE
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under the License
+ * is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ * or implied. See the License for the specific language governing permissions and limitations under
+ * the License.
+ **/
+
+#include "jetassign/search.hpp"
+#include "jetassign/exceptions.hpp"
+#include "jetassign/stringutil.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <numeric>
+
+namespace jetassign::search
+{
+    using core::FlightKey;
+    using core::Passenger;
+    using core::SeatingPlan;
+    using core::SeatLocation;
+
+    namespace
+    {
+        /**
+         * Returns the smallest string that was greater than every string starting with the prefix,
+         * or an empty string if there was no such string.
+         *
+         * @param prefix The prefix.
+         **/
+        string successor_of(string prefix)
+        {
+            while (!prefix.empty() && (static_cast<unsigned char>(prefix.back()) == 0xFF)) { prefix.pop_back(); }
+            if (!prefix.empty()) { prefix.back()++; }
+
+            return prefix;
+        }
+
+        /**
+         * Walks the sorted names like a trie, and reports the names within the maximum edit distance
+         * of the query. The rows of the edit distances were shared between the names with a common
+         * prefix, and the names whose prefix was already too distant were skipped.
+         *
+         * @param query        The normalized query.
+         * @param max_distance The maximum number of inserted, deleted or replaced characters.
+         * @param first        The position of the first name.
+         * @param last         The position after the last name.
+         * @param name_of      Returns the normalized name at a position.
+         * @param lower_bound  Returns the position of the first name that was not less than a string.
+         * @param report       Receives the position of each name within the distance, and the distance.
+         **/
+        template<typename TPosition, typename TNameOf, typename TLowerBound, typename TReport>
+        void walk_similar(const string &query, size_t max_distance, TPosition first, TPosition last, TNameOf name_of, TLowerBound lower_bound, TReport report)
+        {
+            const auto columns = query.size() + 1;
+
+            // The Nth row holds the edit distances between the first N characters of the path and
+            // each prefix of the query, so the names sharing a prefix share the rows of it.
+
+            /** The characters of the names that the rows were computed for. */
+            string path;
+
+            /** The rows of the edit distances, one more than the characters of the path. */
+            std::vector<size_t> rows(columns);
+            std::iota(rows.begin(), rows.end(), 0);
+
+            auto position = first;
+            while (position != last)
+            {
+                const string_view key = name_of(position);
+
+                // Reuses the rows of the common prefix with the previous name.
+                const auto common = static_cast<size_t>(std::mismatch(path.begin(), path.end(), key.begin(), key.end()).first - path.begin());
+                path.resize(common);
+                rows.resize((common + 1) * columns);
+
+                bool is_too_distant = false;
+                while (path.size() < key.size())
+                {
+                    const auto character = key[path.size()];
+                    const auto previous = rows.size() - columns;
+
+                    rows.resize(rows.size() + columns);
+                    const auto current = previous + columns;
+
+                    rows[current] = rows[previous] + 1;
+                    auto minimum = rows[current];
+                    for (size_t j = 1; j < columns; j++)
+                    {
+                        const auto substitution = rows[previous + j - 1] + ((query[j - 1] == character) ? 0 : 1);
+                        rows[current + j] = std::min({ rows[previous + j] + 1, rows[current + j - 1] + 1, substitution });
+                        minimum = std::min(minimum, rows[current + j]);
+                    }
+
+                    path.push_back(character);
+
+                    // Every name with this prefix was too distant, since the distances never decrease.
+                    if (minimum > max_distance)
+                    {
+                        is_too_distant = true;
+                        break;
+                    }
+                }
+
+                if (is_too_distant)
+                {
+                    const auto next_prefix = successor_of(path);
+                    position = next_prefix.empty() ? last : lower_bound(next_prefix);
+                    continue;
+                }
+
+                const auto distance = rows.back();
+                if (distance <= max_distance) { report(position, distance); }
+
+                position++;
+            }
+        }
+
+        /**
+         * Tells whether the passengers of a flight of a database were not covered by the name
+         * index, as the flight was neither the console, loaded nor closed. Each flight was checked
+         * against the registry once.
+         **/
+        class UnloadedFlights
+        {
+            public:
+                UnloadedFlights(const storage::FlightDatabase &database, const core::FlightRegistry &flights)
+                    : m_database { database }, m_flights { flights } {}
+
+                /**
+                 * Returns whether a flight was not loaded.
+                 *
+                 * @param position The position of the flight in the directory.
+                 **/
+                bool contains(size_t position)
+                {
+                    const auto [entry, inserted] = m_is_unloaded.emplace(position, false);
+                    if (inserted)
+                    {
+                        const auto key = m_database.at(position).key();
+                        entry->second = (!key.flight_number.empty() && !m_flights.is_loaded(key) && !m_flights.is_closed(key));
+                    }
+
+                    return entry->second;
+                }
+
+            private:
+                const storage::FlightDatabase &m_database;
+
+                const core::FlightRegistry &m_flights;
+
+                /**
+                 * Whether each checked flight was not loaded, by its position.
+                 **/
+                std::unordered_map<size_t, bool> m_is_unloaded;
+        };
+
+        /**
+         * Returns the passenger of an entry of the name table, which was read from its flight.
+         *
+         * @param database The flight database.
+         * @param name     The entry of the name table.
+         * @param distance The edit distance between the name and the query.
+         **/
+        NameMatch match_of(const storage::FlightDatabase &database, const storage::MappedName &name, size_t distance)
+        {
+            const auto flight = database.at(name.flight);
+            const auto row = name.seat / flight.columns();
+            const auto column = name.seat % flight.columns();
+
+            const auto passenger = flight.at(row, column);
+            if (!passenger) { throw exceptions::StorageError("The flight database was corrupted."); }
+
+            return { flight.key(), SeatLocation(row, column), Passenger(passenger->name, passenger->passport_id), distance };
+        }
+    }
+
+    void NameIndex::attach(SeatingPlan &plan, const FlightKey &key)
+    {
+        {
+            std::unique_lock<std::shared_mutex> lock(m_mutex);
+            m_flights[&plan] = key;
+
+            const auto &layout = plan.layout();
+            for (size_t row = 0; row < layout.rows(); row++)
+            {
+                for (size_t column = 0; column < layout.columns(); column++)
+                {
+                    if (const auto &passenger = plan.at(row, column))
+                    {
+                        insert(plan, SeatLocation(row, column), *passenger);
+                    }
+                }
+            }
+        }
+
+        plan.subscribe(this);
+    }
+
+    void NameIndex::detach(SeatingPlan &plan)
+    {
+        plan.unsubscribe(this);
+
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+
+        const auto &layout = plan.layout();
+        for (size_t row = 0; row < layout.rows(); row++)
+        {
+            for (size_t column = 0; column < layout.columns(); column++)
+            {
+                if (const auto &passenger = plan.at(row, column))
+                {
+                    erase(plan, SeatLocation(row, column), *passenger);
+                }
+            }
+        }
+
+        m_flights.erase(&plan);
+    }
+
+    std::vector<NameMatch> NameIndex::find(string_view name, size_t limit) const
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+
+        std::vector<NameMatch> matches;
+
+        const auto entry = m_names.find(normalize(name));
+        if (entry != m_names.end()) { collect(entry->second, 0, limit, matches); }
+
+        return matches;
+    }
+
+    std::vector<NameMatch> NameIndex::find_prefix(string_view prefix, size_t limit) const
+    {
+        const auto normalized_prefix = normalize(prefix);
+
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+
+        std::vector<NameMatch> matches;
+        for (auto entry = m_names.lower_bound(normalized_prefix); (entry != m_names.end()) && (matches.size() < limit); entry++)
+        {
+            if (entry->first.compare(0, normalized_prefix.size(), normalized_prefix) != 0) { break; }
+
+            collect(entry->second, 0, limit, matches);
+        }
+
+        return matches;
+    }
+
+    std::vector<NameMatch> NameIndex::find_similar(string_view name, size_t max_distance, size_t limit) const
+    {
+        const auto query = normalize(name);
+
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+
+        /** The names within the maximum distance. */
+        std::vector<std::pair<size_t, const std::vector<Entry>*>> candidates;
+
+        walk_similar(query, max_distance, m_names.begin(), m_names.end(),
+            [](const auto &entry) { return string_view(entry->first); },
+            [this](const string &prefix) { return m_names.lower_bound(prefix); },
+            [&](const auto &entry, size_t distance) { candidates.emplace_back(distance, &entry->second); });
+
+        // The closest names first, then in order of the names.
+        std::stable_sort(candidates.begin(), candidates.end(), [](const auto &a, const auto &b) { return (a.first < b.first); });
+
+        std::vector<NameMatch> matches;
+        for (const auto &[distance, entries] : candidates)
+        {
+            if (matches.size() >= limit) { break; }
+            collect(*entries, distance, limit, matches);
+        }
+
+        return matches;
+    }
+
+    size_t NameIndex::size() const
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        return m_size;
+    }
+
+    void NameIndex::on_assigned(const SeatingPlan &plan, const SeatLocation &location, const Passenger &passenger)
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        insert(plan, location, passenger);
+    }
+
+    void NameIndex::on_removed(const SeatingPlan &plan, const SeatLocation &location, const Passenger &passenger)
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        erase(plan, location, passenger);
+    }
+
+    string NameIndex::normalize(string_view name)
+    {
+        return stringutil::fold(name);
+    }
+
+    void NameIndex::insert(const SeatingPlan &plan, const SeatLocation &location, const Passenger &passenger)
+    {
+        m_names[normalize(passenger.name())].push_back({ &plan, location, passenger });
+        m_size++;
+    }
+
+    void NameIndex::erase(const SeatingPlan &plan, const SeatLocation &location, const Passenger &passenger)
+    {
+        const auto names_entry = m_names.find(normalize(passenger.name()));
+        if (names_entry == m_names.end()) { return; }
+
+        auto &entries = names_entry->second;
+        const auto entry = std::find_if(entries.begin(), entries.end(), [&](const Entry &entry)
+        {
+            return ((entry.plan == &plan) && (entry.location == location));
+        });
+
+        if (entry == entries.end()) { return; }
+
+        // The order of the passengers with the same name was not significant.
+        *entry = std::move(entries.back());
+        entries.pop_back();
+        m_size--;
+
+        if (entries.empty()) { m_names.erase(names_entry); }
+    }
+
+    void NameIndex::collect(const std::vector<Entry> &entries, size_t distance, size_t limit, std::vector<NameMatch> &matches) const
+    {
+        for (const auto &entry : entries)
+        {
+            if (matches.size() >= limit) { return; }
+
+            const auto flight = m_flights.find(entry.plan);
+            matches.push_back({ (flight != m_flights.end()) ? flight->second : FlightKey(), entry.location, entry.passenger, distance });
+        }
+    }
+
+    std::vector<NameMatch> find_prefix(const storage::FlightDatabase &database, const core::FlightRegistry &flights, string_view prefix, size_t limit)
+    {
+        const auto normalized_prefix = NameIndex::normalize(prefix);
+        auto unloaded_flights = UnloadedFlights(database, flights);
+
+        // The name table was sorted by the normalized names, so the matches were a range of it.
+        std::vector<NameMatch> matches;
+        for (auto position = database.lower_bound_name(normalized_prefix); (position < database.names()) && (matches.size() < limit); position++)
+        {
+            const auto name = database.name_at(position);
+            if (name.normalized_name.substr(0, normalized_prefix.size()) != normalized_prefix) { break; }
+
+            // The console and the loaded flights were covered by the name index.
+            if (unloaded_flights.contains(name.flight)) { matches.push_back(match_of(database, name, 0)); }
+        }
+
+        return matches;
+    }
+
+    std::vector<NameMatch> find_similar(const storage::FlightDatabase &database, const core::FlightRegistry &flights, string_view name, size_t max_distance, size_t limit)
+    {
+        const auto query = NameIndex::normalize(name);
+        auto unloaded_flights = UnloadedFlights(database, flights);
+
+        /** The positions of the names within the maximum distance, along with their distances. */
+        std::vector<std::pair<size_t, size_t>> candidates;
+
+        walk_similar(query, max_distance, size_t(0), database.names(),
+            [&](size_t position) { return database.name_at(position).normalized_name; },
+            [&](const string &prefix) { return database.lower_bound_name(prefix); },
+            [&](size_t position, size_t distance)
+            {
+                if (unloaded_flights.contains(database.name_at(position).flight)) { candidates.emplace_back(distance, position); }
+            });
+
+        // The closest names first, then in order of the names.
+        std::stable_sort(candidates.begin(), candidates.end(), [](const auto &a, const auto &b) { return (a.first < b.first); });
+        if (candidates.size() > limit) { candidates.erase(candidates.begin() + limit, candidates.end()); }
+
+        std::vector<NameMatch> matches;
+        for (const auto &[distance, position] : candidates)
+        {
+            matches.push_back(match_of(database, database.name_at(position), distance));
+        }
+
+        return matches;
+    }
+}
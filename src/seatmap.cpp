@@ -0,0 +1,326 @@
+/**
+ * Copyright (c) 2021 Jason Kwok, Ben Ho, Ben Yip, Harry Lam, and Hins To.
+ *
+ * Licensed under the GNU Affero General Public License, Version 3.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of the License at
+ *
+ *     https://github.com/JasonHK-HKCC/SEHH2042-Group-Project/blob/master/LICENSE
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under the License
+ * is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ * or implied. See the License for the specific language governing permissions and limitations under
+ * the License.
+ **/
+
+#include "jetassign/seatmap.hpp"
+#include "jetassign/exceptions.hpp"
+#include "jetassign/stringutil.hpp"
+
+#include <charconv>
+#include <stdexcept>
+
+namespace jetassign::seatmap
+{
+    using std::uint16_t;
+    using std::uint32_t;
+    using std::uint64_t;
+
+    using core::CabinLayout;
+    using core::FlightKey;
+    using core::SeatingPlan;
+    using core::SeatLocation;
+
+    namespace
+    {
+        /**
+         * The magic of the binary format.
+         **/
+        constexpr char kBinaryMagic[4] = { 'J', 'A', 'S', 'M' };
+
+        /**
+         * The version of the binary format.
+         **/
+        constexpr uint16_t kBinaryVersion = 1;
+
+        /**
+         * Returns the status of a seat.
+         **/
+        string_view status_of(uint64_t blocked, uint64_t occupied, size_t column)
+        {
+            if ((blocked >> column) & 1) { return "blocked"; }
+            return ((occupied >> column) & 1) ? "occupied" : "vacant";
+        }
+
+        /**
+         * Returns the name and the passport ID of the passenger at an occupied seat.
+         **/
+        std::pair<string_view, string_view> passenger_at(const SeatingPlan::Snapshot &plan, size_t row, size_t column)
+        {
+            const auto &passenger = *plan.at(SeatLocation(row, column));
+            return { passenger.name(), passenger.passport_id() };
+        }
+
+        std::pair<string_view, string_view> passenger_at(const storage::MappedFlight &plan, size_t row, size_t column)
+        {
+            // The strings refer to the mapping, which outlives the writing.
+            const auto passenger = *plan.at(row, column);
+            return { passenger.name, passenger.passport_id };
+        }
+    }
+
+    optional<Format> parse_format(string_view name)
+    {
+        if (name == "json") { return Format::kJson; }
+        if (name == "csv") { return Format::kCsv; }
+        if (name == "binary") { return Format::kBinary; }
+
+        return std::nullopt;
+    }
+
+    SeatMapWriter::SeatMapWriter(std::ostream &output, Format format)
+        : m_output { output }, m_buffer { *output.rdbuf() }, m_format { format }, m_size { 0 }
+    {
+        switch (m_format)
+        {
+            case Format::kJson:
+                put('[');
+                break;
+
+            case Format::kCsv:
+                put("flight,date,seat,class,status,name,passport_id\n");
+                break;
+
+            case Format::kBinary:
+                put(string_view(kBinaryMagic, sizeof(kBinaryMagic)));
+                put_u16(kBinaryVersion);
+                put_u16(0);
+                break;
+        }
+    }
+
+    void SeatMapWriter::write(const FlightKey &flight, const SeatingPlan::Snapshot &plan)
+    {
+        write_plan(flight, plan.layout(), plan);
+    }
+
+    void SeatMapWriter::write(const FlightKey &flight, const storage::MappedFlight &plan, const CabinLayout &layout)
+    {
+        if ((plan.rows() != layout.rows()) || (plan.columns() != layout.columns()))
+        {
+            throw std::invalid_argument("The cabin layout does not match the seating plan.");
+        }
+
+        write_plan(flight, layout, plan);
+    }
+
+    template<typename TPlan>
+    void SeatMapWriter::write_plan(const FlightKey &flight, const CabinLayout &layout, const TPlan &plan)
+    {
+        switch (m_format)
+        {
+            case Format::kJson:
+                write_json(flight, layout, plan);
+                break;
+
+            case Format::kCsv:
+                write_csv(flight, layout, plan);
+                break;
+
+            case Format::kBinary:
+                write_binary(flight, layout, plan);
+                break;
+        }
+
+        m_size++;
+    }
+
+    void SeatMapWriter::finish()
+    {
+        if (m_format == Format::kJson) { put("]\n"); }
+
+        m_output.flush();
+    }
+
+    template<typename TPlan>
+    void SeatMapWriter::write_json(const FlightKey &flight, const CabinLayout &layout, const TPlan &plan)
+    {
+
+        put((m_size == 0) ? "\n{\"flight\":" : ",\n{\"flight\":");
+        put_json_string(flight.flight_number);
+        put(",\"date\":");
+        put_json_string(flight.date);
+        put(",\"rows\":");
+        put_number(layout.rows());
+        put(",\"columns\":\"");
+        for (size_t column = 0; column < layout.columns(); column++) { put(layout.column_letter(column)); }
+        put("\",\"seats\":[");
+
+        for (size_t row = 0; row < layout.rows(); row++)
+        {
+            const auto ticket_class = core::to_string(layout.ticket_class(row));
+            const auto blocked = layout.blocked_bits(row);
+            const auto occupied = plan.occupied_bits(row);
+
+            for (size_t column = 0; column < layout.columns(); column++)
+            {
+                put(((row == 0) && (column == 0)) ? "{\"seat\":\"" : ",{\"seat\":\"");
+                put_number(row + 1);
+                put(layout.column_letter(column));
+                put("\",\"class\":\"");
+                put(ticket_class);
+                put("\",\"status\":\"");
+                put(status_of(blocked, occupied, column));
+                put('"');
+
+                if ((occupied >> column) & 1)
+                {
+                    const auto [name, passport_id] = passenger_at(plan, row, column);
+
+                    put(",\"name\":");
+                    put_json_string(name);
+                    put(",\"passport_id\":");
+                    put_json_string(passport_id);
+                }
+
+                put('}');
+            }
+        }
+
+        put("]}");
+    }
+
+    template<typename TPlan>
+    void SeatMapWriter::write_csv(const FlightKey &flight, const CabinLayout &layout, const TPlan &plan)
+    {
+
+        for (size_t row = 0; row < layout.rows(); row++)
+        {
+            const auto ticket_class = core::to_string(layout.ticket_class(row));
+            const auto blocked = layout.blocked_bits(row);
+            const auto occupied = plan.occupied_bits(row);
+
+            for (size_t column = 0; column < layout.columns(); column++)
+            {
+                put_csv_field(flight.flight_number);
+                put(',');
+                put_csv_field(flight.date);
+                put(',');
+                put_number(row + 1);
+                put(layout.column_letter(column));
+                put(',');
+                put(ticket_class);
+                put(',');
+                put(status_of(blocked, occupied, column));
+                put(',');
+
+                if ((occupied >> column) & 1)
+                {
+                    const auto [name, passport_id] = passenger_at(plan, row, column);
+
+                    put_csv_field(name);
+                    put(',');
+                    put_csv_field(passport_id);
+                }
+                else
+                {
+                    put(',');
+                }
+
+                put('\n');
+            }
+        }
+    }
+
+    template<typename TPlan>
+    void SeatMapWriter::write_binary(const FlightKey &flight, const CabinLayout &layout, const TPlan &plan)
+    {
+        const auto row_size = (layout.columns() + 7) / 8;
+
+        put_binary_string(flight.flight_number);
+        put_binary_string(flight.date);
+        put_u32(static_cast<uint32_t>(layout.rows()));
+        put_u32(static_cast<uint32_t>(layout.columns()));
+
+        for (size_t row = 0; row < layout.rows(); row++)
+        {
+            const auto occupied = plan.occupied_bits(row);
+            for (size_t i = 0; i < row_size; i++) { put(static_cast<char>((occupied >> (i * 8)) & 0xFF)); }
+        }
+
+        for (size_t row = 0; row < layout.rows(); row++)
+        {
+            const auto blocked = layout.blocked_bits(row);
+            for (size_t i = 0; i < row_size; i++) { put(static_cast<char>((blocked >> (i * 8)) & 0xFF)); }
+        }
+    }
+
+    void SeatMapWriter::put(char character)
+    {
+        if (m_buffer.sputc(character) == std::char_traits<char>::eof())
+        {
+            m_output.setstate(std::ios_base::badbit);
+        }
+    }
+
+    void SeatMapWriter::put(string_view text)
+    {
+        if (m_buffer.sputn(text.data(), static_cast<std::streamsize>(text.size())) != static_cast<std::streamsize>(text.size()))
+        {
+            m_output.setstate(std::ios_base::badbit);
+        }
+    }
+
+    void SeatMapWriter::put_number(uint64_t value)
+    {
+        char digits[20];
+        const auto result = std::to_chars(std::begin(digits), std::end(digits), value);
+
+        put(string_view(digits, static_cast<size_t>(result.ptr - digits)));
+    }
+
+    void SeatMapWriter::put_json_string(string_view value)
+    {
+        stringutil::write_json_string(value, [this](string_view piece) { put(piece); });
+    }
+
+    void SeatMapWriter::put_csv_field(string_view value)
+    {
+        if (value.find_first_of(",\"\r\n") == string_view::npos)
+        {
+            put(value);
+            return;
+        }
+
+        // Quotes the field, and doubles the quotes inside it.
+        put('"');
+        for (const auto character : value)
+        {
+            if (character == '"') { put('"'); }
+            put(character);
+        }
+        put('"');
+    }
+
+    void SeatMapWriter::put_u16(uint16_t value)
+    {
+        put(static_cast<char>(value & 0xFF));
+        put(static_cast<char>((value >> 8) & 0xFF));
+    }
+
+    void SeatMapWriter::put_u32(uint32_t value)
+    {
+        put_u16(static_cast<uint16_t>(value & 0xFFFF));
+        put_u16(static_cast<uint16_t>(value >> 16));
+    }
+
+    void SeatMapWriter::put_binary_string(string_view value)
+    {
+        if (value.size() > UINT16_MAX)
+        {
+            throw exceptions::StorageError("The string was too long to be exported.");
+        }
+
+        put_u16(static_cast<uint16_t>(value.size()));
+        put(value);
+    }
+}
@@ -0,0 +1,583 @@
+/**
+ * Copyright (c) 2021 Jason Kwok, Ben Ho, Ben Yip, Harry Lam, and Hins To.
+ *
+ * Licensed under the GNU Affero General Public License, Version 3.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of the License at
+ *
+ *     https://github.com/JasonHK-HKCC/SEHH2042-Group-Project/blob/master/LICENSE
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under the License
+ * is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ * or implied. See the License for the specific language governing permissions and limitations under
+ * the License.
+ **/
+
+#include "jetassign/server.hpp"
+#include "jetassign/exceptions.hpp"
+#include "jetassign/input.hpp"
+#include "jetassign/stringutil.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <istream>
+#include <ostream>
+
+#ifdef __linux__
+#include <thread>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace jetassign::server
+{
+    using core::SeatingPlan;
+    using core::SeatLocation;
+
+    string Dispatcher::handle(string_view request, SeatingPlan::Reader &reader)
+    {
+        request = stringutil::trim_view(request);
+
+        const auto separator = request.find(' ');
+        const auto command = stringutil::to_uppercase(request.substr(0, separator));
+        const auto argument = (separator == string_view::npos) ? string_view() : stringutil::trim_view(request.substr(separator + 1));
+
+        try
+        {
+            if (command == "LOOKUP")
+            {
+                const auto &snapshot = reader.current();
+
+                const auto location = snapshot.location_of(input::parsers::parse_passport_id(argument));
+                if (!location)
+                {
+                    return "NOT_FOUND";
+                }
+
+                return "OK " + location->to_string() + ' ' + string(snapshot.at(*location)->name());
+            }
+            else if (command == "MAP")
+            {
+                const auto &snapshot = reader.current();
+                const auto &layout = snapshot.layout();
+
+                string response = "OK";
+                response.reserve(response.size() + (layout.rows() * (layout.columns() + 1)));
+
+                for (size_t row = 0; row < layout.rows(); row++)
+                {
+                    const auto blocked = layout.blocked_bits(row);
+                    const auto occupied = snapshot.occupied_bits(row);
+
+                    response += ' ';
+                    for (size_t column = 0; column < layout.columns(); column++)
+                    {
+                        response += ((blocked >> column) & 1) ? '#' : (((occupied >> column) & 1) ? 'X' : '*');
+                    }
+                }
+
+                return response;
+            }
+            else if (command == "ASSIGN")
+            {
+                const auto assignment = input::parsers::parse_compact_assignment(argument);
+
+                auto location = assignment.location();
+                {
+                    const std::lock_guard<std::mutex> lock(m_writer_mutex);
+
+                    if (!location)
+                    {
+                        location = core::SeatAllocator(m_plan).allocate(assignment.ticket_class());
+                        if (!location)
+                        {
+                            return "ERROR No seats were available.";
+                        }
+                    }
+
+                    m_plan.assign(*location, assignment.passenger());
+                }
+
+                // Waits outside the lock, so the concurrent changes were committed together.
+                if (m_committer) { m_committer(); }
+                return "OK " + location->to_string();
+            }
+            else if (command == "REMOVE")
+            {
+                const auto location = input::parsers::parse_seat_location(argument);
+
+                string passport_id;
+                {
+                    const std::lock_guard<std::mutex> lock(m_writer_mutex);
+
+                    const auto &passenger = m_plan.at(location);
+                    if (!passenger)
+                    {
+                        return "ERROR The seat was not assigned.";
+                    }
+
+                    passport_id = passenger->passport_id();
+                    m_plan.remove(location);
+                }
+
+                if (m_committer) { m_committer(); }
+                return "OK " + passport_id;
+            }
+            else if (command == "QUIT")
+            {
+                return "BYE";
+            }
+
+            return "ERROR Unknown command.";
+        }
+        catch (const std::exception &e)
+        {
+            return string("ERROR ") + e.what();
+        }
+    }
+
+    namespace
+    {
+        /**
+         * Appends a string to a JSON document as a string literal.
+         *
+         * @param output The JSON document.
+         * @param value  The string.
+         **/
+        void append_json_string(string &output, string_view value)
+        {
+            stringutil::write_json_string(value, [&output](string_view piece) { output.append(piece); });
+        }
+    }
+
+    ScriptReport run_script(std::istream &input, std::ostream &output, SeatingPlan &plan, Committer committer)
+    {
+        auto dispatcher = Dispatcher(plan, std::move(committer));
+        auto reader = SeatingPlan::Reader(plan);
+
+        ScriptReport report;
+
+        string line;
+        string result;
+        for (size_t line_number = 1; std::getline(input, line); line_number++)
+        {
+            const auto request = stringutil::trim_view(line);
+            if (request.empty() || (request.front() == '#')) { continue; }
+
+            const auto response = dispatcher.handle(request, reader);
+
+            const auto separator = response.find(' ');
+            const auto status = string_view(response).substr(0, separator);
+            const auto detail = (separator == string::npos) ? string_view() : string_view(response).substr(separator + 1);
+
+            result.assign("{\"line\":").append(std::to_string(line_number)).append(",\"request\":");
+            append_json_string(result, request);
+            result.append(",\"status\":");
+            append_json_string(result, status);
+            result.append((status == "ERROR") ? ",\"reason\":" : ",\"result\":");
+            append_json_string(result, detail);
+            result.append("}\n");
+
+            output << result;
+
+            if (status == "ERROR") { report.failed++; }
+            else { report.succeeded++; }
+
+            if (status == "BYE") { break; }
+        }
+
+        return report;
+    }
+
+#ifdef __linux__
+    using exceptions::ServerError;
+
+    namespace
+    {
+        /**
+         * Throws an error with the reason of the last failed system call.
+         *
+         * @param message The message of the error.
+         **/
+        [[noreturn]] void throw_system_error(const string &message)
+        {
+            throw ServerError(message + ": " + std::strerror(errno));
+        }
+    }
+
+    Server::Server(SeatingPlan &plan, size_t worker_count, Committer committer)
+        : m_dispatcher(plan, std::move(committer)),
+          m_worker_count { std::max<size_t>(worker_count, 1) },
+          m_epoll { epoll_create1(EPOLL_CLOEXEC) },
+          m_wakeup { eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC) },
+          m_next_id { 1 },
+          m_is_stopping { false }
+    {
+        if ((m_epoll < 0) || (m_wakeup < 0))
+        {
+            if (m_epoll >= 0) { ::close(m_epoll); }
+            if (m_wakeup >= 0) { ::close(m_wakeup); }
+            throw_system_error("Unable to create the event loop");
+        }
+
+        epoll_event event {};
+        event.events = EPOLLIN;
+        event.data.fd = m_wakeup;
+        epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_wakeup, &event);
+    }
+
+    Server::~Server()
+    {
+        for (const auto &[fd, connection] : m_connections) { ::close(fd); }
+        for (const auto fd : m_listeners) { ::close(fd); }
+
+        if (m_socket_path) { ::unlink(m_socket_path->c_str()); }
+
+        ::close(m_wakeup);
+        ::close(m_epoll);
+    }
+
+    void Server::listen_unix(const string &path)
+    {
+        sockaddr_un address {};
+        if (path.size() >= sizeof(address.sun_path))
+        {
+            throw ServerError("The path of the socket was too long.");
+        }
+
+        address.sun_family = AF_UNIX;
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+        const auto fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0) { throw_system_error("Unable to create the socket"); }
+
+        // Replaces the socket file left by the previous server.
+        ::unlink(path.c_str());
+
+        if ((bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) < 0) || (listen(fd, SOMAXCONN) < 0))
+        {
+            ::close(fd);
+            throw_system_error("Unable to listen on " + path);
+        }
+
+        m_socket_path = path;
+        this->add_listener(fd);
+    }
+
+    std::uint16_t Server::listen_tcp(std::uint16_t port)
+    {
+        sockaddr_in address {};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        const auto fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0) { throw_system_error("Unable to create the socket"); }
+
+        const int enabled = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &enabled, sizeof(enabled));
+
+        socklen_t length = sizeof(address);
+        if ((bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) < 0)
+            || (listen(fd, SOMAXCONN) < 0)
+            || (getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length) < 0))
+        {
+            ::close(fd);
+            throw_system_error("Unable to listen on port " + std::to_string(port));
+        }
+
+        this->add_listener(fd);
+        return ntohs(address.sin_port);
+    }
+
+    void Server::run()
+    {
+        std::vector<std::thread> workers;
+        for (size_t i = 0; i < m_worker_count; i++)
+        {
+            workers.emplace_back([this]() { this->work(); });
+        }
+
+        std::array<epoll_event, 64> events;
+        while (!m_is_stopping.load())
+        {
+            const auto count = epoll_wait(m_epoll, events.data(), static_cast<int>(events.size()), -1);
+            if ((count < 0) && (errno != EINTR)) { break; }
+
+            for (auto i = 0; i < count; i++)
+            {
+                const auto fd = events[i].data.fd;
+
+                if (fd == m_wakeup)
+                {
+                    std::uint64_t value;
+                    while (::read(m_wakeup, &value, sizeof(value)) > 0) {}
+
+                    std::vector<Completion> completions;
+                    {
+                        const std::lock_guard<std::mutex> lock(m_mutex);
+                        completions.swap(m_completions);
+                    }
+
+                    for (auto &completion : completions)
+                    {
+                        // Drops the responses if the connection was closed meanwhile.
+                        const auto entry = m_connections.find(completion.fd);
+                        if ((entry == m_connections.end()) || (entry->second.id != completion.id)) { continue; }
+
+                        auto &connection = entry->second;
+                        connection.output += completion.responses;
+                        connection.is_busy = false;
+
+                        if (completion.is_quitting)
+                        {
+                            connection.input.clear();
+                            connection.is_closing = true;
+                        }
+
+                        this->dispatch(completion.fd);
+                        this->flush(completion.fd);
+                    }
+                }
+                else if (std::find(m_listeners.begin(), m_listeners.end(), fd) != m_listeners.end())
+                {
+                    this->accept_connections(fd);
+                }
+                else
+                {
+                    // Skips the connection that was closed by an earlier event of the same batch.
+                    if (!m_connections.count(fd)) { continue; }
+
+                    if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) { this->receive(fd); }
+                    if ((events[i].events & EPOLLOUT) && m_connections.count(fd)) { this->flush(fd); }
+                }
+            }
+        }
+
+        m_is_stopping = true;
+        m_has_task.notify_all();
+        for (auto &worker : workers) { worker.join(); }
+
+        for (const auto &[fd, connection] : m_connections) { ::close(fd); }
+        m_connections.clear();
+    }
+
+    void Server::stop()
+    {
+        {
+            const std::lock_guard<std::mutex> lock(m_mutex);
+            m_is_stopping = true;
+        }
+        m_has_task.notify_all();
+
+        const std::uint64_t value = 1;
+        [[maybe_unused]] const auto written = ::write(m_wakeup, &value, sizeof(value));
+    }
+
+    void Server::add_listener(int fd)
+    {
+        epoll_event event {};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+
+        if (epoll_ctl(m_epoll, EPOLL_CTL_ADD, fd, &event) < 0)
+        {
+            ::close(fd);
+            throw_system_error("Unable to watch the socket");
+        }
+
+        m_listeners.push_back(fd);
+    }
+
+    void Server::accept_connections(int fd)
+    {
+        while (true)
+        {
+            const auto client = accept4(fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (client < 0) { return; }
+
+            // Sends each response at once, which fails harmlessly on the Unix domain sockets.
+            const int enabled = 1;
+            setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &enabled, sizeof(enabled));
+
+            epoll_event event {};
+            event.events = EPOLLIN;
+            event.data.fd = client;
+
+            if (epoll_ctl(m_epoll, EPOLL_CTL_ADD, client, &event) < 0)
+            {
+                ::close(client);
+                continue;
+            }
+
+            m_connections[client].id = m_next_id++;
+        }
+    }
+
+    void Server::receive(int fd)
+    {
+        auto &connection = m_connections.at(fd);
+
+        char buffer[16384];
+        while (true)
+        {
+            const auto count = ::read(fd, buffer, sizeof(buffer));
+            if (count > 0)
+            {
+                connection.input.append(buffer, count);
+                continue;
+            }
+
+            if (count == 0)
+            {
+                // Answers the remaining requests before closing the connection.
+                connection.is_closing = true;
+            }
+            else if (errno == EINTR)
+            {
+                continue;
+            }
+            else if ((errno != EAGAIN) && (errno != EWOULDBLOCK))
+            {
+                this->close_connection(fd);
+                return;
+            }
+
+            break;
+        }
+
+        const auto line_end = connection.input.rfind('\n');
+        const auto partial_length = connection.input.size() - ((line_end == string::npos) ? 0 : (line_end + 1));
+        if (partial_length > kMaxRequestLength)
+        {
+            connection.input.erase(connection.input.size() - partial_length);
+            connection.output += "ERROR The request was too long.\n";
+            connection.is_closing = true;
+        }
+
+        this->dispatch(fd);
+        this->flush(fd);
+    }
+
+    void Server::dispatch(int fd)
+    {
+        auto &connection = m_connections.at(fd);
+        if (connection.is_busy) { return; }
+
+        const auto line_end = connection.input.rfind('\n');
+        if (line_end == string::npos) { return; }
+
+        Task task { fd, connection.id, connection.input.substr(0, line_end + 1) };
+        connection.input.erase(0, line_end + 1);
+        connection.is_busy = true;
+
+        {
+            const std::lock_guard<std::mutex> lock(m_mutex);
+            m_tasks.push_back(std::move(task));
+        }
+        m_has_task.notify_one();
+    }
+
+    void Server::flush(int fd)
+    {
+        auto &connection = m_connections.at(fd);
+
+        size_t sent = 0;
+        while (sent < connection.output.size())
+        {
+            const auto count = send(fd, connection.output.data() + sent, connection.output.size() - sent, MSG_NOSIGNAL);
+            if (count >= 0)
+            {
+                sent += count;
+            }
+            else if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+            {
+                break;
+            }
+            else if (errno != EINTR)
+            {
+                this->close_connection(fd);
+                return;
+            }
+        }
+        connection.output.erase(0, sent);
+
+        if (connection.is_closing && connection.output.empty() && !connection.is_busy && (connection.input.find('\n') == string::npos))
+        {
+            this->close_connection(fd);
+            return;
+        }
+
+        this->watch(fd);
+    }
+
+    void Server::close_connection(int fd)
+    {
+        epoll_ctl(m_epoll, EPOLL_CTL_DEL, fd, nullptr);
+        ::close(fd);
+        m_connections.erase(fd);
+    }
+
+    void Server::watch(int fd)
+    {
+        const auto &connection = m_connections.at(fd);
+
+        epoll_event event {};
+        event.events = (connection.is_closing ? 0 : static_cast<std::uint32_t>(EPOLLIN)) | (connection.output.empty() ? 0 : static_cast<std::uint32_t>(EPOLLOUT));
+        event.data.fd = fd;
+
+        epoll_ctl(m_epoll, EPOLL_CTL_MOD, fd, &event);
+    }
+
+    void Server::work()
+    {
+        // Each worker keeps its own reader, so the lookups would not contend with each other.
+        auto reader = SeatingPlan::Reader(m_dispatcher.plan());
+
+        while (true)
+        {
+            Task task;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_has_task.wait(lock, [this]() { return (m_is_stopping || !m_tasks.empty()); });
+
+                if (m_tasks.empty()) { return; }
+
+                task = std::move(m_tasks.front());
+                m_tasks.pop_front();
+            }
+
+            Completion completion { task.fd, task.id, "", false };
+            auto requests = stringutil::Splitter(task.requests, "\n");
+            while (const auto request = requests.next())
+            {
+                if (stringutil::trim_view(*request).empty()) { continue; }
+
+                const auto response = m_dispatcher.handle(*request, reader);
+                completion.responses.append(response).push_back('\n');
+
+                if (response == "BYE")
+                {
+                    completion.is_quitting = true;
+                    break;
+                }
+            }
+
+            {
+                const std::lock_guard<std::mutex> lock(m_mutex);
+                m_completions.push_back(std::move(completion));
+            }
+
+            const std::uint64_t value = 1;
+            [[maybe_unused]] const auto written = ::write(m_wakeup, &value, sizeof(value));
+        }
+    }
+#endif
+}
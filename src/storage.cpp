@@ -0,0 +1,941 @@
+/**
+ * Copyright (c) 2021 Jason Kwok, Ben Ho, Ben Yip, Harry Lam, and Hins To.
+ *
+ * Licensed under the GNU Affero General Public License, Version 3.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of the License at
+ *
+ *     https://github.com/JasonHK-HKCC/SEHH2042-Group-Project/blob/master/LICENSE
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under the License
+ * is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ * or implied. See the License for the specific language governing permissions and limitations under
+ * the License.
+ **/
+
+#include "jetassign/storage.hpp"
+#include "jetassign/exceptions.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace jetassign::storage
+{
+    using std::uint16_t;
+    using std::uint32_t;
+
+    using core::FlightKey;
+    using core::FlightRegistry;
+    using core::Passenger;
+    using core::SeatingPlan;
+    using core::SeatLocation;
+
+    using exceptions::StorageError;
+
+    namespace
+    {
+        /** The magic number at the beginning of a snapshot. */
+        constexpr char kSnapshotMagic[4] = { 'J', 'A', 'S', 'P' };
+
+        /** The magic number at the beginning of a journal. */
+        constexpr char kJournalMagic[4] = { 'J', 'A', 'S', 'J' };
+
+        /** The version of the journal format. */
+        constexpr uint16_t kJournalVersion = 1;
+
+        /** The size of the journal header. */
+        constexpr size_t kJournalHeaderSize = sizeof(kJournalMagic) + 2 + 4;
+
+        /** The journal and the ticket of the latest record appended by the calling thread. */
+        thread_local std::pair<const Journal*, size_t> t_last_ticket;
+
+        /** The operations that were recorded in the journal. */
+        enum JournalOperation : std::uint8_t
+        {
+            kJournalAssign = 1,
+            kJournalRemove = 2,
+            kJournalTransaction = 3,
+        };
+
+        /**
+         * Appends little-endian integers and length-prefixed strings to a buffer.
+         **/
+        class ByteWriter
+        {
+            public:
+                ByteWriter(string &buffer) : m_buffer { buffer } {}
+
+                void write_u8(std::uint8_t value)
+                {
+                    m_buffer.push_back(static_cast<char>(value));
+                }
+
+                void write_u16(uint16_t value)
+                {
+                    m_buffer.push_back(static_cast<char>(value & 0xFF));
+                    m_buffer.push_back(static_cast<char>((value >> 8) & 0xFF));
+                }
+
+                void write_u32(uint32_t value)
+                {
+                    write_u16(static_cast<uint16_t>(value & 0xFFFF));
+                    write_u16(static_cast<uint16_t>(value >> 16));
+                }
+
+                void write_string(string_view value)
+                {
+                    if (value.size() > UINT16_MAX)
+                    {
+                        throw StorageError("The string was too long to be saved.");
+                    }
+
+                    write_u16(static_cast<uint16_t>(value.size()));
+                    m_buffer.append(value);
+                }
+
+            private:
+                string &m_buffer;
+        };
+
+        /**
+         * Reads little-endian integers and length-prefixed strings from a buffer.
+         **/
+        class ByteReader
+        {
+            public:
+                ByteReader(string_view buffer) : m_buffer { buffer }, m_position { 0 } {}
+
+                bool at_end() const { return (m_position == m_buffer.size()); }
+
+                string_view read_bytes(size_t size)
+                {
+                    if (size > (m_buffer.size() - m_position))
+                    {
+                        throw StorageError("The snapshot was truncated.");
+                    }
+
+                    const auto bytes = m_buffer.substr(m_position, size);
+                    m_position += size;
+
+                    return bytes;
+                }
+
+                std::uint8_t read_u8()
+                {
+                    return static_cast<std::uint8_t>(read_bytes(1)[0]);
+                }
+
+                uint16_t read_u16()
+                {
+                    const auto bytes = read_bytes(2);
+                    return static_cast<uint16_t>(
+                        static_cast<unsigned char>(bytes[0]) | (static_cast<unsigned char>(bytes[1]) << 8));
+                }
+
+                uint32_t read_u32()
+                {
+                    const uint32_t low = read_u16();
+                    const uint32_t high = read_u16();
+
+                    return (low | (high << 16));
+                }
+
+                string_view read_string()
+                {
+                    return read_bytes(read_u16());
+                }
+
+            private:
+                string_view m_buffer;
+                size_t m_position;
+        };
+
+        /**
+         * Computes the 32-bit FNV-1a hash of the data.
+         *
+         * @param data The data.
+         **/
+        uint32_t fnv1a(string_view data)
+        {
+            uint32_t hash = 2166136261u;
+            for (const auto byte : data)
+            {
+                hash = (hash ^ static_cast<unsigned char>(byte)) * 16777619u;
+            }
+
+            return hash;
+        }
+
+        /**
+         * Reads the whole file, or nothing if the file does not exist.
+         *
+         * @param path The path of the file.
+         **/
+        optional<string> read_file(const string &path)
+        {
+            std::ifstream input(path, std::ios::binary);
+            if (!input)
+            {
+                return std::nullopt;
+            }
+
+            input.seekg(0, std::ios::end);
+            string content(static_cast<size_t>(input.tellg()), '\0');
+            input.seekg(0, std::ios::beg);
+
+            if (!input.read(content.data(), content.size()))
+            {
+                throw StorageError("Unable to read \"" + path + "\".");
+            }
+
+            return content;
+        }
+
+        /**
+         * The result of scanning a journal.
+         **/
+        struct JournalScan
+        {
+            /** The generation of the journal, or nothing if the header was not valid. */
+            optional<uint32_t> generation;
+
+            /** The size of the header and the complete records. */
+            size_t valid_size = 0;
+
+            /** The number of complete records. */
+            size_t records = 0;
+        };
+
+        /**
+         * Scans the complete records of a journal, stops at the first incomplete or corrupted record.
+         * The errors thrown by on_record were passed to the caller.
+         *
+         * @param journal   The content of the journal.
+         * @param on_record Receives the payload of each complete record.
+         **/
+        JournalScan scan_journal(string_view journal, const std::function<void(string_view)> &on_record)
+        {
+            JournalScan scan;
+
+            auto reader = ByteReader(journal);
+            try
+            {
+                if ((reader.read_bytes(sizeof(kJournalMagic)) != string_view(kJournalMagic, sizeof(kJournalMagic)))
+                    || (reader.read_u16() != kJournalVersion))
+                {
+                    return scan;
+                }
+
+                scan.generation = reader.read_u32();
+                scan.valid_size = kJournalHeaderSize;
+            }
+            catch (const StorageError&)
+            {
+                // The journal ends within its header.
+                return scan;
+            }
+
+            while (!reader.at_end())
+            {
+                string_view payload;
+                try
+                {
+                    payload = reader.read_bytes(reader.read_u32());
+                    if (reader.read_u32() != fnv1a(payload)) { break; }
+                }
+                catch (const StorageError&)
+                {
+                    // The journal ends with an incomplete record.
+                    break;
+                }
+
+                if (on_record) { on_record(payload); }
+
+                scan.valid_size += (4 + payload.size() + 4);
+                scan.records++;
+            }
+
+            return scan;
+        }
+
+        /**
+         * Serializes a seating plan.
+         *
+         * @param writer The writer of the snapshot.
+         * @param key    The flight number and departure date.
+         * @param plan   The seating plan.
+         **/
+        void write_plan(ByteWriter &writer, const FlightKey &key, const SeatingPlan &plan)
+        {
+            const auto &layout = plan.layout();
+
+            writer.write_string(key.flight_number);
+            writer.write_string(key.date);
+            writer.write_u32(static_cast<uint32_t>(layout.rows()));
+            writer.write_u32(static_cast<uint32_t>(layout.columns()));
+
+            std::vector<std::pair<size_t, const Passenger*>> passengers;
+            for (size_t row = 0; row < layout.rows(); row++)
+            {
+                for (size_t column = 0; column < layout.columns(); column++)
+                {
+                    const auto &maybe_passenger = plan.at(row, column);
+                    if (maybe_passenger)
+                    {
+                        passengers.emplace_back(layout.index_of(row, column), &*maybe_passenger);
+                    }
+                }
+            }
+
+            writer.write_u32(static_cast<uint32_t>(passengers.size()));
+            for (const auto &[index, passenger] : passengers)
+            {
+                writer.write_u32(static_cast<uint32_t>(index));
+                writer.write_string(passenger->name());
+                writer.write_string(passenger->passport_id());
+            }
+        }
+
+        /**
+         * Deserializes a seating plan.
+         *
+         * @param reader The reader of the snapshot.
+         * @param plan   The empty seating plan to restore into.
+         **/
+        void read_plan(ByteReader &reader, SeatingPlan &plan)
+        {
+            const auto &layout = plan.layout();
+
+            const auto rows = reader.read_u32();
+            const auto columns = reader.read_u32();
+            if ((rows != layout.rows()) || (columns != layout.columns()))
+            {
+                throw StorageError("The snapshot was saved with a different cabin layout.");
+            }
+
+            // Publishes the restored seats at once.
+            const auto deferred_publication = SeatingPlan::DeferredPublication(plan);
+
+            const auto count = reader.read_u32();
+            for (uint32_t i = 0; i < count; i++)
+            {
+                const auto index = reader.read_u32();
+                const auto name = reader.read_string();
+                const auto passport_id = reader.read_string();
+
+                if (index >= layout.seats())
+                {
+                    throw StorageError("The snapshot contains a seat outside the cabin layout.");
+                }
+
+                plan.assign(SeatLocation(index / columns, index % columns), Passenger(string(name), string(passport_id)));
+            }
+        }
+    }
+
+    string write_snapshot(const SeatingPlan &seating_plan, const FlightRegistry &flights, uint32_t generation, Journal *journal)
+    {
+        const auto registered_flights = flights.flights();
+
+        string snapshot;
+        auto writer = ByteWriter(snapshot);
+
+        snapshot.append(kSnapshotMagic, sizeof(kSnapshotMagic));
+        writer.write_u16(kSnapshotVersion);
+        writer.write_u16(0);
+        writer.write_u32(generation);
+        writer.write_u32(static_cast<uint32_t>(registered_flights.size()));
+
+        // The seating plan of the console comes first, without a flight number and date.
+        write_plan(writer, FlightKey(), seating_plan);
+        if (journal != nullptr) { journal->capture(seating_plan); }
+
+        for (const auto &flight : registered_flights)
+        {
+            flight->read([&](const SeatingPlan &plan)
+            {
+                write_plan(writer, flight->key(), plan);
+                if (journal != nullptr) { journal->capture(plan); }
+            });
+        }
+
+        return snapshot;
+    }
+
+    uint32_t read_snapshot(string_view snapshot, SeatingPlan &seating_plan, FlightRegistry &flights)
+    {
+        auto reader = ByteReader(snapshot);
+
+        if (reader.read_bytes(sizeof(kSnapshotMagic)) != string_view(kSnapshotMagic, sizeof(kSnapshotMagic)))
+        {
+            throw StorageError("The file was not a snapshot of JetAssign.");
+        }
+
+        const auto version = reader.read_u16();
+        if ((version < 1) || (version > kSnapshotVersion))
+        {
+            throw StorageError("The version of the snapshot was not supported.");
+        }
+
+        reader.read_u16();
+        // Snapshots of version 1 were saved without the journal.
+        const auto generation = (version >= 2) ? reader.read_u32() : 0;
+        const auto flight_count = reader.read_u32();
+
+        try
+        {
+            // The seating plan of the console.
+            reader.read_string();
+            reader.read_string();
+            read_plan(reader, seating_plan);
+
+            for (uint32_t i = 0; i < flight_count; i++)
+            {
+                auto key = FlightKey();
+                key.flight_number = reader.read_string();
+                key.date = reader.read_string();
+
+                flights.open(key)->modify([&](SeatingPlan &plan) { read_plan(reader, plan); });
+            }
+        }
+        catch (const std::range_error &e)
+        {
+            throw StorageError("The snapshot contains a seat outside the cabin layout.");
+        }
+        catch (const exceptions::SeatOccupiedError &e)
+        {
+            throw StorageError("The snapshot contains a seat that was assigned twice.");
+        }
+        catch (const exceptions::PassengerAssignedError &e)
+        {
+            throw StorageError("The snapshot contains a passenger that was assigned twice.");
+        }
+        catch (const exceptions::SeatBlockedError &e)
+        {
+            throw StorageError("The snapshot contains a seat that was blocked by the cabin layout.");
+        }
+
+        if (!reader.at_end())
+        {
+            throw StorageError("The snapshot contains unexpected trailing data.");
+        }
+
+        return generation;
+    }
+
+    size_t save_snapshot(const string &path, const SeatingPlan &seating_plan, const FlightRegistry &flights, uint32_t generation, Journal *journal)
+    {
+        const auto snapshot = write_snapshot(seating_plan, flights, generation, journal);
+        const auto temporary_path = path + ".tmp";
+
+        // Writes the whole snapshot into a temporary file first, so the previous snapshot will be
+        // kept intact if anything goes wrong.
+        const auto file = std::fopen(temporary_path.c_str(), "wb");
+        if (file == nullptr)
+        {
+            throw StorageError("Unable to create \"" + temporary_path + "\".");
+        }
+
+        const auto written = std::fwrite(snapshot.data(), 1, snapshot.size(), file);
+        sync_file(file);
+
+        if ((std::fclose(file) != 0) || (written != snapshot.size()))
+        {
+            std::remove(temporary_path.c_str());
+            throw StorageError("Unable to write \"" + temporary_path + "\".");
+        }
+
+        std::error_code error;
+        std::filesystem::rename(temporary_path, path, error);
+        if (error)
+        {
+            std::remove(temporary_path.c_str());
+            throw StorageError("Unable to replace \"" + path + "\": " + error.message());
+        }
+
+        return snapshot.size();
+    }
+
+    optional<uint32_t> load_snapshot(const string &path, SeatingPlan &seating_plan, FlightRegistry &flights)
+    {
+        // Reads the whole snapshot at once.
+        const auto snapshot = read_file(path);
+        if (!snapshot)
+        {
+            return std::nullopt;
+        }
+
+        return read_snapshot(*snapshot, seating_plan, flights);
+    }
+
+    Journal::Journal(const string &path, uint32_t generation, std::chrono::milliseconds commit_interval)
+        : m_path { path },
+          m_file { nullptr },
+          m_commit_interval { commit_interval },
+          m_compacting { false },
+          m_generation { generation },
+          m_appended { 0 },
+          m_durable { 0 },
+          m_discarded { 0 },
+          m_sync_waiters { 0 },
+          m_failed { false },
+          m_closing { false }
+    {
+        const auto journal = read_file(path);
+        const auto scan = journal ? scan_journal(*journal, nullptr) : JournalScan();
+
+        if (scan.generation == generation)
+        {
+            // Continues the journal, without the incomplete record at the end, if any.
+            if (scan.valid_size != journal->size()) { std::filesystem::resize_file(path, scan.valid_size); }
+
+            m_file = std::fopen(path.c_str(), "ab");
+            m_appended = m_durable = scan.records;
+        }
+
+        if (m_file == nullptr)
+        {
+            reset(generation);
+        }
+
+        m_writer = std::thread(&Journal::run, this);
+    }
+
+    Journal::~Journal()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_closing = true;
+        }
+
+        m_condition.notify_all();
+        m_writer.join();
+
+        if (m_file != nullptr) { std::fclose(m_file); }
+    }
+
+    void Journal::attach(SeatingPlan &plan, const FlightKey &key)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_flights[&plan] = key;
+        }
+
+        plan.subscribe(this);
+    }
+
+    void Journal::detach(SeatingPlan &plan)
+    {
+        plan.unsubscribe(this);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_flights.erase(&plan);
+        m_uncaptured.erase(&plan);
+    }
+
+    void Journal::on_assigned(const SeatingPlan &plan, const SeatLocation &location, const Passenger &passenger)
+    {
+        append(kJournalAssign, plan, location, passenger);
+    }
+
+    void Journal::on_removed(const SeatingPlan &plan, const SeatLocation &location, const Passenger &passenger)
+    {
+        append(kJournalRemove, plan, location, passenger);
+    }
+
+    size_t Journal::ticket() const
+    {
+        return ((t_last_ticket.first == this) ? t_last_ticket.second : 0);
+    }
+
+    void Journal::wait(size_t ticket)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        if ((m_durable < ticket) && !m_failed)
+        {
+            m_sync_waiters++;
+            m_condition.notify_all();
+            m_condition.wait(lock, [&]() { return ((m_durable >= ticket) || m_failed); });
+            m_sync_waiters--;
+        }
+
+        if (m_failed)
+        {
+            throw StorageError("Unable to write the journal \"" + m_path + "\".");
+        }
+    }
+
+    void Journal::sync()
+    {
+        size_t target;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            target = m_appended;
+        }
+
+        this->wait(target);
+    }
+
+    uint32_t Journal::generation() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_generation;
+    }
+
+    size_t Journal::size() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return (m_appended - m_discarded);
+    }
+
+    uint32_t Journal::begin_compaction()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        // The plans that were attached later were not saved, so they were held from the start.
+        m_compacting = true;
+        m_uncaptured.clear();
+        for (const auto &[plan, key] : m_flights) { m_uncaptured.insert(plan); }
+
+        return (m_generation + 1);
+    }
+
+    void Journal::capture(const SeatingPlan &plan)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_uncaptured.erase(&plan);
+    }
+
+    void Journal::cancel_compaction()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_compacting = false;
+            m_uncaptured.clear();
+        }
+
+        m_condition.notify_all();
+    }
+
+    void Journal::reset(uint32_t generation)
+    {
+        if (m_writer.joinable()) { sync(); }
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        if (m_file != nullptr) { std::fclose(m_file); }
+
+        m_file = std::fopen(m_path.c_str(), "wb");
+        if (m_file == nullptr)
+        {
+            throw StorageError("Unable to create the journal \"" + m_path + "\".");
+        }
+
+        string header(kJournalMagic, sizeof(kJournalMagic));
+        auto writer = ByteWriter(header);
+        writer.write_u16(kJournalVersion);
+        writer.write_u32(generation);
+
+        std::fwrite(header.data(), 1, header.size(), m_file);
+        sync_file(m_file);
+
+        m_generation = generation;
+        m_discarded = m_appended;
+
+        // Releases the held changes into the new generation.
+        m_compacting = false;
+        m_uncaptured.clear();
+
+        lock.unlock();
+        m_condition.notify_all();
+    }
+
+    void Journal::on_transaction_begun(const SeatingPlan &plan)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_flights.count(&plan)) { m_transactions[&plan]; }
+    }
+
+    void Journal::on_transaction_ended(const SeatingPlan &plan, bool committed)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            this->wait_for_capture(lock, plan);
+
+            const auto transaction = m_transactions.find(&plan);
+            if (transaction == m_transactions.end()) { return; }
+
+            const auto [changes, count] = std::move(transaction->second);
+            m_transactions.erase(transaction);
+
+            const auto flight = m_flights.find(&plan);
+            if (!committed || (count == 0) || (flight == m_flights.end())) { return; }
+
+            const auto start = this->begin_record();
+
+            auto writer = ByteWriter(m_pending);
+            writer.write_u8(kJournalTransaction);
+            writer.write_string(flight->second.flight_number);
+            writer.write_string(flight->second.date);
+            writer.write_u32(count);
+            m_pending.append(changes);
+
+            t_last_ticket = { this, this->end_record(start) };
+        }
+
+        m_condition.notify_all();
+    }
+
+    void Journal::append(std::uint8_t operation, const SeatingPlan &plan, const SeatLocation &location, const Passenger &passenger)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            this->wait_for_capture(lock, plan);
+
+            const auto flight = m_flights.find(&plan);
+            if (flight == m_flights.end()) { return; }
+
+            const auto seat = static_cast<uint32_t>(plan.layout().index_of(location.row(), location.column()));
+
+            // The changes of a transaction were held until it was committed.
+            const auto transaction = m_transactions.find(&plan);
+            if (transaction != m_transactions.end())
+            {
+                auto writer = ByteWriter(transaction->second.first);
+                writer.write_u8(operation);
+                writer.write_u32(seat);
+                writer.write_string(passenger.name());
+                writer.write_string(passenger.passport_id());
+
+                transaction->second.second++;
+                return;
+            }
+
+            const auto start = this->begin_record();
+
+            auto writer = ByteWriter(m_pending);
+            writer.write_u8(operation);
+            writer.write_string(flight->second.flight_number);
+            writer.write_string(flight->second.date);
+            writer.write_u32(seat);
+            writer.write_string(passenger.name());
+            writer.write_string(passenger.passport_id());
+
+            t_last_ticket = { this, this->end_record(start) };
+        }
+
+        m_condition.notify_all();
+    }
+
+    void Journal::wait_for_capture(std::unique_lock<std::mutex> &lock, const SeatingPlan &plan)
+    {
+        // The saved state of a captured plan excludes the change, which must not be discarded by
+        // reset() along with the saved ones. Its flight was still locked, but the compaction never
+        // locks a flight again after capturing it.
+        m_condition.wait(lock, [&]() { return (!m_compacting || (m_uncaptured.count(&plan) > 0) || !m_flights.count(&plan)); });
+    }
+
+    size_t Journal::begin_record()
+    {
+        // Reserves the length of the payload, which will be filled after the payload was written.
+        const auto start = m_pending.size();
+        m_pending.append(4, '\0');
+
+        return start;
+    }
+
+    size_t Journal::end_record(size_t start)
+    {
+        const auto payload_size = static_cast<uint32_t>(m_pending.size() - start - 4);
+        for (size_t i = 0; i < 4; i++)
+        {
+            m_pending[start + i] = static_cast<char>((payload_size >> (8 * i)) & 0xFF);
+        }
+
+        ByteWriter(m_pending).write_u32(fnv1a(string_view(m_pending).substr(start + 4, payload_size)));
+
+        return ++m_appended;
+    }
+
+    void Journal::run()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true)
+        {
+            // Waits for the first record of a group.
+            m_condition.wait(lock, [&]() { return (m_closing || !m_pending.empty()); });
+
+            // Gathers more records into the group, unless someone was waiting for them.
+            m_condition.wait_for(lock, m_commit_interval, [&]() { return (m_closing || (m_sync_waiters > 0)); });
+
+            if (!m_pending.empty())
+            {
+                string group;
+                group.swap(m_pending);
+                const auto appended = m_appended;
+
+                // Writes and synchronizes the whole group at once, without blocking the appenders.
+                lock.unlock();
+                const auto written = std::fwrite(group.data(), 1, group.size(), m_file);
+                sync_file(m_file);
+                const auto is_failed = ((written != group.size()) || std::ferror(m_file));
+                lock.lock();
+
+                m_failed = (m_failed || is_failed);
+                m_durable = appended;
+                m_condition.notify_all();
+            }
+
+            if (m_closing && m_pending.empty()) { break; }
+        }
+    }
+
+    size_t replay_journal(const string &path, uint32_t generation, SeatingPlan &seating_plan, FlightRegistry &flights)
+    {
+        const auto journal = read_file(path);
+        if (!journal)
+        {
+            return 0;
+        }
+
+        /**
+         * Applies a record to the seating plans.
+         *
+         * @param payload The payload of the record.
+         **/
+        const auto apply = [&](string_view payload)
+        {
+            auto reader = ByteReader(payload);
+
+            const auto operation = reader.read_u8();
+            auto key = FlightKey();
+            key.flight_number = reader.read_string();
+            key.date = reader.read_string();
+
+            /**
+             * Applies a change of the record to the seating plan.
+             *
+             * @param plan             The seating plan.
+             * @param change_operation The operation of the change.
+             **/
+            const auto replay_change = [&](SeatingPlan &plan, std::uint8_t change_operation)
+            {
+                const auto index = reader.read_u32();
+                const auto name = reader.read_string();
+                const auto passport_id = reader.read_string();
+
+                const auto columns = plan.layout().columns();
+                if (index >= plan.layout().seats())
+                {
+                    throw StorageError("The journal contains a seat outside the cabin layout.");
+                }
+
+                const auto location = SeatLocation(index / columns, index % columns);
+                if (change_operation == kJournalAssign)
+                {
+                    plan.assign(location, Passenger(string(name), string(passport_id)));
+                }
+                else if (change_operation == kJournalRemove)
+                {
+                    plan.remove(location);
+                }
+                else
+                {
+                    throw StorageError("The journal contains an unknown operation.");
+                }
+            };
+
+            const auto replay = [&](SeatingPlan &plan)
+            {
+                if (operation != kJournalTransaction)
+                {
+                    replay_change(plan, operation);
+                    return;
+                }
+
+                // The changes of a transaction were complete, as the whole record was checked.
+                for (auto count = reader.read_u32(); count > 0; count--)
+                {
+                    replay_change(plan, reader.read_u8());
+                }
+            };
+
+            if (key == FlightKey())
+            {
+                replay(seating_plan);
+            }
+            else
+            {
+                flights.open(key)->modify(replay);
+            }
+        };
+
+        // The journal of other generations were already included in the snapshot, or belongs to a
+        // newer snapshot that was lost.
+        if (scan_journal(*journal, nullptr).generation != generation)
+        {
+            return 0;
+        }
+
+        // A complete record that could not be applied fails the startup, rather than being skipped
+        // along with the records after it, which would be lost at the next compaction.
+        size_t record = 0;
+
+        // Publishes the replayed seats of the default flight at once. The other flights were only
+        // modified under their locks, thus they publish each change, which copies one chunk only.
+        const auto deferred_publication = SeatingPlan::DeferredPublication(seating_plan);
+        return scan_journal(*journal, [&](string_view payload)
+        {
+            record++;
+            try
+            {
+                apply(payload);
+            }
+            catch (const std::exception &e)
+            {
+                throw StorageError("The record " + std::to_string(record) + " of the journal could not be applied: " + e.what());
+            }
+        }).records;
+    }
+
+    size_t compact(const string &path, Journal &journal, const SeatingPlan &seating_plan, const FlightRegistry &flights)
+    {
+        // The snapshot includes every recorded change, so the journal continues with a new generation.
+        // The changes after a plan was saved were held until then, rather than being discarded.
+        const auto generation = journal.begin_compaction();
+
+        size_t size;
+        try
+        {
+            size = save_snapshot(path, seating_plan, flights, generation, &journal);
+        }
+        catch (...)
+        {
+            journal.cancel_compaction();
+            throw;
+        }
+
+        journal.reset(generation);
+
+        return size;
+    }
+
+    void sync_file(std::FILE *file)
+    {
+        std::fflush(file);
+
+        #ifdef _WIN32
+        _commit(_fileno(file));
+        #else
+        fsync(fileno(file));
+        #endif
+    }
+}
@@ -0,0 +1,149 @@
+/**
+ * Copyright (c) 2021 Jason Kwok, Ben Ho, Ben Yip, Harry Lam, and Hins To.
+ *
+ * Licensed under the GNU Affero General Public License, Version 3.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of the License at
+ *
+ *     https://github.com/JasonHK-HKCC/SEHH2042-Group-Project/blob/master/LICENSE
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under the License
+ * is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ * or implied. See the License for the specific language governing permissions and limitations under
+ * the License.
+ **/
+
+#include "jetassign/stringutil.hpp"
+
+#include <algorithm>
+#include <cctype>
+
+namespace stringutil
+{
+    namespace
+    {
+        /**
+         * The set of characters that considered whitespace characters.
+         **/
+        const auto kWhitespace = "\t\n\v\f\r\x20\xA0";
+    }
+
+    string trim(const string &input)
+    {
+        return string(trim_view(input));
+    }
+
+    string trim_start(const string &input)
+    {
+        return string(trim_start_view(input));
+    }
+
+    string trim_end(const string &input)
+    {
+        return string(trim_end_view(input));
+    }
+
+    string_view trim_view(string_view input)
+    {
+        return trim_end_view(trim_start_view(input));
+    }
+
+    string_view trim_start_view(string_view input)
+    {
+        /** The position of the first character that not a whitespace character. */
+        const auto index = input.find_first_not_of(kWhitespace);
+
+        // Returns the view without the leading whitespaces if there were some non-whitespace
+        // characters, otherwise returns an empty view.
+        return ((index == string_view::npos) ? string_view() : input.substr(index));
+    }
+
+    string_view trim_end_view(string_view input)
+    {
+        /** The position of the last character that not a whitespace character. */
+        const auto index = input.find_last_not_of(kWhitespace);
+
+        // Returns the view without the trailing whitespaces if there were some non-whitespace
+        // characters, otherwise returns an empty view.
+        return ((index == string_view::npos) ? string_view() : input.substr(0, index + 1));
+    }
+
+    string to_uppercase(string_view input)
+    {
+        string output(input.size(), '\0');
+        std::transform(input.begin(), input.end(), output.begin(), [](char c) { return to_uppercase(c); });
+
+        return output;
+    }
+
+    char to_uppercase(char input)
+    {
+        return ((input >= 'a') && (input <= 'z')) ? static_cast<char>(input - 'a' + 'A') : input;
+    }
+
+    string fold(string_view input)
+    {
+        string output;
+        output.reserve(input.size());
+
+        for (const auto character : trim_view(input))
+        {
+            if (character == ' ')
+            {
+                if (output.back() != ' ') { output.push_back(' '); }
+            }
+            else
+            {
+                output.push_back(to_uppercase(character));
+            }
+        }
+
+        return output;
+    }
+
+    vector<string> split(const string &input, const string &separator)
+    {
+        // This function resembles JavaScript's String.prototype.split function.
+
+        /** The views of the segments that were split from the input. */
+        const auto views = split_view(input, separator);
+
+        return vector<string>(views.begin(), views.end());
+    }
+
+    vector<string_view> split_view(string_view input, string_view separator)
+    {
+        /** The segments that were split from the input. */
+        vector<string_view> segments;
+
+        auto splitter = Splitter(input, separator);
+        while (const auto segment = splitter.next())
+        {
+            segments.push_back(*segment);
+        }
+
+        return segments;
+    }
+
+    Splitter::Splitter(string_view input, string_view separator)
+        : m_input { input }, m_separator { separator }, m_position { 0 }, m_finished { false } {}
+
+    optional<string_view> Splitter::next()
+    {
+        if (m_finished) { return std::nullopt; }
+
+        // The whole input is a segment if the separator was empty.
+        const auto index = m_separator.empty() ? string_view::npos : m_input.find(m_separator, m_position);
+        if (index == string_view::npos)
+        {
+            // The remaining of the input is the last segment.
+            m_finished = true;
+            return m_input.substr(m_position);
+        }
+
+        /** The segment that ends before the separator. */
+        const auto segment = m_input.substr(m_position, index - m_position);
+        m_position = index + m_separator.size();
+
+        return segment;
+    }
+}
@@ -1,9 +1,86 @@
 #include "catch.hpp"
 
-#include "JetAssign.cpp"
+#include "jetassign/console.hpp"
+#include "jetassign/core.hpp"
+#include "jetassign/database.hpp"
+#include "jetassign/exceptions.hpp"
+#include "jetassign/input.hpp"
+#include "jetassign/search.hpp"
+#include "jetassign/seatmap.hpp"
+#include "jetassign/server.hpp"
+#include "jetassign/storage.hpp"
+#include "jetassign/stringutil.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <new>
+#include <random>
+#include <regex>
+#include <sstream>
+#include <thread>
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    /** Whether the allocations should be counted. */
+    thread_local bool is_counting_allocations = false;
+
+    /** The number of allocations that were counted. */
+    thread_local size_t allocation_count = 0;
+
+    /**
+     * Activates a cabin layout until the end of the scope, then restores the default layout, even
+     * if a requirement failed in between.
+     **/
+    class ScopedLayout
+    {
+        public:
+            explicit ScopedLayout(const jetassign::core::CabinLayout &layout) { jetassign::core::CabinLayout::activate(layout); }
+
+            ScopedLayout(const ScopedLayout&) = delete;
+
+            ScopedLayout& operator =(const ScopedLayout&) = delete;
+
+            ~ScopedLayout() { jetassign::core::CabinLayout::activate(jetassign::core::CabinLayout()); }
+    };
+}
+
+void* operator new(size_t size)
+{
+    if (is_counting_allocations) { allocation_count++; }
+
+    if (const auto pointer = std::malloc((size == 0) ? 1 : size)) { return pointer; }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, size_t /* size */) noexcept
+{
+    std::free(pointer);
+}
 
 namespace
 {
+    using std::optional;
+    using std::string;
+    using std::string_view;
     using std::vector;
     
     using std::make_tuple;
@@ -107,6 +184,2086 @@ namespace
         }
     }
 
+    TEST_CASE("jetassign::core::Passenger")
+    {
+        using jetassign::core::Passenger;
+        using jetassign::core::PassportId;
+
+        const auto chan = Passenger("Chan Tai Man", "HK12345678A");
+        const auto name = string("Chan Tai Man");
+
+        // The names were interned, and the passport IDs were stored inline.
+        REQUIRE(Passenger(name, "HK11111111C").name().data() == chan.name().data());
+        REQUIRE(chan.passport_id() == "HK12345678A");
+        REQUIRE(sizeof(Passenger) <= 32);
+
+        REQUIRE(chan == Passenger(name, "HK12345678A"));
+        REQUIRE(chan != Passenger("Chan Tai Ming", "HK12345678A"));
+        REQUIRE(chan != Passenger(name, "HK12345678B"));
+
+        REQUIRE(PassportId("HK1234567890ABC").view() == "HK1234567890ABC");
+        REQUIRE_THROWS_AS(Passenger(name, "HK1234567890ABCD"), std::length_error);
+
+        WHEN("the last passenger with a name was destroyed")
+        {
+            const auto interned_names = Passenger::interned_names();
+            {
+                auto lee = Passenger("Lee Siu Lung", "HK11111111C");
+                const auto copy = lee;
+                REQUIRE(Passenger::interned_names() == interned_names + 1);
+
+                lee = chan;
+                REQUIRE(copy.name() == "Lee Siu Lung");
+                REQUIRE(lee.name().data() == chan.name().data());
+            }
+
+            // The name was released, rather than kept until the end of the program.
+            REQUIRE(Passenger::interned_names() == interned_names);
+            REQUIRE(chan.name() == "Chan Tai Man");
+        }
+    }
+
+    TEST_CASE("jetassign::core::SeatingPlan::location_of")
+    {
+        using jetassign::core::Passenger;
+        using jetassign::core::SeatingPlan;
+        using jetassign::core::SeatLocation;
+
+        auto plan = SeatingPlan();
+        const auto passenger = Passenger("Chan Tai Man", "HK12345678A");
+
+        WHEN("the passenger was not assigned")
+        {
+            REQUIRE_FALSE(plan.location_of("HK12345678A"));
+            REQUIRE_FALSE(plan.location_of(passenger));
+            REQUIRE_FALSE(plan.is_assigned(passenger));
+        }
+
+        WHEN("the passenger was assigned")
+        {
+            plan.assign(SeatLocation(9, 3), passenger);
+
+            REQUIRE(plan.location_of("HK12345678A") == SeatLocation(9, 3));
+            REQUIRE(plan.location_of(passenger) == SeatLocation(9, 3));
+
+            AND_WHEN("another passenger with the same passport ID was looked up")
+            {
+                REQUIRE(plan.is_assigned("HK12345678A"));
+                REQUIRE_FALSE(plan.is_assigned(Passenger("Chan Siu Ming", "HK12345678A")));
+            }
+
+            AND_WHEN("another passenger with the same passport ID was assigned")
+            {
+                REQUIRE_THROWS_AS(
+                    plan.assign(SeatLocation(0, 0), Passenger("Chan Siu Ming", "HK12345678A")),
+                    jetassign::exceptions::PassengerAssignedError);
+                REQUIRE_FALSE(plan.is_occupied(0, 0));
+            }
+
+            AND_WHEN("the passenger was removed by the seat location")
+            {
+                plan.remove(SeatLocation(9, 3));
+
+                REQUIRE_FALSE(plan.location_of("HK12345678A"));
+                REQUIRE_FALSE(plan.is_occupied(9, 3));
+            }
+
+            AND_WHEN("the passenger was removed by the passenger")
+            {
+                plan.remove(passenger);
+
+                REQUIRE_FALSE(plan.location_of("HK12345678A"));
+                REQUIRE_FALSE(plan.is_occupied(9, 3));
+
+                plan.assign(SeatLocation(0, 0), passenger);
+                REQUIRE(plan.location_of(passenger) == SeatLocation(0, 0));
+            }
+        }
+    }
+
+    TEST_CASE("jetassign::core::CabinLayout::load")
+    {
+        using jetassign::core::CabinLayout;
+        using jetassign::core::TicketClass;
+        using jetassign::exceptions::MalformedInputError;
+
+        WHEN("the descriptor was valid")
+        {
+            std::istringstream input(
+                "# A widebody cabin.\n"
+                "rows     = 62\n"
+                "columns  = ABC DEFG HJK\n"
+                "first    = 1-3\n"
+                "business = 4-12\n"
+                "blocked  = 1B 30D\n");
+
+            const auto layout = CabinLayout::load(input);
+
+            REQUIRE(layout.rows() == 62);
+            REQUIRE(layout.columns() == 10);
+            REQUIRE(layout.column_letter(8) == 'J');
+            REQUIRE(layout.column_of('J') == 8);
+            REQUIRE_FALSE(layout.column_of('I'));
+
+            REQUIRE(layout.has_aisle_after(2));
+            REQUIRE(layout.has_aisle_after(6));
+            REQUIRE_FALSE(layout.has_aisle_after(9));
+
+            REQUIRE(layout.ticket_class(2) == TicketClass::kFirst);
+            REQUIRE(layout.ticket_class(11) == TicketClass::kBusiness);
+            REQUIRE(layout.ticket_class(12) == TicketClass::kEconomy);
+
+            REQUIRE(layout.is_blocked(0, 1));
+            REQUIRE(layout.is_blocked(29, 3));
+            REQUIRE_FALSE(layout.is_blocked(0, 0));
+
+            AND_WHEN("the layout was activated")
+            {
+                const auto scoped_layout = ScopedLayout(layout);
+
+                // The seat locations were validated against the layout without sharing its ownership.
+                REQUIRE(&CabinLayout::current() == CabinLayout::active().get());
+                REQUIRE(jetassign::core::SeatLocation(61, 9).ticket_class() == TicketClass::kEconomy);
+                REQUIRE(jetassign::core::SeatLocation::column_to_string(8) == "J");
+                REQUIRE_THROWS_AS(jetassign::core::SeatLocation(62, 0), std::range_error);
+            }
+        }
+
+        WHEN("the descriptor was malformed")
+        {
+            const string descriptor = GENERATE(
+                "rows = 10\n",
+                "columns = ABC\n",
+                "rows = 0\ncolumns = ABC\n",
+                "rows = 10\ncolumns = AAB\n",
+                "rows = 10\ncolumns = ABC\nfirst = 5-11\n",
+                "rows = 10\ncolumns = ABC\nfirst = 1x-3\n",
+                "rows = 10\ncolumns = ABC\nbusiness = 2-5abc\n",
+                "rows = 10\ncolumns = ABC\neconomy = -3\n",
+                "rows = 10\ncolumns = ABC\nblocked = 1D\n",
+                "rows = 10\ncolumns = ABC\nseats = 30\n");
+
+            std::istringstream input(descriptor);
+            REQUIRE_THROWS_AS(CabinLayout::load(input), MalformedInputError);
+        }
+    }
+
+    TEST_CASE("jetassign::input::parsers::parse_seat_location")
+    {
+        using jetassign::core::CabinLayout;
+        using jetassign::core::SeatLocation;
+        using jetassign::exceptions::MalformedInputError;
+        using jetassign::input::parsers::parse_seat_location;
+
+        WHEN("the default layout was active")
+        {
+            REQUIRE(parse_seat_location("10D") == SeatLocation(9, 3));
+            REQUIRE(parse_seat_location(" 1a ") == SeatLocation(0, 0));
+
+            REQUIRE_THROWS_AS(parse_seat_location("14A"), MalformedInputError);
+            REQUIRE_THROWS_AS(parse_seat_location("01A"), MalformedInputError);
+            REQUIRE_THROWS_AS(parse_seat_location("1G"), MalformedInputError);
+        }
+
+        WHEN("a widebody layout was active")
+        {
+            auto layout = CabinLayout(62, "ABC DEFG HJK");
+            layout.block(29, 3);
+            const auto scoped_layout = ScopedLayout(layout);
+
+            REQUIRE(parse_seat_location("62K") == SeatLocation(61, 9));
+            REQUIRE(parse_seat_location("62K").to_string() == "62K");
+
+            REQUIRE_THROWS_AS(parse_seat_location("10I"), MalformedInputError);
+            REQUIRE_THROWS_AS(parse_seat_location("30D"), MalformedInputError);
+        }
+    }
+
+    TEST_CASE("jetassign::core::SeatingPlan::find_adjacent_vacant_seats")
+    {
+        using jetassign::core::CabinLayout;
+        using jetassign::core::Passenger;
+        using jetassign::core::SeatingPlan;
+        using jetassign::core::SeatLocation;
+        using jetassign::core::TicketClass;
+
+        // Row 1: ABC | DEFG | HJK, with 1B blocked.
+        auto layout = CabinLayout(3, "ABC DEFG HJK");
+        layout.set_ticket_class(0, 0, TicketClass::kFirst);
+        layout.block(0, 1);
+        const auto scoped_layout = ScopedLayout(layout);
+
+        auto plan = SeatingPlan();
+        plan.assign(SeatLocation(0, 0), Passenger("Chan Tai Man", "HK12345678A"));
+        plan.assign(SeatLocation(0, 4), Passenger("Lee Siu Lung", "HK11111111C"));
+
+        REQUIRE(plan.occupied_bits(0) == 0b10001);
+        REQUIRE(plan.is_occupied(0, 4));
+        REQUIRE_FALSE(plan.is_occupied(0, 5));
+
+        REQUIRE(plan.vacant_seats(TicketClass::kFirst) == 7);
+        REQUIRE(plan.vacant_seats(TicketClass::kBusiness) == 0);
+        REQUIRE(plan.vacant_seats(TicketClass::kEconomy) == 20);
+
+        REQUIRE(plan.first_vacant_column(0) == 2u);
+        REQUIRE(plan.first_vacant_column(1) == 0u);
+
+        // The seats across an aisle were not side by side.
+        REQUIRE(plan.find_adjacent_vacant_seats(2, TicketClass::kFirst) == SeatLocation(0, 5));
+        REQUIRE(plan.find_adjacent_vacant_seats(3, TicketClass::kFirst) == SeatLocation(0, 7));
+        REQUIRE(plan.find_adjacent_vacant_seats(4, TicketClass::kFirst) == std::nullopt);
+        REQUIRE(plan.find_adjacent_vacant_seats(4) == SeatLocation(1, 3));
+        REQUIRE(plan.find_adjacent_vacant_seats(5) == std::nullopt);
+
+        plan.remove(SeatLocation(0, 4));
+        REQUIRE(plan.find_adjacent_vacant_seats(4, TicketClass::kFirst) == SeatLocation(0, 3));
+        REQUIRE(plan.vacant_seats(TicketClass::kFirst) == 8);
+    }
+
+    TEST_CASE("jetassign::core::SeatingPlan::occupancy")
+    {
+        using jetassign::core::CabinLayout;
+        using jetassign::core::Occupancy;
+        using jetassign::core::Passenger;
+        using jetassign::core::SeatingPlan;
+        using jetassign::core::SeatLocation;
+        using jetassign::core::TicketClass;
+
+        // Row 1: ABC | DEFG | HJK, with 1B blocked.
+        auto layout = CabinLayout(3, "ABC DEFG HJK");
+        layout.set_ticket_class(0, 0, TicketClass::kFirst);
+        layout.block(0, 1);
+        const auto scoped_layout = ScopedLayout(layout);
+
+        auto plan = SeatingPlan();
+        plan.assign(SeatLocation(0, 0), Passenger("Chan Tai Man", "HK12345678A"));
+        plan.assign(SeatLocation(2, 1), Passenger("Lee Siu Lung", "HK11111111C"));
+        REQUIRE_THROWS(plan.assign(SeatLocation(0, 0), Passenger("Wong Ka Yan", "HK22222222D")));
+
+        REQUIRE(plan.occupancy().occupied == 2);
+        REQUIRE(plan.occupancy().vacant == 27);
+        REQUIRE(plan.occupancy(TicketClass::kFirst).occupied == 1);
+        REQUIRE(plan.occupancy(TicketClass::kFirst).seats() == 9);
+        REQUIRE(plan.occupancy(TicketClass::kBusiness).seats() == 0);
+        REQUIRE(plan.occupancy(TicketClass::kBusiness).load_factor() == 0.0);
+        REQUIRE(plan.occupancy(TicketClass::kEconomy).occupied == 1);
+        REQUIRE(plan.occupancy(TicketClass::kEconomy).load_factor() == Approx(1.0 / 20));
+
+        REQUIRE(plan.row_occupancy(0).occupied == 1);
+        REQUIRE(plan.row_occupancy(0).vacant == 8);
+        REQUIRE(plan.column_occupancy(1).occupied == 1);
+        REQUIRE(plan.column_occupancy(1).vacant == 1);
+
+        WHEN("the seats were changed at random")
+        {
+            auto random = std::mt19937(42);
+            for (auto i = 0; i < 1000; i++)
+            {
+                const auto location = SeatLocation(random() % 3, random() % 10);
+                if (plan.is_blocked(location)) { continue; }
+
+                if (plan.is_occupied(location)) { plan.remove(location); }
+                else { plan.assign(location, Passenger("Passenger", "P" + std::to_string(i))); }
+            }
+
+            // The counters were the same as counting the seats again.
+            auto columns = std::vector<Occupancy>(10);
+            for (size_t row = 0; row < 3; row++)
+            {
+                for (size_t column = 0; column < 10; column++)
+                {
+                    if (plan.is_blocked(SeatLocation(row, column))) { continue; }
+                    (plan.is_occupied(row, column) ? columns[column].occupied : columns[column].vacant)++;
+                }
+            }
+
+            size_t occupied = 0;
+            for (size_t column = 0; column < 10; column++)
+            {
+                REQUIRE(plan.column_occupancy(column).occupied == columns[column].occupied);
+                REQUIRE(plan.column_occupancy(column).vacant == columns[column].vacant);
+                occupied += columns[column].occupied;
+            }
+
+            REQUIRE(plan.occupancy().occupied == occupied);
+            REQUIRE(plan.occupancy().seats() == 29);
+            REQUIRE(plan.occupancy(TicketClass::kFirst).occupied == plan.row_occupancy(0).occupied);
+            REQUIRE(plan.occupancy(TicketClass::kEconomy).occupied == (plan.row_occupancy(1).occupied + plan.row_occupancy(2).occupied));
+        }
+    }
+
+    TEST_CASE("jetassign::core::SeatingPlan::Transaction")
+    {
+        using jetassign::core::Passenger;
+        using jetassign::core::SeatingPlan;
+        using jetassign::core::SeatLocation;
+        using jetassign::exceptions::SeatOccupiedError;
+
+        const auto chan = Passenger("Chan Tai Man", "HK12345678A");
+        const auto lee = Passenger("Lee Siu Lung", "HK11111111C");
+        const auto wong = Passenger("Wong Ka Ming", "HK22222222D");
+
+        auto plan = SeatingPlan();
+        plan.assign(SeatLocation(0, 0), chan);
+        plan.assign(SeatLocation(0, 1), lee);
+
+        WHEN("the transaction was committed")
+        {
+            // Swaps the seats of two passengers, which could not be done one by one.
+            auto transaction = plan.begin();
+            transaction.move(chan, SeatLocation(5, 5));
+            transaction.move(lee, SeatLocation(0, 0));
+            transaction.move(chan, SeatLocation(0, 1));
+            transaction.assign(SeatLocation(5, 5), wong);
+
+            REQUIRE_FALSE(plan.is_occupied(SeatLocation(5, 5)));
+            transaction.commit();
+
+            REQUIRE(plan.location_of(chan) == SeatLocation(0, 1));
+            REQUIRE(plan.location_of(lee) == SeatLocation(0, 0));
+            REQUIRE(plan.location_of(wong) == SeatLocation(5, 5));
+        }
+
+        WHEN("a change of the transaction could not be applied")
+        {
+            auto transaction = plan.begin();
+            transaction.move(wong, SeatLocation(3, 3));
+            transaction.remove(chan);
+            transaction.assign(SeatLocation(0, 1), Passenger("Ho Wai Kit", "HK33333333E"));
+
+            REQUIRE_THROWS_AS(transaction.commit(), SeatOccupiedError);
+
+            REQUIRE_FALSE(plan.is_assigned(wong));
+            REQUIRE(plan.location_of(chan) == SeatLocation(0, 0));
+            REQUIRE(plan.location_of(lee) == SeatLocation(0, 1));
+        }
+
+        WHEN("the transaction was not committed")
+        {
+            {
+                auto transaction = plan.begin();
+                transaction.remove(SeatLocation(0, 0));
+                transaction.assign(SeatLocation(0, 0), wong);
+            }
+
+            REQUIRE(plan.location_of(chan) == SeatLocation(0, 0));
+            REQUIRE_FALSE(plan.is_assigned(wong));
+        }
+    }
+
+    TEST_CASE("jetassign::core::SeatingPlan::Snapshot")
+    {
+        using jetassign::core::Passenger;
+        using jetassign::core::SeatingPlan;
+        using jetassign::core::SeatLocation;
+
+        const auto chan = Passenger("Chan Tai Man", "HK12345678A");
+        const auto lee = Passenger("Lee Siu Lung", "HK11111111C");
+
+        auto plan = SeatingPlan();
+        plan.assign(SeatLocation(0, 0), chan);
+
+        const auto snapshot = plan.snapshot();
+        REQUIRE(snapshot->at(SeatLocation(0, 0)) == chan);
+        REQUIRE(snapshot->location_of(chan.passport_id()) == SeatLocation(0, 0));
+
+        WHEN("the seating plan was changed")
+        {
+            plan.remove(SeatLocation(0, 0));
+            plan.assign(SeatLocation(0, 1), lee);
+
+            // The published snapshot was never changed.
+            REQUIRE(snapshot->is_occupied(0, 0));
+            REQUIRE_FALSE(snapshot->is_occupied(0, 1));
+            REQUIRE_FALSE(snapshot->location_of(lee.passport_id()));
+
+            const auto latest = plan.snapshot();
+            REQUIRE(latest->version() == snapshot->version() + 2);
+            REQUIRE(latest->occupied_bits(0) == 0b10);
+            REQUIRE_FALSE(latest->location_of(chan.passport_id()));
+            REQUIRE(latest->at(SeatLocation(0, 1)) == lee);
+
+            // The rows which were not changed are shared with the previous snapshot.
+            REQUIRE(&latest->at(SeatLocation(5, 0)) == &snapshot->at(SeatLocation(5, 0)));
+        }
+
+        WHEN("a transaction was committed")
+        {
+            auto transaction = plan.begin();
+            transaction.move(chan, SeatLocation(3, 3));
+            transaction.assign(SeatLocation(0, 0), lee);
+            transaction.commit();
+
+            // The changes of the transaction were published at once.
+            const auto latest = plan.snapshot();
+            REQUIRE(latest->version() == snapshot->version() + 1);
+            REQUIRE(latest->location_of(chan.passport_id()) == SeatLocation(3, 3));
+            REQUIRE(latest->location_of(lee.passport_id()) == SeatLocation(0, 0));
+        }
+
+        WHEN("the seating plan had more rows than a chunk")
+        {
+            auto layout = jetassign::core::CabinLayout(70, "ABCDEF");
+            const auto scoped_layout = ScopedLayout(layout);
+
+            auto large_plan = SeatingPlan();
+            large_plan.assign(SeatLocation(40, 2), chan);
+            const auto previous = large_plan.snapshot();
+            large_plan.assign(SeatLocation(69, 5), lee);
+
+            const auto latest = large_plan.snapshot();
+            REQUIRE(latest->at(SeatLocation(40, 2)) == chan);
+            REQUIRE(latest->location_of(lee.passport_id()) == SeatLocation(69, 5));
+            REQUIRE(latest->occupied_bits(69) == 0b100000);
+            REQUIRE_FALSE(previous->is_occupied(69, 5));
+            REQUIRE_THROWS_AS(latest->occupied_bits(70), std::out_of_range);
+
+            // The chunks which were not changed are shared with the previous snapshot.
+            REQUIRE(&latest->at(SeatLocation(40, 2)) == &previous->at(SeatLocation(40, 2)));
+        }
+
+        WHEN("the publication was deferred")
+        {
+            {
+                const auto deferred_publication = SeatingPlan::DeferredPublication(plan);
+                plan.assign(SeatLocation(0, 1), lee);
+                plan.remove(SeatLocation(0, 0));
+
+                auto transaction = plan.begin();
+                transaction.assign(SeatLocation(0, 0), Passenger("Wong Ka Yan", "HK22222222D"));
+                transaction.commit();
+
+                // Neither the changes nor the nested transaction were published yet.
+                REQUIRE(plan.snapshot() == snapshot);
+            }
+
+            // The changes were published at once after the guard was destroyed.
+            const auto latest = plan.snapshot();
+            REQUIRE(latest->version() == snapshot->version() + 1);
+            REQUIRE(latest->occupied_bits(0) == 0b11);
+            REQUIRE(latest->location_of(lee.passport_id()) == SeatLocation(0, 1));
+            REQUIRE(latest->location_of("HK22222222D") == SeatLocation(0, 0));
+            REQUIRE_FALSE(latest->location_of(chan.passport_id()));
+        }
+
+        WHEN("a reader was reading the seating plan")
+        {
+            auto reader = SeatingPlan::Reader(plan);
+            const auto &current = reader.current();
+            REQUIRE(&reader.current() == &current);
+
+            plan.assign(SeatLocation(0, 1), lee);
+            REQUIRE(reader.current().location_of(lee.passport_id()) == SeatLocation(0, 1));
+        }
+    }
+
+    TEST_CASE("jetassign::core::SeatingPlan::Reader", "[!benchmark]")
+    {
+        using jetassign::core::CabinLayout;
+        using jetassign::core::Passenger;
+        using jetassign::core::SeatingPlan;
+        using jetassign::core::SeatLocation;
+
+        auto layout = CabinLayout(62, "ABC DEFG HJK");
+        const auto scoped_layout = ScopedLayout(layout);
+
+        auto plan = SeatingPlan();
+        std::atomic<bool> is_running { true };
+        std::atomic<std::uint64_t> reads { 0 };
+
+        // Some readers look up the seating plan while the writer keeps changing it.
+        const auto reader_count = std::max(2u, std::thread::hardware_concurrency()) - 1;
+        std::vector<std::thread> readers;
+        for (unsigned int i = 0; i < reader_count; i++)
+        {
+            readers.emplace_back([&plan, &is_running, &reads, i]()
+            {
+                auto reader = SeatingPlan::Reader(plan);
+                std::uint64_t count = 0;
+                for (size_t row = i; is_running.load(std::memory_order_relaxed); row = (row + 1) % 62, count++)
+                {
+                    const auto &snapshot = reader.current();
+                    if (snapshot.occupied_bits(row) > snapshot.occupied_bits(0)) { snapshot.location_of("HK00000000A"); }
+                }
+
+                reads += count;
+            });
+        }
+
+        size_t writes = 0;
+        const auto started = std::chrono::steady_clock::now();
+        while ((std::chrono::steady_clock::now() - started) < std::chrono::seconds(1))
+        {
+            const auto location = SeatLocation(writes % 62, (writes / 62) % 10);
+            if (plan.is_occupied(location)) { plan.remove(location); }
+            else { plan.assign(location, Passenger("Chan Tai Man", "HK" + std::to_string(10000000 + writes) + "A")); }
+
+            writes++;
+        }
+
+        is_running = false;
+        for (auto &reader : readers) { reader.join(); }
+
+        const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        WARN(reader_count << " readers: " << static_cast<std::uint64_t>(reads / elapsed) << " reads/s, "
+             << static_cast<std::uint64_t>(writes / elapsed) << " writes/s");
+    }
+
+    TEST_CASE("jetassign::core::SeatAllocator")
+    {
+        using jetassign::core::CabinLayout;
+        using jetassign::core::Passenger;
+        using jetassign::core::SeatAllocator;
+        using jetassign::core::SeatingPlan;
+        using jetassign::core::SeatLocation;
+        using jetassign::core::TicketClass;
+
+        auto plan = SeatingPlan();
+        plan.assign(SeatLocation(9, 3), Passenger("Chan Tai Man", "HK12345678A"));
+
+        auto allocator = SeatAllocator(plan);
+
+        WHEN("a seat was requested without a preferred seat")
+        {
+            REQUIRE(allocator.allocate(TicketClass::kBusiness) == SeatLocation(2, 0));
+            REQUIRE(allocator.allocate(TicketClass::kBusiness) == SeatLocation(2, 1));
+            REQUIRE(allocator.allocate(std::nullopt) == SeatLocation(0, 0));
+        }
+
+        WHEN("the preferred seat was occupied")
+        {
+            REQUIRE(allocator.allocate(std::nullopt, SeatLocation(9, 3)) == SeatLocation(9, 2));
+            REQUIRE(allocator.allocate(std::nullopt, SeatLocation(9, 3)) == SeatLocation(9, 4));
+
+            // The nearest seat of the same ticket class wins over the nearer seats of the other class.
+            for (size_t column = 0; column < 6; column++) { allocator.reserve(SeatLocation(1, column)); }
+            REQUIRE(allocator.allocate(std::nullopt, SeatLocation(1, 0)) == SeatLocation(0, 0));
+        }
+
+        WHEN("the ticket class was full")
+        {
+            for (size_t i = 0; i < 12; i++) { REQUIRE(allocator.allocate(TicketClass::kFirst)); }
+            REQUIRE(allocator.allocate(TicketClass::kFirst) == SeatLocation(2, 0));
+        }
+
+        WHEN("a party was seated")
+        {
+            allocator.reserve(SeatLocation(0, 1));
+
+            const auto seats = allocator.allocate_party(3, TicketClass::kFirst);
+            REQUIRE(seats == std::vector<SeatLocation> { SeatLocation(0, 2), SeatLocation(0, 3), SeatLocation(0, 4) });
+
+            // The party was split if it could not be seated side by side.
+            const auto large_seats = allocator.allocate_party(7, TicketClass::kFirst);
+            REQUIRE(large_seats);
+            REQUIRE(large_seats->size() == 7);
+            REQUIRE_FALSE(allocator.allocate_party(100, std::nullopt));
+        }
+    }
+
+    TEST_CASE("jetassign::core::SeatAllocator::allocate_party", "[!benchmark]")
+    {
+        using jetassign::core::CabinLayout;
+        using jetassign::core::SeatAllocator;
+        using jetassign::core::SeatingPlan;
+        using jetassign::core::TicketClass;
+
+        auto layout = CabinLayout(62, "ABC DEFG HJK");
+        layout.set_ticket_class(0, 2, TicketClass::kFirst);
+        layout.set_ticket_class(3, 11, TicketClass::kBusiness);
+        const auto scoped_layout = ScopedLayout(layout);
+
+        const auto plan = SeatingPlan();
+
+        // Seats a full widebody manifest, in parties of 1 to 4 passengers.
+        BENCHMARK("allocate a full widebody manifest")
+        {
+            auto allocator = SeatAllocator(plan);
+            size_t seated = 0;
+            for (size_t party = 0; seated < layout.seats(); party++)
+            {
+                const auto count = std::min<size_t>((party % 4) + 1, layout.seats() - seated);
+                const auto ticket_class = (party % 10 == 0) ? TicketClass::kFirst : TicketClass::kEconomy;
+                seated += allocator.allocate_party(count, ticket_class)->size();
+            }
+
+            return seated;
+        };
+    }
+
+    TEST_CASE("jetassign::core::SeatClaimBoard")
+    {
+        using jetassign::core::Passenger;
+        using jetassign::core::SeatClaimBoard;
+        using jetassign::core::SeatingPlan;
+        using jetassign::core::SeatLocation;
+
+        const auto chan = Passenger("Chan Tai Man", "HK12345678A");
+        const auto lee = Passenger("Lee Siu Lung", "HK11111111C");
+
+        auto plan = SeatingPlan();
+        plan.assign(SeatLocation(0, 0), chan);
+
+        auto board = SeatClaimBoard(plan);
+
+        WHEN("the seats were claimed")
+        {
+            REQUIRE_FALSE(board.try_claim(SeatLocation(0, 0), lee));
+            REQUIRE(board.try_claim(SeatLocation(0, 1), lee));
+            REQUIRE_FALSE(board.try_claim(SeatLocation(0, 1), chan));
+            REQUIRE(board.claimant(SeatLocation(0, 1)) == lee);
+            REQUIRE(board.size() == 1);
+
+            board.commit(plan);
+            REQUIRE(plan.location_of(lee) == SeatLocation(0, 1));
+            REQUIRE(board.size() == 0);
+            REQUIRE_FALSE(board.try_claim(SeatLocation(0, 1), lee));
+        }
+
+        WHEN("a passenger claimed more than one seat")
+        {
+            REQUIRE(board.try_claim(SeatLocation(1, 0), lee));
+            REQUIRE_FALSE(board.try_claim(SeatLocation(1, 1), lee));
+            REQUIRE_FALSE(board.try_claim(SeatLocation(1, 2), chan));
+
+            // The seat of the rejected claim was still vacant.
+            REQUIRE(board.try_claim(SeatLocation(1, 1), Passenger("Wong Ka Ming", "HK22222222D")));
+            REQUIRE(board.size() == 2);
+
+            board.commit(plan);
+            REQUIRE(plan.location_of(lee) == SeatLocation(1, 0));
+            REQUIRE(plan.location_of("HK22222222D") == SeatLocation(1, 1));
+            REQUIRE_FALSE(board.try_claim(SeatLocation(2, 0), lee));
+        }
+
+        WHEN("the seats were claimed while committing")
+        {
+            std::atomic<bool> is_claiming { true };
+            std::atomic<size_t> won { 0 };
+
+            std::vector<std::thread> claimers;
+            for (size_t t = 0; t < 4; t++)
+            {
+                claimers.emplace_back([&, t]()
+                {
+                    for (size_t index = 1; index < plan.layout().seats(); index++)
+                    {
+                        const auto location = SeatLocation(index / plan.layout().columns(), index % plan.layout().columns());
+                        if (board.try_claim(location, Passenger("Passenger", "P" + std::to_string(t) + "X" + std::to_string(index)))) { won++; }
+                    }
+                });
+            }
+
+            std::thread committer([&]()
+            {
+                while (is_claiming) { board.commit(plan); }
+            });
+
+            for (auto &claimer : claimers) { claimer.join(); }
+            is_claiming = false;
+            committer.join();
+            board.commit(plan);
+
+            // Every claim that won a seat was committed.
+            REQUIRE(won == (plan.layout().seats() - 1));
+            REQUIRE(plan.occupancy().occupied == plan.layout().seats());
+            REQUIRE(board.size() == 0);
+        }
+    }
+
+    TEST_CASE("jetassign::core::SeatClaimBoard::try_claim", "[!benchmark]")
+    {
+        using jetassign::core::CabinLayout;
+        using jetassign::core::Passenger;
+        using jetassign::core::SeatClaimBoard;
+        using jetassign::core::SeatingPlan;
+        using jetassign::core::SeatLocation;
+
+        auto layout = CabinLayout(62, "ABC DEFG HJK");
+        const auto scoped_layout = ScopedLayout(layout);
+
+        const auto plan = SeatingPlan();
+        const auto thread_count = std::max(4u, std::thread::hardware_concurrency());
+
+        // Each passenger races for one seat only, since a passenger could only win one seat.
+        std::vector<Passenger> passengers;
+        for (size_t index = 0; index < layout.seats(); index++) { passengers.emplace_back("Chan Tai Man", "P" + std::to_string(index)); }
+
+        std::atomic<std::uint64_t> attempts { 0 };
+        double elapsed = 0;
+
+        // Every thread races for the hot seats first (the front row and the exit rows), then for
+        // the rest of the cabin, on a fresh claim board each round.
+        for (size_t round = 0; round < 20; round++)
+        {
+            auto board = SeatClaimBoard(plan);
+            std::vector<std::vector<size_t>> won(thread_count);
+
+            const auto started = std::chrono::steady_clock::now();
+            std::vector<std::thread> threads;
+            for (unsigned int i = 0; i < thread_count; i++)
+            {
+                threads.emplace_back([&, i]()
+                {
+                    static const size_t kHotRows[] = { 0, 14, 15, 40 };
+
+                    std::uint64_t count = 0;
+                    for (const auto row : kHotRows)
+                    {
+                        for (size_t column = 0; column < layout.columns(); column++, count++)
+                        {
+                            const auto index = layout.index_of(row, column);
+                            if (board.try_claim(SeatLocation(row, column), passengers[index])) { won[i].push_back(index); }
+                        }
+                    }
+
+                    for (size_t n = 0; n < layout.seats(); n++, count++)
+                    {
+                        const auto index = (n + (i * 97)) % layout.seats();
+                        const auto location = SeatLocation(index / layout.columns(), index % layout.columns());
+                        if (board.try_claim(location, passengers[index])) { won[i].push_back(index); }
+                    }
+
+                    attempts += count;
+                });
+            }
+
+            for (auto &thread : threads) { thread.join(); }
+            elapsed += std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+            // Exactly one claimant won each seat.
+            std::vector<size_t> seats;
+            for (const auto &seats_won : won) { seats.insert(seats.end(), seats_won.begin(), seats_won.end()); }
+            std::sort(seats.begin(), seats.end());
+
+            REQUIRE(seats.size() == layout.seats());
+            REQUIRE(std::adjacent_find(seats.begin(), seats.end()) == seats.end());
+            REQUIRE(board.size() == layout.seats());
+        }
+
+        WARN(thread_count << " threads: " << static_cast<std::uint64_t>(attempts / elapsed) << " claims/s");
+    }
+
+    TEST_CASE("jetassign::core::FlightRegistry")
+    {
+        using jetassign::core::FlightKey;
+        using jetassign::core::FlightRegistry;
+        using jetassign::core::Passenger;
+        using jetassign::core::SeatingPlan;
+        using jetassign::core::SeatLocation;
+
+        auto registry = FlightRegistry(4);
+
+        WHEN("a flight was opened twice")
+        {
+            const auto flight = registry.open({ "CX888", "2021-04-01" });
+
+            REQUIRE(registry.open({ "CX888", "2021-04-01" }) == flight);
+            REQUIRE(registry.find({ "CX888", "2021-04-01" }) == flight);
+            REQUIRE_FALSE(registry.find({ "CX888", "2021-04-02" }));
+            REQUIRE(registry.size() == 1);
+
+            AND_WHEN("the flight was closed")
+            {
+                REQUIRE(registry.close({ "CX888", "2021-04-01" }));
+                REQUIRE_FALSE(registry.find({ "CX888", "2021-04-01" }));
+                REQUIRE(registry.size() == 0);
+            }
+        }
+
+        WHEN("the flights were loaded from a backing store")
+        {
+            size_t loads = 0;
+            std::vector<FlightKey> unloaded;
+
+            registry.set_loader([&](const FlightKey &key, SeatingPlan &plan)
+            {
+                loads++;
+                plan.assign(SeatLocation(0, 0), Passenger("Chan Tai Man", "HK12345678A"));
+                return (key.flight_number == "CX888");
+            });
+            registry.set_prober([](const FlightKey &key) { return (key.flight_number == "CX888"); });
+            registry.set_unloader([&](const FlightKey &key, SeatingPlan &plan)
+            {
+                REQUIRE(plan.is_assigned("HK12345678A"));
+                unloaded.push_back(key);
+            });
+
+            // The flights that were not loaded were closed without loading them.
+            REQUIRE(registry.close({ "CX888", "2021-04-01" }));
+            REQUIRE_FALSE(registry.close({ "CX888", "2021-04-01" }));
+            REQUIRE_FALSE(registry.close({ "CX999", "2021-04-01" }));
+            REQUIRE(loads == 0);
+            REQUIRE(unloaded.empty());
+            REQUIRE_FALSE(registry.find({ "CX888", "2021-04-01" }));
+
+            // The flights that were loaded were unloaded after they were closed.
+            REQUIRE(registry.find({ "CX888", "2021-04-02" }));
+            REQUIRE(registry.close({ "CX888", "2021-04-02" }));
+            REQUIRE(loads == 1);
+            REQUIRE(unloaded == std::vector<FlightKey> { { "CX888", "2021-04-02" } });
+        }
+
+        WHEN("independent flights were modified concurrently")
+        {
+            static const size_t kThreadCount = 4;
+            static const size_t kFlightsPerThread = 25;
+
+            std::vector<std::thread> threads;
+            for (size_t t = 0; t < kThreadCount; t++)
+            {
+                threads.emplace_back([&, t]()
+                {
+                    for (size_t f = 0; f < kFlightsPerThread; f++)
+                    {
+                        const auto number = "JA" + std::to_string((t * kFlightsPerThread) + f);
+                        registry.open({ number, "2021-04-01" })->modify([&](SeatingPlan &plan)
+                        {
+                            plan.assign(SeatLocation(0, 0), Passenger("Chan Tai Man", number));
+                        });
+                    }
+                });
+            }
+
+            for (auto &thread : threads) { thread.join(); }
+
+            REQUIRE(registry.size() == (kThreadCount * kFlightsPerThread));
+            for (const auto &flight : registry.flights())
+            {
+                flight->read([&](const SeatingPlan &plan)
+                {
+                    REQUIRE(plan.location_of(flight->key().flight_number) == SeatLocation(0, 0));
+                });
+            }
+        }
+    }
+
+    TEST_CASE("jetassign::core::Flight")
+    {
+        using jetassign::core::Flight;
+        using jetassign::core::Passenger;
+        using jetassign::core::SeatingPlan;
+        using jetassign::core::SeatLocation;
+
+        /** Counts the blocks that were allocated from the upstream resource. */
+        struct CountingResource : std::pmr::memory_resource
+        {
+            size_t allocations = 0;
+            size_t outstanding = 0;
+
+            void* do_allocate(size_t bytes, size_t alignment) override
+            {
+                allocations++;
+                outstanding++;
+                return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+            }
+
+            void do_deallocate(void *pointer, size_t bytes, size_t alignment) override
+            {
+                outstanding--;
+                std::pmr::new_delete_resource()->deallocate(pointer, bytes, alignment);
+            }
+
+            bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+            {
+                return (this == &other);
+            }
+        };
+
+        auto upstream = CountingResource();
+        {
+            Flight flight({ "CX888", "2021-04-01" }, &upstream);
+
+            const auto churn = [&](size_t round)
+            {
+                flight.modify([round](SeatingPlan &plan)
+                {
+                    for (size_t i = 0; i < 40; i++)
+                    {
+                        // Each passenger has a distinct name, which fits into the buffer.
+                        char name[16];
+                        std::snprintf(name, sizeof(name), "Chan %03zu %02zu", round, i);
+
+                        plan.assign(SeatLocation(i / 4, i % 4), Passenger(name, "HK" + std::to_string(i)));
+                    }
+                    for (size_t i = 0; i < 40; i++)
+                    {
+                        plan.remove(SeatLocation(i / 4, i % 4));
+                    }
+                });
+            };
+
+            // The blocks of the removed passengers, their names and the snapshots were recycled by
+            // the pools, thus neither the upstream resource nor the heap grew.
+            for (size_t round = 0; round < 10; round++) { churn(round); }
+            const auto allocations = upstream.allocations;
+
+            is_counting_allocations = true;
+            allocation_count = 0;
+            for (size_t round = 10; round < 20; round++) { churn(round); }
+            is_counting_allocations = false;
+
+            REQUIRE(allocation_count == 0);
+            REQUIRE(upstream.allocations == allocations);
+            REQUIRE(upstream.outstanding > 0);
+        }
+
+        // Destroying the flight released its pool as a whole.
+        REQUIRE(upstream.outstanding == 0);
+    }
+
+    TEST_CASE("jetassign::search::NameIndex")
+    {
+        using jetassign::core::FlightKey;
+        using jetassign::core::Passenger;
+        using jetassign::core::SeatingPlan;
+        using jetassign::core::SeatLocation;
+        using jetassign::search::NameIndex;
+
+        auto console_plan = SeatingPlan();
+        auto flight_plan = SeatingPlan();
+        console_plan.assign(SeatLocation(0, 0), Passenger("Chan Tai Man", "HK12345678A"));
+
+        auto index = NameIndex();
+        index.attach(console_plan);
+        index.attach(flight_plan, { "CX888", "2021-04-01" });
+
+        flight_plan.assign(SeatLocation(1, 1), Passenger("Chan Siu Ming", "HK22222222B"));
+        flight_plan.assign(SeatLocation(2, 2), Passenger("Wong Ka Yan", "HK33333333C"));
+        REQUIRE(index.size() == 3);
+
+        WHEN("a name was searched case-insensitively")
+        {
+            const auto matches = index.find("  chan   TAI man ");
+
+            REQUIRE(matches.size() == 1);
+            REQUIRE(matches[0].flight == FlightKey());
+            REQUIRE(matches[0].location == SeatLocation(0, 0));
+            REQUIRE(matches[0].passenger.passport_id() == "HK12345678A");
+        }
+
+        WHEN("a prefix was searched")
+        {
+            const auto matches = index.find_prefix("chan");
+
+            REQUIRE(matches.size() == 2);
+            REQUIRE(matches[0].passenger.name() == "Chan Siu Ming");
+            REQUIRE(matches[0].flight == FlightKey { "CX888", "2021-04-01" });
+            REQUIRE(matches[1].passenger.name() == "Chan Tai Man");
+
+            REQUIRE(index.find_prefix("chan", 1).size() == 1);
+            REQUIRE(index.find_prefix("Lee").empty());
+        }
+
+        WHEN("a misspelled name was searched")
+        {
+            const auto matches = index.find_similar("Chen Tai Mann");
+
+            REQUIRE(matches.size() == 1);
+            REQUIRE(matches[0].passenger.name() == "Chan Tai Man");
+            REQUIRE(matches[0].distance == 2);
+
+            REQUIRE(index.find_similar("Wong Ka Yun", 0).empty());
+            REQUIRE(index.find_similar("Wong Ka Yun", 1).size() == 1);
+        }
+
+        WHEN("the passengers were removed, or the seating plan was detached")
+        {
+            flight_plan.remove(SeatLocation(1, 1));
+            REQUIRE(index.find("Chan Siu Ming").empty());
+
+            index.detach(flight_plan);
+            flight_plan.assign(SeatLocation(1, 1), Passenger("Chan Siu Ming", "HK22222222B"));
+
+            REQUIRE(index.size() == 1);
+            REQUIRE(index.find_prefix("").size() == 1);
+        }
+    }
+
+    TEST_CASE("jetassign::search::NameIndex::find_similar", "[!benchmark]")
+    {
+        using jetassign::core::Passenger;
+        using jetassign::core::SeatingPlan;
+        using jetassign::core::SeatLocation;
+        using jetassign::search::NameIndex;
+
+        static const std::array<const char*, 10> kSurnames = { "Chan", "Cheung", "Ho", "Lam", "Lee", "Leung", "Ng", "To", "Wong", "Yip" };
+        static const size_t kPassengerCount = 1000000;
+
+        // Indexes a million passengers, with a hundred thousand distinct names.
+        auto plan = SeatingPlan();
+        auto index = NameIndex();
+        auto random = std::mt19937(2042);
+        for (size_t i = 0; i < kPassengerCount; i++)
+        {
+            const auto given_name = "Tai " + std::to_string(random() % 10000);
+            const auto name = string(kSurnames[i % kSurnames.size()]) + ' ' + given_name;
+
+            index.on_assigned(plan, SeatLocation(0, 0), Passenger(name, "HK" + std::to_string(i)));
+        }
+
+        static const size_t kQueryCount = 1000;
+
+        const auto started = std::chrono::steady_clock::now();
+        size_t found = 0;
+        for (size_t i = 0; i < kQueryCount; i++)
+        {
+            found += index.find_similar("Chen Tai " + std::to_string(i), 1, 5).size();
+        }
+        const auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - started);
+
+        REQUIRE(found > 0);
+        WARN("find_similar: " << (elapsed.count() / kQueryCount) << " us/query over " << index.size() << " passengers");
+    }
+
+    TEST_CASE("jetassign::seatmap::SeatMapWriter")
+    {
+        using jetassign::core::CabinLayout;
+        using jetassign::core::FlightKey;
+        using jetassign::core::Passenger;
+        using jetassign::core::SeatingPlan;
+        using jetassign::core::SeatLocation;
+        using jetassign::core::TicketClass;
+        using jetassign::seatmap::Format;
+        using jetassign::seatmap::SeatMapWriter;
+        using jetassign::seatmap::parse_format;
+
+        auto layout = CabinLayout(2, "AB");
+        layout.set_ticket_class(0, 0, TicketClass::kFirst);
+        layout.block(1, 1);
+        const auto scoped_layout = ScopedLayout(layout);
+
+        auto plan = SeatingPlan();
+        plan.assign(SeatLocation(0, 1), Passenger("Chan, \"Tai\" Man", "HK12345678A"));
+
+        std::ostringstream output;
+        const auto export_as = [&](Format format)
+        {
+            auto writer = SeatMapWriter(output, format);
+            writer.write(FlightKey { "CX888", "2021-04-01" }, *plan.snapshot());
+            writer.finish();
+
+            REQUIRE(writer.size() == 1);
+            return output.str();
+        };
+
+        REQUIRE(parse_format("csv") == Format::kCsv);
+        REQUIRE_FALSE(parse_format("xml"));
+
+        WHEN("the seating plan was exported as JSON")
+        {
+            REQUIRE(export_as(Format::kJson) ==
+                "[\n{\"flight\":\"CX888\",\"date\":\"2021-04-01\",\"rows\":2,\"columns\":\"AB\",\"seats\":["
+                "{\"seat\":\"1A\",\"class\":\"First\",\"status\":\"vacant\"},"
+                "{\"seat\":\"1B\",\"class\":\"First\",\"status\":\"occupied\",\"name\":\"Chan, \\\"Tai\\\" Man\",\"passport_id\":\"HK12345678A\"},"
+                "{\"seat\":\"2A\",\"class\":\"Economy\",\"status\":\"vacant\"},"
+                "{\"seat\":\"2B\",\"class\":\"Economy\",\"status\":\"blocked\"}]}]\n");
+        }
+
+        WHEN("the seating plan was exported as CSV")
+        {
+            REQUIRE(export_as(Format::kCsv) ==
+                "flight,date,seat,class,status,name,passport_id\n"
+                "CX888,2021-04-01,1A,First,vacant,,\n"
+                "CX888,2021-04-01,1B,First,occupied,\"Chan, \"\"Tai\"\" Man\",HK12345678A\n"
+                "CX888,2021-04-01,2A,Economy,vacant,,\n"
+                "CX888,2021-04-01,2B,Economy,blocked,,\n");
+        }
+
+        WHEN("the seating plan was exported as binary")
+        {
+            const auto expected = string("JASM\x01\0\0\0", 8)
+                + string("\x05\0CX888", 7) + string("\x0A\0" "2021-04-01", 12)
+                + string("\x02\0\0\0\x02\0\0\0", 8)
+                + string("\x02\0", 2)   // The occupied bits of each row.
+                + string("\0\x02", 2);  // The blocked bits of each row.
+
+            REQUIRE(export_as(Format::kBinary) == expected);
+        }
+    }
+
+    TEST_CASE("jetassign::seatmap::SeatMapWriter::write", "[!benchmark]")
+    {
+        using jetassign::core::FlightKey;
+        using jetassign::core::Passenger;
+        using jetassign::core::SeatingPlan;
+        using jetassign::core::SeatLocation;
+        using jetassign::seatmap::Format;
+        using jetassign::seatmap::SeatMapWriter;
+
+        auto plan = SeatingPlan();
+        const auto &layout = plan.layout();
+        for (size_t i = 0; i < layout.seats(); i += 2)
+        {
+            plan.assign(SeatLocation(i / layout.columns(), i % layout.columns()), Passenger("Chan Tai Man", "HK" + std::to_string(i)));
+        }
+
+        const auto snapshot = plan.snapshot();
+        static const size_t kFlightCount = 5000;
+
+        for (const auto format : { Format::kJson, Format::kCsv, Format::kBinary })
+        {
+            std::ostringstream output;
+
+            const auto started = std::chrono::steady_clock::now();
+            auto writer = SeatMapWriter(output, format);
+            for (size_t i = 0; i < kFlightCount; i++)
+            {
+                writer.write(FlightKey { "JA" + std::to_string(i), "2021-04-01" }, *snapshot);
+            }
+            writer.finish();
+            const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started);
+
+            WARN("SeatMapWriter (format " << static_cast<int>(format) << "): " << kFlightCount << " flights, "
+                 << (output.str().size() / elapsed.count() / 1e6) << " MB/s");
+        }
+    }
+
+    TEST_CASE("jetassign::input::import_compact_assignments")
+    {
+        using jetassign::core::Passenger;
+        using jetassign::core::SeatingPlan;
+        using jetassign::core::SeatLocation;
+        using jetassign::input::import_compact_assignments;
+
+        auto plan = SeatingPlan();
+        std::istringstream input(
+            "Chan Tai Man/HK12345678A/10D\r\n"
+            "\n"
+            "Chan Siu Ming/HK87654321B/10D\n"
+            "Lee Siu Lung/HK11111111C\n"
+            "Chan Tai Man/HK12345678A/1A\n"
+            "Wong Ka Yan/HK12345678A/2A\n"
+            "Ho Ka Ming/HK22222222D/10D");
+
+        const auto version = plan.snapshot()->version();
+
+        std::vector<size_t> rejected_lines;
+        const auto report = import_compact_assignments(input, plan, [&](size_t line_number, const string & /* reason */)
+        {
+            rejected_lines.push_back(line_number);
+        });
+
+        REQUIRE(report.accepted == 4);
+        REQUIRE(report.rejected == 2);
+        REQUIRE_THAT(rejected_lines, Matchers::Equals(vector<size_t> { 4, 6 }));
+
+        // The imported seats were published at once.
+        REQUIRE(plan.snapshot()->version() == version + 1);
+        REQUIRE(plan.snapshot()->location_of("HK22222222D") == SeatLocation(9, 3));
+
+        REQUIRE(plan.location_of(Passenger("Chan Tai Man", "HK12345678A")) == SeatLocation(0, 0));
+        REQUIRE(plan.location_of(Passenger("Ho Ka Ming", "HK22222222D")) == SeatLocation(9, 3));
+
+        // The occupied seat was requested, so the nearest vacant seat was allocated instead.
+        const auto conflicting_location = plan.location_of(Passenger("Chan Siu Ming", "HK87654321B"));
+        REQUIRE(conflicting_location);
+        REQUIRE(conflicting_location->row() == 9);
+        REQUIRE(conflicting_location != SeatLocation(9, 3));
+    }
+
+    TEST_CASE("jetassign::input::parsers::parse_passport_id")
+    {
+        using jetassign::exceptions::EmptyInputError;
+        using jetassign::exceptions::MalformedInputError;
+        using jetassign::input::parsers::parse_passport_id;
+
+        REQUIRE(parse_passport_id(" HK12345678A ") == "HK12345678A");
+        REQUIRE(parse_passport_id("MiXeDcAsE") == "MiXeDcAsE");
+
+        REQUIRE_THROWS_AS(parse_passport_id("  "), EmptyInputError);
+        REQUIRE_THROWS_WITH(parse_passport_id("HK-1234"), "Only alphanumeric characters were allowed.");
+        REQUIRE_THROWS_WITH(parse_passport_id("HK 1234"), "Only alphanumeric characters were allowed.");
+        REQUIRE_THROWS_AS(parse_passport_id("HK1234567890ABCD"), MalformedInputError);
+    }
+
+    TEST_CASE("jetassign::input::parsers::parse_menu_option")
+    {
+        using jetassign::exceptions::EmptyInputError;
+        using jetassign::input::parsers::parse_menu_option;
+
+        REQUIRE(parse_menu_option(" 6 ") == 6);
+        REQUIRE(parse_menu_option("012") == 12);
+
+        REQUIRE_THROWS_AS(parse_menu_option(""), EmptyInputError);
+        REQUIRE_THROWS_WITH(parse_menu_option("-1"), "Only numeric characters were allowed.");
+        REQUIRE_THROWS_WITH(parse_menu_option("1a"), "Only numeric characters were allowed.");
+    }
+
+    TEST_CASE("jetassign::input::parsers", "[!benchmark]")
+    {
+        using std::regex;
+        using std::regex_match;
+
+        namespace parsers = jetassign::input::parsers;
+
+        // The regex-based validations that the parsers used to run, kept as the baseline.
+        static const regex kMenuOptionPattern(R"((\d+))");
+        static const regex kPassportIdPattern("([0-9A-Z]+)", regex::icase);
+        static const regex kSeatLocationPattern("([1-9][0-9]{0,3})([A-Z])");
+
+        const string kMenuOption = "3";
+        const string kPassportId = "HK12345678A";
+        const string kSeatLocation = "10D";
+        const string kCompactAssignment = "Chan Tai Man/HK12345678A/10D";
+
+        BENCHMARK("regex_match: menu option") { return regex_match(kMenuOption, kMenuOptionPattern); };
+        BENCHMARK("regex_match: passport ID") { return regex_match(kPassportId, kPassportIdPattern); };
+        BENCHMARK("regex_match: seat location") { return regex_match(kSeatLocation, kSeatLocationPattern); };
+
+        BENCHMARK("parse_menu_option") { return parsers::parse_menu_option(kMenuOption); };
+        BENCHMARK("parse_passport_id") { return parsers::parse_passport_id(kPassportId); };
+        BENCHMARK("parse_seat_location") { return parsers::parse_seat_location(kSeatLocation); };
+        BENCHMARK("parse_compact_assignment") { return parsers::parse_compact_assignment(kCompactAssignment); };
+    }
+
+    TEST_CASE("stringutil::write_json_string")
+    {
+        const auto to_json = [](string_view value)
+        {
+            string output;
+            stringutil::write_json_string(value, [&output](string_view piece) { output.append(piece); });
+            return output;
+        };
+
+        REQUIRE(to_json("Chan Tai Man") == "\"Chan Tai Man\"");
+        REQUIRE(to_json("") == "\"\"");
+        REQUIRE(to_json("a\"b\\c") == "\"a\\\"b\\\\c\"");
+        REQUIRE(to_json("\n\r\t\x01\x1f") == "\"\\n\\r\\t\\u0001\\u001f\"");
+
+        // The UTF-8 sequences were written as is.
+        REQUIRE(to_json("\xE9\x99\xB3\xE5\xA4\xA7\xE6\x96\x87") == "\"\xE9\x99\xB3\xE5\xA4\xA7\xE6\x96\x87\"");
+    }
+
+    TEST_CASE("stringutil::trim_view")
+    {
+        using stringutil::trim_view;
+        using stringutil::trim_start_view;
+        using stringutil::trim_end_view;
+
+        REQUIRE(trim_view("") == "");
+        REQUIRE(trim_view(" \t\r\n") == "");
+        REQUIRE(trim_view("  a b  ") == "a b");
+        REQUIRE(trim_start_view("  a b  ") == "a b  ");
+        REQUIRE(trim_end_view("  a b  ") == "  a b");
+    }
+
+    TEST_CASE("stringutil::Splitter")
+    {
+        using stringutil::Splitter;
+
+        WHEN("the separator is a single-character string")
+        {
+            auto splitter = Splitter("a//c", "/");
+
+            REQUIRE(splitter.next() == "a");
+            REQUIRE(splitter.next() == "");
+            REQUIRE(splitter.next() == "c");
+            REQUIRE_FALSE(splitter.next());
+            REQUIRE_FALSE(splitter.next());
+        }
+
+        WHEN("the separator is an empty string")
+        {
+            auto splitter = Splitter("a/b", "");
+
+            REQUIRE(splitter.next() == "a/b");
+            REQUIRE_FALSE(splitter.next());
+        }
+
+        WHEN("the input ends with a separator")
+        {
+            REQUIRE_THAT(stringutil::split_view("a->", "->"), Matchers::Equals(vector<string_view> { "a", "" }));
+        }
+    }
+
+    TEST_CASE("jetassign::input::parsers::parse_compact_assignment")
+    {
+        using jetassign::core::SeatLocation;
+        using jetassign::exceptions::MalformedInputError;
+        using jetassign::input::AssignmentRequest;
+        using jetassign::input::parsers::parse_compact_assignment;
+
+        WHEN("the input was valid")
+        {
+            const string input = " Chan Tai Man / HK12345678A / 10d ";
+
+            // The name was already interned by an alive passenger, and the passport ID was stored
+            // inline, thus no allocations.
+            const auto chan = jetassign::core::Passenger("Chan Tai Man", "HK11111111C");
+            is_counting_allocations = true;
+            allocation_count = 0;
+            const auto request = parse_compact_assignment(input);
+            is_counting_allocations = false;
+
+            REQUIRE(allocation_count == 0);
+            REQUIRE(request == AssignmentRequest("Chan Tai Man", "HK12345678A", SeatLocation(9, 3)));
+        }
+
+        WHEN("the seat location was replaced by a ticket class")
+        {
+            using jetassign::core::Passenger;
+            using jetassign::core::TicketClass;
+
+            REQUIRE(parse_compact_assignment("Chan Tai Man/HK12345678A/economy") == AssignmentRequest(Passenger("Chan Tai Man", "HK12345678A"), std::nullopt, TicketClass::kEconomy));
+            REQUIRE(parse_compact_assignment("Chan Tai Man/HK12345678A/*/Chan") == AssignmentRequest(Passenger("Chan Tai Man", "HK12345678A"), std::nullopt, std::nullopt, "Chan"));
+            REQUIRE(parse_compact_assignment("Chan Tai Man/HK12345678A/*/Chan").to_string() == "Chan Tai Man/HK12345678A/*/Chan");
+        }
+
+        WHEN("the number of input segments was not 3 or 4")
+        {
+            const string input = GENERATE("", "/", "a/b", "a/b/10D/", "a/b/10D/c/", "////");
+            REQUIRE_THROWS_AS(parse_compact_assignment(input), MalformedInputError);
+        }
+    }
+
+    TEST_CASE("jetassign::input::validate_assignments")
+    {
+        using jetassign::core::CabinLayout;
+        using jetassign::core::Passenger;
+        using jetassign::core::SeatingPlan;
+        using jetassign::core::SeatLocation;
+        using jetassign::input::AssignmentRequest;
+        using jetassign::input::validate_assignments;
+
+        const auto scoped_layout = ScopedLayout(CabinLayout(62, "ABC DEFG HJK"));
+
+        auto random = std::mt19937(42);
+        const auto random_location = [&]() { return SeatLocation(random() % 62, random() % 10); };
+
+        auto plan = SeatingPlan();
+        for (size_t i = 0; i < 200; i++)
+        {
+            const auto location = random_location();
+            if (!plan.is_occupied(location)) { plan.assign(location, Passenger("N0", "P" + std::to_string(i))); }
+        }
+
+        // Includes the passengers who were assigned, the passport IDs that were shared by different
+        // names, the requests without a seat, and plenty of conflicting seats.
+        std::vector<AssignmentRequest> requests;
+        for (size_t i = 0; i < 100000; i++)
+        {
+            const auto location = (random() % 10 == 0) ? std::nullopt : optional<SeatLocation>(random_location());
+            requests.emplace_back(Passenger("N" + std::to_string(random() % 3), "P" + std::to_string(random() % 20000)), location);
+        }
+
+        const auto confirm_reassignment = [](const AssignmentRequest &request, const SeatLocation &assigned_location)
+        {
+            return ((request.passenger().passport_id().size() + assigned_location.column()) % 2 == 0);
+        };
+
+        const auto sequential = validate_assignments(plan, requests, confirm_reassignment, 1);
+        const auto parallel = validate_assignments(plan, requests, confirm_reassignment, 4);
+
+        REQUIRE(sequential.valid.size() + sequential.unseated.size() + sequential.assigned.size() == requests.size());
+        REQUIRE_FALSE(sequential.valid.empty());
+        REQUIRE_FALSE(sequential.unseated.empty());
+        REQUIRE_FALSE(sequential.assigned.empty());
+
+        REQUIRE(parallel.valid == sequential.valid);
+        REQUIRE(parallel.unseated == sequential.unseated);
+        REQUIRE(parallel.assigned == sequential.assigned);
+        REQUIRE(parallel.occupation == sequential.occupation);
+    }
+
+    TEST_CASE("jetassign::storage::save_snapshot")
+    {
+        using jetassign::core::FlightRegistry;
+        using jetassign::core::Passenger;
+        using jetassign::core::SeatingPlan;
+        using jetassign::core::SeatLocation;
+        using jetassign::exceptions::StorageError;
+
+        namespace storage = jetassign::storage;
+
+        auto plan = SeatingPlan();
+        plan.assign(SeatLocation(9, 3), Passenger("Chan Tai Man", "HK12345678A"));
+        plan.assign(SeatLocation(0, 0), Passenger("Lee Siu Lung", "HK11111111C"));
+
+        auto flights = FlightRegistry();
+        for (auto i = 0; i < 1000; i++)
+        {
+            flights.open({ "JA" + std::to_string(i), "2021-04-01" })->modify([&](SeatingPlan &flight_plan)
+            {
+                flight_plan.assign(SeatLocation(i % 13, i % 6), Passenger("Passenger " + std::to_string(i), "P" + std::to_string(i)));
+            });
+        }
+
+        const auto path = (std::filesystem::temp_directory_path() / "JetAssign-Test.snapshot").string();
+        storage::save_snapshot(path, plan, flights);
+
+        WHEN("the snapshot was loaded")
+        {
+            auto loaded_plan = SeatingPlan();
+            auto loaded_flights = FlightRegistry();
+            REQUIRE(storage::load_snapshot(path, loaded_plan, loaded_flights));
+
+            REQUIRE(loaded_plan.location_of(Passenger("Chan Tai Man", "HK12345678A")) == SeatLocation(9, 3));
+            REQUIRE(loaded_plan.location_of(Passenger("Lee Siu Lung", "HK11111111C")) == SeatLocation(0, 0));
+
+            REQUIRE(loaded_flights.size() == 1000);
+            loaded_flights.find({ "JA42", "2021-04-01" })->read([&](const SeatingPlan &flight_plan)
+            {
+                REQUIRE(flight_plan.at(SeatLocation(42 % 13, 42 % 6)) == Passenger("Passenger 42", "P42"));
+            });
+
+            REQUIRE(storage::write_snapshot(loaded_plan, loaded_flights).size() == storage::write_snapshot(plan, flights).size());
+        }
+
+        WHEN("the snapshot was corrupted")
+        {
+            auto snapshot = storage::write_snapshot(plan, flights);
+
+            auto loaded_plan = SeatingPlan();
+            auto loaded_flights = FlightRegistry();
+
+            REQUIRE_THROWS_AS(storage::read_snapshot(string_view(snapshot).substr(0, snapshot.size() - 1), loaded_plan, loaded_flights), StorageError);
+
+            snapshot[0] = 'X';
+            REQUIRE_THROWS_AS(storage::read_snapshot(snapshot, loaded_plan, loaded_flights), StorageError);
+        }
+
+        WHEN("the snapshot does not exist")
+        {
+            auto loaded_plan = SeatingPlan();
+            auto loaded_flights = FlightRegistry();
+
+            std::filesystem::remove(path);
+            REQUIRE_FALSE(storage::load_snapshot(path, loaded_plan, loaded_flights));
+        }
+
+        std::filesystem::remove(path);
+    }
+
+    TEST_CASE("jetassign::storage::Journal")
+    {
+        using jetassign::core::FlightRegistry;
+        using jetassign::core::Passenger;
+        using jetassign::core::SeatingPlan;
+        using jetassign::core::SeatLocation;
+
+        namespace storage = jetassign::storage;
+
+        const auto snapshot_path = (std::filesystem::temp_directory_path() / "JetAssign-Test-Journal.snapshot").string();
+        const auto journal_path = snapshot_path + ".journal";
+        std::filesystem::remove(snapshot_path);
+        std::filesystem::remove(journal_path);
+
+        auto plan = SeatingPlan();
+        auto flights = FlightRegistry();
+        const auto flight = flights.open({ "JA1", "2021-04-01" });
+        {
+            auto journal = storage::Journal(journal_path, 0);
+            journal.attach(plan);
+            flight->modify([&](SeatingPlan &flight_plan) { journal.attach(flight_plan, flight->key()); });
+
+            plan.assign(SeatLocation(9, 3), Passenger("Chan Tai Man", "HK12345678A"));
+            plan.assign(SeatLocation(0, 0), Passenger("Lee Siu Lung", "HK11111111C"));
+            plan.remove(SeatLocation(0, 0));
+            flight->modify([&](SeatingPlan &flight_plan) { flight_plan.assign(SeatLocation(1, 1), Passenger("Wong Ka Ming", "HK22222222D")); });
+
+            journal.sync();
+            REQUIRE(journal.size() == 4);
+
+            journal.detach(plan);
+            plan.assign(SeatLocation(5, 5), Passenger("Unrecorded", "UNRECORDED"));
+            REQUIRE(journal.size() == 4);
+
+            flight->modify([&](SeatingPlan &flight_plan) { journal.detach(flight_plan); });
+        }
+
+        WHEN("the journal was replayed")
+        {
+            auto replayed_plan = SeatingPlan();
+            auto replayed_flights = FlightRegistry();
+            REQUIRE(storage::replay_journal(journal_path, 0, replayed_plan, replayed_flights) == 4);
+
+            REQUIRE(replayed_plan.location_of("HK12345678A") == SeatLocation(9, 3));
+            REQUIRE_FALSE(replayed_plan.is_assigned("HK11111111C"));
+            REQUIRE_FALSE(replayed_plan.is_occupied(SeatLocation(5, 5)));
+            replayed_flights.find({ "JA1", "2021-04-01" })->read([&](const SeatingPlan &flight_plan)
+            {
+                REQUIRE(flight_plan.location_of("HK22222222D") == SeatLocation(1, 1));
+            });
+        }
+
+        WHEN("the journal ends with a torn record")
+        {
+            std::filesystem::resize_file(journal_path, std::filesystem::file_size(journal_path) - 3);
+
+            auto replayed_plan = SeatingPlan();
+            auto replayed_flights = FlightRegistry();
+            REQUIRE(storage::replay_journal(journal_path, 0, replayed_plan, replayed_flights) == 3);
+            REQUIRE(replayed_flights.find({ "JA1", "2021-04-01" }) == nullptr);
+
+            // The torn record was dropped before the journal continues.
+            {
+                auto journal = storage::Journal(journal_path, 0);
+                journal.attach(replayed_plan);
+                replayed_plan.assign(SeatLocation(2, 2), Passenger("Ho Wai Kit", "HK33333333E"));
+                journal.detach(replayed_plan);
+            }
+
+            auto continued_plan = SeatingPlan();
+            REQUIRE(storage::replay_journal(journal_path, 0, continued_plan, replayed_flights) == 4);
+            REQUIRE(continued_plan.location_of("HK33333333E") == SeatLocation(2, 2));
+        }
+
+        WHEN("a transaction was recorded")
+        {
+            {
+                auto journal = storage::Journal(journal_path, 0);
+                journal.attach(plan);
+
+                auto transaction = plan.begin();
+                transaction.move(Passenger("Chan Tai Man", "HK12345678A"), SeatLocation(0, 0));
+                transaction.assign(SeatLocation(0, 1), Passenger("Ho Wai Kit", "HK33333333E"));
+                transaction.commit();
+
+                journal.sync();
+                REQUIRE(journal.size() == 5);
+                journal.detach(plan);
+            }
+
+            auto replayed_plan = SeatingPlan();
+            auto replayed_flights = FlightRegistry();
+            REQUIRE(storage::replay_journal(journal_path, 0, replayed_plan, replayed_flights) == 5);
+            REQUIRE(replayed_plan.location_of("HK12345678A") == SeatLocation(0, 0));
+            REQUIRE(replayed_plan.location_of("HK33333333E") == SeatLocation(0, 1));
+
+            // The torn transaction was dropped as a whole.
+            std::filesystem::resize_file(journal_path, std::filesystem::file_size(journal_path) - 1);
+
+            auto torn_plan = SeatingPlan();
+            auto torn_flights = FlightRegistry();
+            REQUIRE(storage::replay_journal(journal_path, 0, torn_plan, torn_flights) == 4);
+            REQUIRE(torn_plan.location_of("HK12345678A") == SeatLocation(9, 3));
+            REQUIRE_FALSE(torn_plan.is_assigned("HK33333333E"));
+        }
+
+        WHEN("a complete record in the middle could not be applied")
+        {
+            // Replaces the operation of the second record, with a checksum that still matches.
+            string journal;
+            {
+                std::ifstream file(journal_path, std::ios::binary);
+                journal.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            }
+
+            const auto load_u32 = [&](size_t offset)
+            {
+                uint32_t value = 0;
+                for (size_t i = 0; i < 4; i++) { value |= (uint32_t(static_cast<unsigned char>(journal[offset + i])) << (8 * i)); }
+                return value;
+            };
+
+            const auto second = 10 + 4 + load_u32(10) + 4;
+            const auto length = load_u32(second);
+            journal[second + 4] = 0x7F;
+
+            uint32_t checksum = 2166136261u;
+            for (size_t i = 0; i < length; i++) { checksum = (checksum ^ static_cast<unsigned char>(journal[second + 4 + i])) * 16777619u; }
+            for (size_t i = 0; i < 4; i++) { journal[second + 4 + length + i] = static_cast<char>((checksum >> (8 * i)) & 0xFF); }
+
+            {
+                std::ofstream file(journal_path, std::ios::binary | std::ios::trunc);
+                file << journal;
+            }
+
+            // The startup fails, rather than skipping the record and the records after it.
+            auto replayed_plan = SeatingPlan();
+            auto replayed_flights = FlightRegistry();
+            REQUIRE_THROWS_AS(storage::replay_journal(journal_path, 0, replayed_plan, replayed_flights), jetassign::exceptions::StorageError);
+        }
+
+        WHEN("a write was acknowledged without syncing the journal")
+        {
+            auto acknowledged_plan = SeatingPlan();
+            {
+                auto journal = storage::Journal(journal_path, 0, std::chrono::seconds(30));
+                journal.attach(plan);
+
+                plan.assign(SeatLocation(2, 2), Passenger("Ho Wai Kit", "HK33333333E"));
+                REQUIRE(journal.ticket() == 5);
+                journal.wait(journal.ticket());
+
+                // The acknowledged write was already on the disk, before the journal was closed.
+                auto replayed_flights = FlightRegistry();
+                REQUIRE(storage::replay_journal(journal_path, 0, acknowledged_plan, replayed_flights) == 5);
+
+                journal.detach(plan);
+            }
+
+            REQUIRE(acknowledged_plan.location_of("HK33333333E") == SeatLocation(2, 2));
+        }
+
+        WHEN("the journal belongs to another generation")
+        {
+            auto replayed_plan = SeatingPlan();
+            auto replayed_flights = FlightRegistry();
+            REQUIRE(storage::replay_journal(journal_path, 1, replayed_plan, replayed_flights) == 0);
+            REQUIRE_FALSE(replayed_plan.is_assigned("HK12345678A"));
+        }
+
+        WHEN("the journal was compacted")
+        {
+            auto journal = storage::Journal(journal_path, 0);
+            REQUIRE(journal.size() == 4);
+
+            storage::compact(snapshot_path, journal, plan, flights);
+            REQUIRE(journal.size() == 0);
+            REQUIRE(journal.generation() == 1);
+
+            auto loaded_plan = SeatingPlan();
+            auto loaded_flights = FlightRegistry();
+            const auto generation = storage::load_snapshot(snapshot_path, loaded_plan, loaded_flights);
+            REQUIRE(generation == 1u);
+            REQUIRE(storage::replay_journal(journal_path, *generation, loaded_plan, loaded_flights) == 0);
+            REQUIRE(loaded_plan.location_of("HK12345678A") == SeatLocation(9, 3));
+        }
+
+        WHEN("a flight was changed during the compaction")
+        {
+            auto journal = storage::Journal(journal_path, 0);
+            flight->modify([&](SeatingPlan &flight_plan) { journal.attach(flight_plan, flight->key()); });
+
+            const auto generation = journal.begin_compaction();
+            storage::save_snapshot(snapshot_path, plan, flights, generation, &journal);
+
+            // The change after the flight was saved waits for the new generation.
+            std::atomic<bool> is_changed { false };
+            std::thread changer([&]()
+            {
+                flight->modify([&](SeatingPlan &flight_plan) { flight_plan.assign(SeatLocation(2, 2), Passenger("Ho Ka Yan", "HK33333333E")); });
+                is_changed = true;
+            });
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            REQUIRE_FALSE(is_changed);
+
+            journal.reset(generation);
+            changer.join();
+            journal.sync();
+            REQUIRE(journal.size() == 1);
+
+            flight->modify([&](SeatingPlan &flight_plan) { journal.detach(flight_plan); });
+
+            auto loaded_plan = SeatingPlan();
+            auto loaded_flights = FlightRegistry();
+            REQUIRE(storage::load_snapshot(snapshot_path, loaded_plan, loaded_flights) == generation);
+            REQUIRE(storage::replay_journal(journal_path, generation, loaded_plan, loaded_flights) == 1);
+            loaded_flights.find({ "JA1", "2021-04-01" })->read([&](const SeatingPlan &flight_plan)
+            {
+                REQUIRE(flight_plan.location_of("HK22222222D") == SeatLocation(1, 1));
+                REQUIRE(flight_plan.location_of("HK33333333E") == SeatLocation(2, 2));
+            });
+        }
+
+        std::filesystem::remove(snapshot_path);
+        std::filesystem::remove(journal_path);
+    }
+
+    TEST_CASE("jetassign::storage::FlightDatabase")
+    {
+        using jetassign::core::FlightKey;
+        using jetassign::core::FlightRegistry;
+        using jetassign::core::Passenger;
+        using jetassign::core::SeatingPlan;
+        using jetassign::core::SeatLocation;
+        using jetassign::exceptions::StorageError;
+
+        namespace storage = jetassign::storage;
+
+        auto plan = SeatingPlan();
+        plan.assign(SeatLocation(9, 3), Passenger("Chan Tai Man", "HK12345678A"));
+
+        auto flights = FlightRegistry();
+        for (auto i = 0; i < 1000; i++)
+        {
+            flights.open({ "JA" + std::to_string(i), "2021-04-01" })->modify([&](SeatingPlan &flight_plan)
+            {
+                flight_plan.assign(SeatLocation(i % 13, i % 6), Passenger("Passenger " + std::to_string(i % 10), "P" + std::to_string(i)));
+            });
+        }
+
+        const auto path = (std::filesystem::temp_directory_path() / "JetAssign-Test.database").string();
+
+        std::unique_ptr<storage::FlightDatabase> database;
+        storage::save_database(path, plan, flights, database, 7);
+
+        REQUIRE(database);
+        REQUIRE(database->generation() == 7);
+        REQUIRE(database->size() == 1001);
+        REQUIRE(database->names() == 1001);
+
+        WHEN("the name table was searched")
+        {
+            const auto first = database->lower_bound_name("PASSENGER 2");
+            REQUIRE(database->name_at(first).normalized_name == "PASSENGER 2");
+            REQUIRE(database->name_at(first - 1).normalized_name == "PASSENGER 1");
+            REQUIRE(database->lower_bound_name("PASSENGER 9 ") == database->names());
+            REQUIRE(database->at(database->name_at(database->lower_bound_name("CHAN")).flight).key() == FlightKey());
+        }
+
+        WHEN("a flight was read from the mapping")
+        {
+            const auto flight = database->find({ "JA42", "2021-04-01" });
+            REQUIRE(flight);
+            REQUIRE(flight->key() == FlightKey { "JA42", "2021-04-01" });
+            REQUIRE(flight->size() == 1);
+            REQUIRE(flight->is_occupied(42 % 13, 42 % 6));
+            REQUIRE(flight->at(42 % 13, 42 % 6)->name == "Passenger 2");
+            REQUIRE(flight->at(42 % 13, 42 % 6)->passport_id == "P42");
+            REQUIRE_FALSE(flight->at(0, 0));
+            REQUIRE(flight->location_of("P42") == SeatLocation(42 % 13, 42 % 6));
+            REQUIRE_FALSE(database->find({ "JA42", "2021-04-02" }));
+
+            // The mapped flight was exported the same as its restored seating plan.
+            using jetassign::seatmap::Format;
+            using jetassign::seatmap::SeatMapWriter;
+
+            auto restored_plan = SeatingPlan();
+            flight->restore(restored_plan);
+
+            for (const auto format : { Format::kJson, Format::kCsv, Format::kBinary })
+            {
+                std::ostringstream mapped_output;
+                auto mapped_writer = SeatMapWriter(mapped_output, format);
+                mapped_writer.write(flight->key(), *flight, restored_plan.layout());
+                mapped_writer.finish();
+
+                std::ostringstream restored_output;
+                auto restored_writer = SeatMapWriter(restored_output, format);
+                restored_writer.write(flight->key(), *restored_plan.snapshot());
+                restored_writer.finish();
+
+                REQUIRE(mapped_output.str() == restored_output.str());
+            }
+
+            std::ostringstream output;
+            auto writer = SeatMapWriter(output, Format::kCsv);
+            REQUIRE_THROWS_AS(writer.write(flight->key(), *flight, jetassign::core::CabinLayout(14, "ABCDEF")), std::invalid_argument);
+        }
+
+        WHEN("the database was loaded")
+        {
+            auto loaded_plan = SeatingPlan();
+            auto loaded_flights = FlightRegistry();
+            std::unique_ptr<storage::FlightDatabase> loaded_database;
+            REQUIRE(storage::load_database(path, loaded_plan, loaded_flights, loaded_database) == 7u);
+
+            REQUIRE(loaded_plan.location_of(Passenger("Chan Tai Man", "HK12345678A")) == SeatLocation(9, 3));
+
+            // The flights were loaded on their first use only.
+            REQUIRE(loaded_flights.size() == 0);
+            loaded_flights.find({ "JA42", "2021-04-01" })->read([&](const SeatingPlan &flight_plan)
+            {
+                REQUIRE(flight_plan.at(SeatLocation(42 % 13, 42 % 6)) == Passenger("Passenger 2", "P42"));
+            });
+            REQUIRE(loaded_flights.size() == 1);
+
+            AND_WHEN("the passengers of the unloaded flights were searched")
+            {
+                REQUIRE(loaded_flights.close({ "JA12", "2021-04-01" }));
+
+                // The loaded and closed flights were skipped, without loading the others.
+                const auto matches = jetassign::search::find_prefix(*loaded_database, loaded_flights, "passenger  2", 1000);
+                REQUIRE(matches.size() == 98);
+                REQUIRE(loaded_flights.size() == 1);
+                REQUIRE(std::none_of(matches.begin(), matches.end(), [](const auto &match)
+                {
+                    return ((match.flight.flight_number == "JA42") || (match.flight.flight_number == "JA12"));
+                }));
+
+                const auto first = jetassign::search::find_prefix(*loaded_database, loaded_flights, "Passenger 2", 1);
+                REQUIRE(first.size() == 1);
+                REQUIRE(first[0].passenger.name() == "Passenger 2");
+                REQUIRE(loaded_database->find(first[0].flight)->location_of(first[0].passenger.passport_id()) == first[0].location);
+
+                REQUIRE(jetassign::search::find_prefix(*loaded_database, loaded_flights, "Chan").empty());
+
+                // The misspelled names were found from the name table as well.
+                const auto similar = jetassign::search::find_similar(*loaded_database, loaded_flights, "pasenger 2", 1, 1000);
+                REQUIRE(similar.size() == 98);
+                REQUIRE(std::all_of(similar.begin(), similar.end(), [](const auto &match)
+                {
+                    return ((match.passenger.name() == "Passenger 2") && (match.distance == 1));
+                }));
+                REQUIRE(loaded_flights.size() == 1);
+
+                REQUIRE(jetassign::search::find_similar(*loaded_database, loaded_flights, "Chan Tai Mn").empty());
+            }
+
+            AND_WHEN("the database was saved after a flight was changed and another was closed")
+            {
+                loaded_flights.open({ "JA1", "2021-04-01" })->modify([&](SeatingPlan &flight_plan)
+                {
+                    flight_plan.assign(SeatLocation(5, 5), Passenger("Lee Siu Lung", "HK11111111C"));
+                });
+                REQUIRE(loaded_flights.close({ "JA2", "2021-04-01" }));
+                REQUIRE_FALSE(loaded_flights.find({ "JA2", "2021-04-01" }));
+
+                // The closed flight was only probed in the database, rather than loaded.
+                REQUIRE(loaded_flights.size() == 2);
+
+                storage::save_database(path, loaded_plan, loaded_flights, loaded_database);
+
+                REQUIRE(loaded_database->size() == 1000);
+                REQUIRE(loaded_database->find({ "JA1", "2021-04-01" })->location_of("HK11111111C") == SeatLocation(5, 5));
+                REQUIRE(loaded_database->find({ "JA999", "2021-04-01" })->location_of("P999") == SeatLocation(999 % 13, 999 % 6));
+                REQUIRE_FALSE(loaded_database->find({ "JA2", "2021-04-01" }));
+            }
+        }
+
+        WHEN("the database was corrupted")
+        {
+            database.reset();
+            {
+                std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+                file.put('X');
+            }
+
+            REQUIRE_THROWS_AS(storage::FlightDatabase::open(path), StorageError);
+        }
+
+        WHEN("the database does not exist")
+        {
+            auto loaded_plan = SeatingPlan();
+            auto loaded_flights = FlightRegistry();
+            std::unique_ptr<storage::FlightDatabase> loaded_database;
+
+            database.reset();
+            std::filesystem::remove(path);
+            REQUIRE_FALSE(storage::load_database(path, loaded_plan, loaded_flights, loaded_database));
+            REQUIRE_FALSE(loaded_database);
+        }
+
+        database.reset();
+        std::filesystem::remove(path);
+    }
+
+    TEST_CASE("jetassign::server::run_script")
+    {
+        using jetassign::core::SeatingPlan;
+        using jetassign::core::SeatLocation;
+        using jetassign::server::run_script;
+
+        auto plan = SeatingPlan();
+        std::istringstream script(
+            "# Reconciliation\n"
+            "assign Chan Tai Man/HK12345678A/10D\n"
+            "\n"
+            "LOOKUP HK12345678A\n"
+            "REMOVE 11A\n"
+            "QUIT\n"
+            "REMOVE 10D\n");
+        std::ostringstream output;
+
+        const auto report = run_script(script, output, plan);
+
+        REQUIRE(report.succeeded == 3);
+        REQUIRE(report.failed == 1);
+        REQUIRE(plan.at(SeatLocation(9, 3))->name() == "Chan Tai Man");
+        REQUIRE(output.str() ==
+            "{\"line\":2,\"request\":\"assign Chan Tai Man/HK12345678A/10D\",\"status\":\"OK\",\"result\":\"10D\"}\n"
+            "{\"line\":4,\"request\":\"LOOKUP HK12345678A\",\"status\":\"OK\",\"result\":\"10D Chan Tai Man\"}\n"
+            "{\"line\":5,\"request\":\"REMOVE 11A\",\"status\":\"ERROR\",\"reason\":\"The seat was not assigned.\"}\n"
+            "{\"line\":6,\"request\":\"QUIT\",\"status\":\"BYE\",\"result\":\"\"}\n");
+    }
+
+#ifdef __linux__
+    /**
+     * Sends the requests to a server, and returns the responses until the connection was closed.
+     * Returns nothing if the requests could not be sent, which could be called from any thread.
+     *
+     * @param fd       The file descriptor of the connected socket.
+     * @param requests The request lines.
+     **/
+    string exchange(int fd, const string &requests)
+    {
+        if ((fd < 0) || (send(fd, requests.data(), requests.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(requests.size())))
+        {
+            if (fd >= 0) { close(fd); }
+            return "";
+        }
+        shutdown(fd, SHUT_WR);
+
+        string responses;
+        char buffer[4096];
+        for (ssize_t count; (count = read(fd, buffer, sizeof(buffer))) > 0; ) { responses.append(buffer, count); }
+
+        close(fd);
+        return responses;
+    }
+
+    /**
+     * Connects to a server on a TCP port of the loopback interface. Returns -1 if failed.
+     *
+     * @param port The port.
+     **/
+    int connect_tcp(std::uint16_t port)
+    {
+        sockaddr_in address {};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        const auto fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) < 0)
+        {
+            close(fd);
+            return -1;
+        }
+
+        return fd;
+    }
+
+    TEST_CASE("jetassign::server::Server")
+    {
+        using jetassign::core::SeatingPlan;
+        using jetassign::core::SeatLocation;
+        using jetassign::server::Server;
+
+        const auto socket_path = (std::filesystem::temp_directory_path() / "JetAssign-Test.sock").string();
+
+        auto plan = SeatingPlan();
+        auto server = Server(plan, 4);
+        const auto port = server.listen_tcp(0);
+        server.listen_unix(socket_path);
+
+        std::thread runner([&server]() { server.run(); });
+
+        WHEN("the requests were sent over TCP")
+        {
+            const auto responses = exchange(connect_tcp(port),
+                "ASSIGN Chan Tai Man/HK12345678A/1A\n"
+                "LOOKUP HK12345678A\n"
+                "ASSIGN Lee Siu Lung/HK11111111C/first\n"
+                "ASSIGN Wong Ka Ming/HK22222222D/1A\n"
+                "REMOVE 1A\n"
+                "LOOKUP HK12345678A\n"
+                "HELLO\n");
+
+            REQUIRE(responses ==
+                "OK 1A\n"
+                "OK 1A Chan Tai Man\n"
+                "OK 1B\n"
+                "ERROR The requested seat was already occupied by another passenger.\n"
+                "OK HK12345678A\n"
+                "NOT_FOUND\n"
+                "ERROR Unknown command.\n");
+
+            REQUIRE(plan.location_of("HK11111111C") == SeatLocation(0, 1));
+        }
+
+        WHEN("the requests were sent over a Unix domain socket")
+        {
+            sockaddr_un address {};
+            address.sun_family = AF_UNIX;
+            std::strcpy(address.sun_path, socket_path.c_str());
+
+            const auto fd = socket(AF_UNIX, SOCK_STREAM, 0);
+            REQUIRE(connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0);
+
+            const auto responses = exchange(fd, "ASSIGN Chan Tai Man/HK12345678A/2C\nMAP\nQUIT\nMAP\n");
+            REQUIRE_THAT(responses, Matchers::StartsWith("OK 2C\nOK ****** **X*** ******"));
+            REQUIRE_THAT(responses, Matchers::EndsWith("\nBYE\n"));
+        }
+
+        WHEN("the kiosks sent more data after QUIT")
+        {
+            // The data and the hangup after QUIT raced with closing the connection.
+            std::vector<std::thread> kiosks;
+            for (size_t i = 0; i < 8; i++)
+            {
+                kiosks.emplace_back([port]()
+                {
+                    for (size_t j = 0; j < 50; j++)
+                    {
+                        const auto fd = connect_tcp(port);
+                        send(fd, "QUIT\n", 5, MSG_NOSIGNAL);
+                        std::this_thread::sleep_for(std::chrono::microseconds(j * 10));
+                        exchange(fd, "MAP\nMAP\n");
+                    }
+                });
+            }
+            for (auto &kiosk : kiosks) { kiosk.join(); }
+
+            // The server was still serving.
+            REQUIRE(exchange(connect_tcp(port), "LOOKUP HK12345678A\n") == "NOT_FOUND\n");
+        }
+
+        WHEN("many kiosks raced for the same seat")
+        {
+            std::vector<string> responses(16);
+            std::vector<std::thread> kiosks;
+            for (size_t i = 0; i < responses.size(); i++)
+            {
+                kiosks.emplace_back([&responses, port, i]()
+                {
+                    const auto passport_id = "HK" + std::to_string(10000000 + i) + "A";
+                    responses[i] = exchange(connect_tcp(port), "ASSIGN Chan Tai Man/" + passport_id + "/3D\n");
+                });
+            }
+            for (auto &kiosk : kiosks) { kiosk.join(); }
+
+            REQUIRE(std::count(responses.begin(), responses.end(), "OK 3D\n") == 1);
+        }
+
+        server.stop();
+        runner.join();
+    }
+
+    TEST_CASE("jetassign::console::ConsoleBuffer")
+    {
+        using jetassign::console::ConsoleBuffer;
+
+        int pipe_fds[2];
+        REQUIRE(::pipe(pipe_fds) == 0);
+
+        const auto read_available = [&]()
+        {
+            string output(4096, '\0');
+            const auto size = ::read(pipe_fds[0], output.data(), output.size());
+            output.resize((size > 0) ? size : 0);
+            return output;
+        };
+
+        {
+            auto buffer = ConsoleBuffer(pipe_fds[1], 16);
+            std::ostream stream(&buffer);
+
+            WHEN("a screen fits into the buffer")
+            {
+                stream << "*** Menu ***\n" << 42;
+                REQUIRE(buffer.statistics().writes == 0);
+
+                stream << std::flush;
+                REQUIRE(read_available() == "*** Menu ***\n42");
+                REQUIRE(buffer.statistics().writes == 1);
+                REQUIRE(buffer.statistics().bytes == 15);
+                REQUIRE(buffer.statistics().screens == 1);
+
+                // Flushing again writes nothing.
+                stream << std::flush;
+                REQUIRE(buffer.statistics().writes == 1);
+            }
+
+            WHEN("a screen does not fit into the buffer")
+            {
+                stream << string(40, '*') << std::flush;
+
+                REQUIRE(read_available() == string(40, '*'));
+                REQUIRE(buffer.statistics().writes == 3);
+                REQUIRE(buffer.statistics().screens == 1);
+            }
+        }
+
+        ::close(pipe_fds[0]);
+        ::close(pipe_fds[1]);
+    }
+#endif
+
     // TEST_CASE("jetassign::is_passport_id")
     // {
     //     using jetassign::is_passport_id;